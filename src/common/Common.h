@@ -35,7 +35,8 @@ namespace Birch
     {
       ImageChangedEvent = vtkCommand::UserEvent + 100,
       SliceChangedEvent,
-      OrientationChangedEvent
+      OrientationChangedEvent,
+      SlicesLoadedEvent
     };
 
   protected:
@@ -26,6 +26,7 @@
 
 // C includes
 #include <stdio.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -89,6 +90,13 @@ namespace Birch
       return access(filename.c_str(), R_OK)  == 0;
     }
 
+    inline static bool isDirectory(std::string filename)
+    {
+      struct stat info;
+      if (filename.empty() || 0 != stat(filename.c_str(), &info)) return false;
+      return S_ISDIR(info.st_mode);
+    }
+
     inline static std::string getFileExtension(std::string filename)
     {
       std::string::size_type dot_pos = filename.rfind(".");
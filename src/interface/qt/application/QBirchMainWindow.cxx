@@ -12,23 +12,29 @@
 
 // Birch includes
 #include <QBirchDoubleSlider.h>
+#include <QBirchImageLoader.h>
+#include <QBirchImagePrefetcher.h>
+#include <QBirchImageSaver.h>
 #include <QBirchSliceView.h>
 
 // VTK includes
 #include <vtkCamera.h>
 #include <vtkCommand.h>
 #include <vtkChartXY.h>
+#include <vtkCineWriter.h>
 #include <vtkContextScene.h>
 #include <vtkContextView.h>
 #include <vtkDataArrayCollection.h>
-#include <vtkEventForwarderCommand.h>
+#include <vtkDoubleArray.h>
 #include <vtkEventQtSlotConnect.h>
 #include <vtkGDCMImageReader.h>
 #include <vtkIdTypeArray.h>
-#include <vtkImageHistogram.h>
+#include <vtkImageDataReader.h>
+#include <vtkImageDataStatistics.h>
+#include <vtkImageDataWriter.h>
 #include <vtkImageSharpen.h>
-#include <vtkIntArray.h>
 #include <vtkMath.h>
+#include <vtkMedicalImageProperties.h>
 #include <vtkNew.h>
 #include <vtkPNGWriter.h>
 #include <vtkPlot.h>
@@ -40,9 +46,14 @@
 #include <vtkTable.h>
 #include <vtkWindowToImageFilter.h>
 
+// vtk-dicom includes
+#include <vtkDICOMMetaData.h>
+
 // Qt includes
 #include <QCloseEvent>
+#include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QLabel>
 #include <QMessageBox>
 #include <QProgressBar>
@@ -50,9 +61,15 @@
 #include <QSettings>
 #include <QSignalMapper>
 #include <QSlider>
+#include <QStandardPaths>
 #include <QString>
 #include <QWidgetItem>
 
+// C++ includes
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 //
 // QBirchMainWindowPrivate methods
@@ -62,17 +79,35 @@ QBirchMainWindowPrivate::QBirchMainWindowPrivate(QBirchMainWindow& object)
   : QObject(&object), q_ptr(&object)
 {
   this->qvtkConnection = vtkSmartPointer<vtkEventQtSlotConnect>::New();
+  this->loader = 0;
+  this->prefetcher = new QBirchImagePrefetcher(this);
+  this->saver = 0;
+  this->cineWriter = 0;
+  this->abortLoadButton = 0;
+  this->abortSaveButton = 0;
+  this->abortExportButton = 0;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 QBirchMainWindowPrivate::~QBirchMainWindowPrivate()
 {
   this->qvtkConnection->Disconnect();
+  if (this->loader)
+  {
+    this->loader->disconnect(this);
+    this->loader->abort();
+    this->loader->wait();
+  }
+  if (this->saver)
+  {
+    this->saver->disconnect(this);
+    this->saver->abort();
+    this->saver->wait();
+  }
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchMainWindowPrivate::showProgress(
-  vtkObject*, unsigned long, void*, void* call_data)
+void QBirchMainWindowPrivate::startProgress(const QString& message)
 {
   QProgressBar* progress = this->statusbar->findChild<QProgressBar*>();
   if (progress)
@@ -80,14 +115,26 @@ void QBirchMainWindowPrivate::showProgress(
     progress->setVisible(true);
     progress->setValue(0);
   }
-  QPushButton* button = this->statusbar->findChild<QPushButton*>();
-  if (button)
-    button->setVisible(true);
-  QString message = reinterpret_cast<const char*>(call_data);
+  this->updateAbortButtons();
   if (!message.isEmpty())
     this->statusbar->showMessage(message);
 
   this->statusbar->repaint();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::setProgress(double value)
+{
+  QProgressBar* progress = this->statusbar->findChild<QProgressBar*>();
+  if (progress)
+    progress->setValue(static_cast<int>(100*value));
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::showProgress(
+  vtkObject*, unsigned long, void*, void* call_data)
+{
+  this->startProgress(reinterpret_cast<const char*>(call_data));
   QApplication::processEvents();
 }
 
@@ -100,23 +147,187 @@ void QBirchMainWindowPrivate::hideProgress()
     progress->setVisible(false);
     this->statusbar->clearMessage();
   }
-  QPushButton* button = this->statusbar->findChild<QPushButton*>();
-  if (button)
-    button->setVisible(false);
+  this->updateAbortButtons();
   this->statusbar->clearMessage();
   this->statusbar->repaint();
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::updateAbortButtons()
+{
+  // a load and a save can run together, so each is aborted on its own
+  if (this->abortLoadButton)
+    this->abortLoadButton->setVisible(0 != this->loader);
+  if (this->abortSaveButton)
+    this->abortSaveButton->setVisible(0 != this->saver);
+  if (this->abortExportButton)
+    this->abortExportButton->setVisible(0 != this->cineWriter);
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchMainWindowPrivate::updateProgress(
   vtkObject*, unsigned long, void*, void* call_data)
 {
-  QProgressBar* progress = this->statusbar->findChild<QProgressBar*>();
-  double value = *(reinterpret_cast<double*>(call_data));
-  progress->setValue(static_cast<int>(100*value));
+  this->setProgress(*(reinterpret_cast<double*>(call_data)));
   QApplication::processEvents();
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::loadStarted(const QString& message)
+{
+  if (this->sender() != this->loader) return;
+  this->startProgress(message);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::loadProgress(double value)
+{
+  if (this->sender() != this->loader) return;
+  this->setProgress(value);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::loadSlices(int count)
+{
+  if (this->sender() != this->loader) return;
+
+  // show the volume as soon as its first slab has been read
+  QBirchSliceView* view = this->imageWidget->sliceView();
+  vtkImageData* image = this->loader->updatePartialImageData();
+  if (!image) return;
+  if (view->imageData() != image)
+    view->setPartialImageData(image, count);
+  else
+    view->setLoadedSlices(count);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::loadFinished(bool success)
+{
+  Q_Q(QBirchMainWindow);
+  QBirchImageLoader* finished = qobject_cast<QBirchImageLoader*>(this->sender());
+  if (!finished) return;
+  finished->wait();
+  finished->deleteLater();
+
+  // ignore the results of a load that has since been replaced
+  if (finished != this->loader) return;
+  this->loader = 0;
+  this->hideProgress();
+
+  // a partially loaded volume may be on display
+  bool partial = finished->partialImageData() &&
+    finished->partialImageData() == this->imageWidget->imageData();
+
+  if (finished->isAborted())
+  {
+    if (partial)
+    {
+      this->imageWidget->reset();
+      this->currentMetaData = 0;
+      this->setCurrentFile("");
+      this->updateUi();
+    }
+    this->statusbar->showMessage(tr("Loading aborted"), 2000);
+    return;
+  }
+
+  if (success)
+  {
+    this->imageWidget->setImageData(
+      finished->imageData(), finished->medicalImageProperties());
+    this->currentMetaData = finished->metaData();
+    this->setCurrentFile(finished->fileName());
+    this->prefetchFiles();
+  }
+  else
+  {
+    QMessageBox errorMessage(q);
+    errorMessage.setWindowModality(Qt::WindowModal);
+    errorMessage.setIcon(QMessageBox::Warning);
+    errorMessage.setText(
+      "There was an error while attempting to open the image.");
+    errorMessage.exec();
+    this->imageWidget->reset();
+  }
+  this->updateUi();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::abortLoad()
+{
+  if (this->loader)
+    this->loader->abort();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::abortSave()
+{
+  if (this->saver)
+    this->saver->abort();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::abortExport()
+{
+  if (this->cineWriter)
+    this->cineWriter->AbortExecuteOn();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::saveStarted(const QString& message)
+{
+  if (this->sender() != this->saver) return;
+  this->startProgress(message);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::saveProgress(double value)
+{
+  if (this->sender() != this->saver) return;
+  this->setProgress(value);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::saveFinished(bool success)
+{
+  Q_Q(QBirchMainWindow);
+  QBirchImageSaver* finished = qobject_cast<QBirchImageSaver*>(this->sender());
+  if (!finished) return;
+  finished->wait();
+  finished->deleteLater();
+  if (finished != this->saver) return;
+  this->saver = 0;
+
+  // a load may have taken over the progress bar in the meantime
+  if (!this->loader)
+    this->hideProgress();
+  else
+    this->updateAbortButtons();
+
+  if (finished->isAborted())
+  {
+    this->statusbar->showMessage(tr("Saving aborted"), 2000);
+  }
+  else if (success)
+  {
+    QString message = QBirchImageSaver::AllSlices == finished->mode() ?
+      tr("Saved %1 slices").arg(finished->slicesWritten()) :
+      tr("Saved %1").arg(this->strippedName(finished->fileName()));
+    this->statusbar->showMessage(message, 2000);
+  }
+  else
+  {
+    QMessageBox errorMessage(q);
+    errorMessage.setWindowModality(Qt::WindowModal);
+    errorMessage.setIcon(QMessageBox::Warning);
+    errorMessage.setText(
+      "There was an error while attempting to save the image.");
+    errorMessage.setDetailedText(finished->errorMessage());
+    errorMessage.exec();
+  }
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchMainWindowPrivate::setupUi(QMainWindow* window)
 {
@@ -129,9 +340,19 @@ void QBirchMainWindowPrivate::setupUi(QMainWindow* window)
   connect(this->actionOpen, SIGNAL(triggered()),
     this, SLOT(slotOpen()));
 
+  // connect the Open Directory item to open a DICOM series
+  connect(this->actionOpenDirectory, SIGNAL(triggered()),
+    this, SLOT(slotOpenDirectory()));
+
   connect(this->actionSave, SIGNAL(triggered()),
     this, SLOT(slotSave()));
 
+  connect(this->actionSaveSlices, SIGNAL(triggered()),
+    this, SLOT(slotSaveSlices()));
+
+  connect(this->actionExportCine, SIGNAL(triggered()),
+    this, SLOT(slotExportCine()));
+
   for (int i = 0; i < this->MaxRecentFiles; ++i)
   {
     this->recentFileActs[i] = new QAction(this);
@@ -194,18 +415,45 @@ void QBirchMainWindowPrivate::setupUi(QMainWindow* window)
   connect(this->undoSharpenPushButton, SIGNAL(clicked()),
     this, SLOT(reloadImage()));
 
+  QProgressBar* progress = new QProgressBar();
+  this->statusbar->addPermanentWidget(progress);
+  progress->setVisible(false);
+  this->abortLoadButton = new QPushButton(tr("Abort Loading"));
+  this->statusbar->addPermanentWidget(this->abortLoadButton);
+  this->abortLoadButton->setVisible(false);
+  connect(this->abortLoadButton, SIGNAL(clicked()), this, SLOT(abortLoad()));
+  this->abortSaveButton = new QPushButton(tr("Abort Saving"));
+  this->statusbar->addPermanentWidget(this->abortSaveButton);
+  this->abortSaveButton->setVisible(false);
+  connect(this->abortSaveButton, SIGNAL(clicked()), this, SLOT(abortSave()));
+  this->abortExportButton = new QPushButton(tr("Abort Export"));
+  this->statusbar->addPermanentWidget(this->abortExportButton);
+  this->abortExportButton->setVisible(false);
+  connect(this->abortExportButton, SIGNAL(clicked()),
+    this, SLOT(abortExport()));
+
+  // decoded images are cached so that reloading or reopening a recent file
+  // is immediate, the size is given in MiB
+  QSettings settings;
+  vtkImageDataReader::SetCacheSize(
+    static_cast<vtkIdType>(settings.value("imageCacheSize", 512).toInt()) *
+    1024);
+
+  // decoded compressed DICOM files are also kept on disk so that reopening
+  // them in a later session does not decode them again, the cache is set up
+  // once here since setting its size trims the directory
+  vtkImageDataReader::SetDiskCacheDirectory(
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+      .filePath("images").toStdString());
+  vtkImageDataReader::SetDiskCacheSize(
+    static_cast<vtkIdType>(settings.value("diskCacheSize", 4096).toInt()) *
+    1024);
+
   QStringList args = QCoreApplication::arguments();
   if (1 < args.size() && QFile::exists(args.last()))
   {
     this->loadFile(args.last());
   }
-
-  QProgressBar* progress = new QProgressBar();
-  this->statusbar->addPermanentWidget(progress);
-  progress->setVisible(false);
-  QPushButton* button = new QPushButton("Abort");
-  this->statusbar->addPermanentWidget(button);
-  button->setVisible(false);
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -266,13 +514,47 @@ void QBirchMainWindowPrivate::slotOpen()
   }
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::slotOpenDirectory()
+{
+  Q_Q(QBirchMainWindow);
+  QFileDialog dialog(q);
+
+  // this addresses a known and unfixable problem with native dialogs in KDE
+  dialog.setOption(QFileDialog::DontUseNativeDialog);
+  dialog.setOption(QFileDialog::ShowDirsOnly);
+  dialog.setFileMode(QFileDialog::Directory);
+  dialog.setModal(true);
+  if (dialog.exec())
+  {
+    QStringList fileNames = dialog.selectedFiles();
+    if (fileNames.isEmpty()) return;
+    this->loadFile(fileNames.first());
+  }
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchMainWindowPrivate::slotSave()
 {
   Q_Q(QBirchMainWindow);
+
+  // volumes are saved as .vti or MetaImage files, either quickly with LZ4
+  // or small with zlib, the last choice is offered first next time
+  QStringList filters;
+  filters
+    << QDialog::tr("Images (*.png *.pnm *.bmp *.jpg *.jpeg *.tif *.tiff)")
+    << QDialog::tr("VTK image, fast write (*.vti)")
+    << QDialog::tr("VTK image, small file (*.vti)")
+    << QDialog::tr("MetaImage, fast write (*.mha)")
+    << QDialog::tr("MetaImage, small file (*.mha)");
+  QSettings settings;
+  QString selectedFilter =
+    settings.value("saveFilter", filters.first()).toString();
+  if (!filters.contains(selectedFilter))
+    selectedFilter = filters.first();
   QString fileName = QFileDialog::getSaveFileName(q,
-    QDialog::tr("Save Image to File"), "",
-    QDialog::tr("Images (*.png *.pnm *.bmp *.jpg *.jpeg *.tif *.tiff)"));
+    QDialog::tr("Save Image to File"), "", filters.join(";;"),
+    &selectedFilter);
 
   if (fileName.isEmpty())
   {
@@ -280,42 +562,206 @@ void QBirchMainWindowPrivate::slotSave()
   }
   else
   {
-    this->imageWidget->save(fileName);
+    int filter = filters.indexOf(selectedFilter);
+    if (0 < filter)
+    {
+      QString suffix = 2 < filter ? "mha" : "vti";
+      if (QFileInfo(fileName).suffix().isEmpty())
+        fileName += "." + suffix;
+      settings.setValue("saveCompression", 1 == filter % 2 ? "fast" : "small");
+    }
+    settings.setValue("saveFilter", selectedFilter);
+    this->saveFile(fileName);
   }
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchMainWindowPrivate::loadFile(const QString& fileName)
+void QBirchMainWindowPrivate::slotSaveSlices()
+{
+  Q_Q(QBirchMainWindow);
+  QString fileName = QFileDialog::getSaveFileName(q,
+    QDialog::tr("Save All Slices to Numbered Files"), "",
+    QDialog::tr("Images (*.png *.tif *.tiff *.dcm)"));
+
+  if (!fileName.isEmpty())
+    this->saveFile(fileName, true);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::slotExportCine()
 {
   Q_Q(QBirchMainWindow);
-  bool success = true;
+  QBirchSliceView* view = this->imageWidget->sliceView();
+  if (!view->hasImageData() || this->cineWriter) return;
+
+  QString selectedFilter;
+  QString animated = QDialog::tr("Animated PNG (*.png)");
+  QString sequence = QDialog::tr("Numbered PNG files (*.png)");
+  QString fileName = QFileDialog::getSaveFileName(q,
+    QDialog::tr("Export Cine"), "", animated + ";;" + sequence,
+    &selectedFilter);
+  if (fileName.isEmpty()) return;
+
+  QSettings settings;
+  vtkNew<vtkCineWriter> writer;
+  writer->SetFileName(fileName.toStdString());
+  writer->SetFrameRate(settings.value("cineFrameRate", 10).toInt());
+  if (sequence == selectedFilter)
+    writer->SetFormatToPNGSequence();
+
+  // the frames are rendered here and encoded on the writer's own thread,
+  // processing events between frames lets the abort button through, so
+  // everything else is disabled until the export is done
+  this->qvtkConnection->Connect(writer.GetPointer(), vtkCommand::ProgressEvent,
+    this, SLOT(updateProgress(vtkObject*, unsigned long, void*, void*)));
+  this->startProgress(tr("Exporting %1").arg(this->strippedName(fileName)));
+  this->cineWriter = writer.GetPointer();
+  this->updateAbortButtons();
+  this->menubar->setEnabled(false);
+  this->centralwidget->setEnabled(false);
+  this->imagePropertiesDockWidget->setEnabled(false);
+
+  int frames = 0;
+  QString error;
   try
   {
-    vtkNew<vtkEventForwarderCommand> forward;
-    vtkNew<vtkObject> dummy;
-    forward->SetTarget(dummy.GetPointer());
-    this->qvtkConnection->Connect(dummy.GetPointer(), vtkCommand::StartEvent,
-      this, SLOT(showProgress(vtkObject*, unsigned long, void*, void*)));
-    this->qvtkConnection->Connect(dummy.GetPointer(), vtkCommand::EndEvent,
-      this, SLOT(hideProgress()));
-    this->qvtkConnection->Connect(dummy.GetPointer(), vtkCommand::ProgressEvent,
-      this, SLOT(updateProgress(vtkObject*, unsigned long, void*, void*)));
-    this->imageWidget->load(fileName, forward.GetPointer());
+    frames = view->writeCine(writer.GetPointer(),
+      settings.value("cineAnnotate", true).toBool());
   }
   catch (std::exception& e)
+  {
+    error = e.what();
+  }
+  this->cineWriter = 0;
+  this->menubar->setEnabled(true);
+  this->centralwidget->setEnabled(true);
+  this->imagePropertiesDockWidget->setEnabled(true);
+  this->qvtkConnection->Disconnect(writer.GetPointer());
+  this->hideProgress();
+
+  if (writer->GetAbortExecute())
+  {
+    this->statusbar->showMessage(tr("Export aborted"), 2000);
+  }
+  else if (error.isEmpty())
+  {
+    this->statusbar->showMessage(tr("Exported %1 frames").arg(frames), 2000);
+  }
+  else
   {
     QMessageBox errorMessage(q);
     errorMessage.setWindowModality(Qt::WindowModal);
     errorMessage.setIcon(QMessageBox::Warning);
     errorMessage.setText(
-      "There was an error while attempting to open the image.");
+      "There was an error while attempting to export the cine loop.");
+    errorMessage.setDetailedText(error);
     errorMessage.exec();
-    this->imageWidget->reset();
-    success = false;
   }
-  if (success)
-    this->setCurrentFile(fileName);
-  this->updateUi();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::saveFile(const QString& fileName, bool allSlices)
+{
+  QBirchSliceView* view = this->imageWidget->sliceView();
+  vtkImageData* image = this->imageWidget->imageData();
+  if (!image) return;
+  if (this->saver)
+  {
+    this->statusbar->showMessage(tr("A save is already in progress"), 2000);
+    return;
+  }
+
+  // the image is written on a worker thread from a snapshot, so viewing and
+  // loading carry on while the file is written
+  this->saver = new QBirchImageSaver(this);
+  connect(this->saver, SIGNAL(saveStarted(const QString&)),
+    this, SLOT(saveStarted(const QString&)));
+  connect(this->saver, SIGNAL(saveProgress(double)),
+    this, SLOT(saveProgress(double)));
+  connect(this->saver, SIGNAL(saveFinished(bool)),
+    this, SLOT(saveFinished(bool)));
+
+  // .vti and MetaImage files can be written quickly or kept small, as
+  // chosen in the save dialog, their compression runs on all cores
+  QSettings settings;
+  QString compression = settings.value("saveCompression").toString();
+  if ("fast" == compression)
+    this->saver->setCompression(vtkImageDataWriter::LZ4, 1);
+  else if ("small" == compression)
+    this->saver->setCompression(vtkImageDataWriter::ZLIB, 9);
+  else if ("none" == compression)
+    this->saver->setCompression(vtkImageDataWriter::NONE, 5);
+
+  this->saver->setFileName(fileName);
+  this->saver->setImageData(image);
+  this->saver->setOrientation(view->orientation());
+  this->saver->setSlice(view->slice());
+  QString suffix = QFileInfo(fileName).suffix().toLower();
+  if (allSlices)
+    this->saver->setMode(QBirchImageSaver::AllSlices);
+  else if (3 == view->dimensionality() &&
+           "vti" != suffix && "mha" != suffix && "mhd" != suffix)
+    this->saver->setMode(QBirchImageSaver::CurrentSlice);
+  else
+    this->saver->setMode(QBirchImageSaver::WholeImage);
+  this->saver->start();
+  this->updateAbortButtons();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::loadFile(const QString& fileName)
+{
+  // replace any load still in progress, and keep the prefetcher out of
+  // its way
+  if (this->loader)
+    this->loader->abort();
+  this->prefetcher->cancel();
+
+  // the image is read on a worker thread and swapped into the view by
+  // loadFinished once it is complete
+  this->loader = new QBirchImageLoader(this);
+  connect(this->loader, SIGNAL(loadStarted(const QString&)),
+    this, SLOT(loadStarted(const QString&)));
+  connect(this->loader, SIGNAL(loadProgress(double)),
+    this, SLOT(loadProgress(double)));
+  connect(this->loader, SIGNAL(slicesLoaded(int)),
+    this, SLOT(loadSlices(int)));
+  connect(this->loader, SIGNAL(loadFinished(bool)),
+    this, SLOT(loadFinished(bool)));
+
+  // volumes are streamed a few slices at a time so that the first slices
+  // can be viewed while the rest are read
+  QSettings settings;
+  this->loader->setStreamingSlabSize(
+    settings.value("streamingSlabSize", 8).toInt());
+
+  this->loader->setFileName(fileName);
+  this->loader->start();
+  this->updateAbortButtons();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchMainWindowPrivate::prefetchFiles()
+{
+  // prefetching is optional since it spends memory and cpu on files which
+  // may never be opened
+  QSettings settings;
+  if (!settings.value("prefetch", false).toBool())
+    return;
+
+  // the files either side of the current one, then the most recent files
+  QStringList files = QBirchImagePrefetcher::neighbours(this->currentFile);
+  QStringList recent = settings.value("recentFileList").toStringList();
+  int count = settings.value("prefetchRecentFiles", 2).toInt();
+  for (int i = 0; i < recent.size() && 0 < count; ++i)
+  {
+    if (recent[i] != this->currentFile && !files.contains(recent[i]))
+    {
+      files << recent[i];
+      count--;
+    }
+  }
+  this->prefetcher->prefetch(files);
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -369,7 +815,7 @@ void QBirchMainWindowPrivate::updateUi()
 {
   this->buildHistogram();
   this->buildLabels();
-  this->dicomTagWidget->load(this->currentFile);
+  this->dicomTagWidget->load(this->currentFile, this->currentMetaData);
   this->configureSharpenInterface();
 }
 
@@ -412,18 +858,11 @@ void QBirchMainWindowPrivate::buildLabels()
   this->labelImageScalarTypeValue->setText(str);
 
   double range[2];
-  double min = image->GetScalarTypeMax();
-  double max = image->GetScalarTypeMin();
-  for (int i = 0; i < n; ++i)
-  {
-    image->GetPointData()->GetScalars()->GetRange(range, i);
-    min = min < range[0] ? min : range[0];
-    max = max > range[1] ? max : range[1];
-  }
+  vtkImageDataStatistics::GetStatistics(image)->GetRange(range);
   str = "[";
-  str += vtkVariant(min).ToString();
+  str += vtkVariant(range[0]).ToString();
   str += ", ";
-  str += vtkVariant(max).ToString();
+  str += vtkVariant(range[1]).ToString();
   str += "]";
   this->labelImageScalarRangeValue->setText(str);
 
@@ -443,49 +882,53 @@ void QBirchMainWindowPrivate::buildHistogram()
   vtkImageData* image = this->imageWidget->imageData();
   if (!image) return;
 
-  int nc = image->GetNumberOfScalarComponents();
-  double range[2];
-  double min = image->GetScalarTypeMax();
-  double max = image->GetScalarTypeMin();
-
-  for (int i = 0; i < nc; ++i)
-  {
-    image->GetPointData()->GetScalars()->GetRange(range, i);
-    min = min < range[0] ? min : range[0];
-    max = max > range[1] ? max : range[1];
-  }
-
-  vtkNew<vtkImageHistogram> histogram;
-  histogram->GenerateHistogramImageOff();
-  histogram->SetInputData(image);
-  histogram->SetBinOrigin(min);
-  histogram->SetBinSpacing(1);
-  histogram->SetNumberOfBins(static_cast<int>(max-min) + 1);
-  histogram->AutomaticBinningOff();
+  // the histograms are computed once and shared with the image's other
+  // consumers
+  vtkImageDataStatistics* statistics =
+    vtkImageDataStatistics::GetStatistics(image);
+  int nc = statistics->GetNumberOfComponents();
+  if (0 == nc) return;
+
+  // 16-bit and floating point histograms have up to 65536 bins, far more
+  // than the chart has pixels to plot, so neighbouring bins are summed to
+  // plot at most 1024
+  const vtkIdType maximumBins = 1024;
+  vtkIdType histogramBins =
+    static_cast<vtkIdType>(statistics->GetHistogram(0).size());
+  if (0 == histogramBins) return;
+  vtkIdType binsPerPoint = (histogramBins + maximumBins - 1) / maximumBins;
+  vtkIdType numberOfBins = (histogramBins + binsPerPoint - 1) / binsPerPoint;
 
   vtkNew<vtkDataArrayCollection> channels;
   for (int i = 0; i < nc; ++i)
   {
-    histogram->SetActiveComponent(i);
-    histogram->Update();
+    const std::vector<vtkIdType>& histogram = statistics->GetHistogram(i);
     vtkNew<vtkIdTypeArray> channel;
-    channel->DeepCopy(histogram->GetHistogram());
+    channel->SetNumberOfValues(numberOfBins);
+    channel->FillComponent(0, 0);
+    vtkIdType* counts = channel->GetPointer(0);
+    for (vtkIdType j = 0; j < static_cast<vtkIdType>(histogram.size()); ++j)
+    {
+      counts[j / binsPerPoint] += histogram[j];
+    }
     channel->SetName(vtkVariant(i).ToString());
     channels->AddItem(channel.GetPointer());
   }
 
   vtkNew<vtkTable> table;
-  table->SetNumberOfRows(histogram->GetNumberOfBins());
+  table->SetNumberOfRows(numberOfBins);
 
-  vtkNew<vtkIntArray> xvalues;
-  xvalues->SetNumberOfValues(histogram->GetNumberOfBins());
+  // floating point images are binned finer than unit width
+  vtkNew<vtkDoubleArray> xvalues;
+  xvalues->SetNumberOfValues(numberOfBins);
   xvalues->SetName("values");
   table->AddColumn(xvalues.GetPointer());
 
-  int start = static_cast<int>(histogram->GetBinOrigin());
-  for (int i = 0; i < table->GetNumberOfRows(); ++i)
+  double start = statistics->GetBinOrigin();
+  double spacing = statistics->GetBinSpacing() * binsPerPoint;
+  for (vtkIdType i = 0; i < numberOfBins; ++i)
   {
-    table->SetValue(i, 0, start + i);
+    table->SetValue(i, 0, start + i*spacing);
   }
 
   vtkPlot* line = 0;
@@ -582,5 +1025,14 @@ QBirchMainWindow::~QBirchMainWindow()
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchMainWindow::closeEvent(QCloseEvent* event)
 {
+  Q_D(QBirchMainWindow);
+
+  // a cine export runs on this thread, stop it before closing
+  if (d->cineWriter)
+  {
+    d->cineWriter->AbortExecuteOn();
+    event->ignore();
+    return;
+  }
   event->accept();
 }
@@ -21,10 +21,16 @@
 // VTK includes
 #include <vtkSmartPointer.h>
 
+class QBirchImageLoader;
+class QBirchImagePrefetcher;
+class QBirchImageSaver;
+class vtkCineWriter;
 class vtkContextView;
+class vtkDICOMMetaData;
 class vtkEventQtSlotConnect;
 class vtkObject;
 class QAction;
+class QPushButton;
 class QWidget;
 class QSignalMapper;
 
@@ -49,7 +55,10 @@ class QBirchMainWindowPrivate : public QObject, public Ui_QBirchMainWindow
   public slots:
     // action event functions
     virtual void slotOpen();
+    virtual void slotOpenDirectory();
     virtual void slotSave();
+    virtual void slotSaveSlices();
+    virtual void slotExportCine();
     void openRecentFile();
     void onMapped(QWidget* widget);
     void sharpenImage();
@@ -57,6 +66,16 @@ class QBirchMainWindowPrivate : public QObject, public Ui_QBirchMainWindow
     void showProgress(vtkObject*, unsigned long, void*, void* call_data);
     void hideProgress();
     void updateProgress(vtkObject*, unsigned long, void*, void* call_data);
+    void loadStarted(const QString& message);
+    void loadProgress(double value);
+    void loadSlices(int count);
+    void loadFinished(bool success);
+    void abortLoad();
+    void abortSave();
+    void abortExport();
+    void saveStarted(const QString& message);
+    void saveProgress(double value);
+    void saveFinished(bool success);
 
   protected:
     QStringList fileHistory;
@@ -68,14 +87,39 @@ class QBirchMainWindowPrivate : public QObject, public Ui_QBirchMainWindow
     QString strippedName(const QString &fullFileName);
     void setCurrentFile(const QString &fileName);
     void loadFile(const QString &fileName);
-    void saveFile(const QString &fileName);
+    void saveFile(const QString &fileName, bool allSlices = false);
+    void startProgress(const QString& message);
+    void setProgress(double value);
+    void updateAbortButtons();
 
     QString currentFile;
+
+    // the DICOM attributes read along with the current image
+    vtkSmartPointer<vtkDICOMMetaData> currentMetaData;
     enum { MaxRecentFiles = 10 };
     QAction* recentFileActs[MaxRecentFiles];
     QAction* separatorAct;
 
     QSignalMapper* signalMapper;
+
+    // the worker thread of the load in progress, if any
+    QBirchImageLoader* loader;
+
+    // decodes the files likely to be opened next into the image cache
+    QBirchImagePrefetcher* prefetcher;
+
+    // the worker thread of the save in progress, if any
+    QBirchImageSaver* saver;
+
+    // the writer of the cine export in progress, if any
+    vtkCineWriter* cineWriter;
+
+    // each job has its own abort button, shown while the job runs
+    QPushButton* abortLoadButton;
+    QPushButton* abortSaveButton;
+    QPushButton* abortExportButton;
+
+    void prefetchFiles();
 };
 
 #endif
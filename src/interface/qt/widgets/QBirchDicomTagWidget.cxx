@@ -33,6 +33,7 @@
 #include <stdlib.h>
 
 // C++ includes
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -51,13 +52,13 @@ class QBirchDicomTagWidgetPrivate : public Ui_QBirchDicomTagWidget
 
     virtual void setupUi(QWidget* widget);
     virtual void updateUi();
-    virtual void setFileName(const QString& fileName);
+    virtual void setFileName(
+      const QString& fileName, vtkDICOMMetaData* metaData = 0);
     virtual void buildDicomStrings();
 
   private:
     std::vector<std::vector<std::string>> dicomStrings;
     QString fileName;
-    vtkSmartPointer<vtkDICOMParser> parser;
     vtkSmartPointer<vtkDICOMMetaData> data;
 };
 
@@ -65,9 +66,6 @@ class QBirchDicomTagWidgetPrivate : public Ui_QBirchDicomTagWidget
 QBirchDicomTagWidgetPrivate::QBirchDicomTagWidgetPrivate(
   QBirchDicomTagWidget& object) : q_ptr(&object)
 {
-  this->parser = vtkSmartPointer<vtkDICOMParser>::New();
-  this->data = vtkSmartPointer<vtkDICOMMetaData>::New();
-  this->parser->SetMetaData(data);
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -78,12 +76,48 @@ void QBirchDicomTagWidgetPrivate::setupUi(QWidget* widget)
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchDicomTagWidgetPrivate::setFileName(const QString& aFileName)
+void QBirchDicomTagWidgetPrivate::setFileName(
+  const QString& aFileName, vtkDICOMMetaData* metaData)
 {
+  // the attributes shared by the reader are already listed
+  if (metaData && metaData == this->data && aFileName == this->fileName)
+  {
+    return;
+  }
+
   this->fileName = aFileName;
+  this->data = metaData;
   this->updateUi();
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+// The parser stops at the pixel data, so the length of uncompressed pixel
+// data is worked out from the image attributes.  Encapsulated (compressed)
+// pixel data has an undefined length.
+//
+static unsigned int pixelDataLength(vtkDICOMMetaData* meta)
+{
+  std::string syntax =
+    meta->GetAttributeValue(0, DC::TransferSyntaxUID).AsString();
+  if (!syntax.empty() &&
+      "1.2.840.10008.1.2" != syntax &&
+      "1.2.840.10008.1.2.1" != syntax &&
+      "1.2.840.10008.1.2.1.99" != syntax &&
+      "1.2.840.10008.1.2.2" != syntax)
+  {
+    return 0xffffffffu;
+  }
+
+  vtkTypeInt64 bits =
+    static_cast<vtkTypeInt64>(meta->GetAttributeValue(0, DC::Rows).AsInt()) *
+    meta->GetAttributeValue(0, DC::Columns).AsInt() *
+    std::max(1, meta->GetAttributeValue(0, DC::SamplesPerPixel).AsInt()) *
+    std::max(1, meta->GetAttributeValue(0, DC::NumberOfFrames).AsInt()) *
+    meta->GetAttributeValue(0, DC::BitsAllocated).AsInt();
+  return static_cast<unsigned int>(
+    std::min(static_cast<vtkTypeInt64>(0xfffffffeu), (bits + 7) / 8));
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 // The following recursion function was adapted from vtk-dicom
 // Programs/dicomcump.cxx
@@ -330,19 +364,31 @@ void QBirchDicomTagWidgetPrivate::buildDicomStrings()
     return;
   }
 
-  this->data->Clear();
-  this->data->SetNumberOfInstances(1);
-  std::string name = this->fileName.toStdString();
+  unsigned int pixelDataVL = 0;
+  if (this->data)
+  {
+    pixelDataVL = pixelDataLength(this->data);
+  }
+  else
+  {
+    // nothing was shared, parse the file's header
+    std::string name = this->fileName.toStdString();
 
-  // make sure we can read the file
-  vtkNew<vtkDICOMReader> reader;
-  if (!reader->CanReadFile(name.c_str())) return;
+    // make sure we can read the file
+    vtkNew<vtkDICOMReader> reader;
+    if (!reader->CanReadFile(name.c_str())) return;
+
+    this->data = vtkSmartPointer<vtkDICOMMetaData>::New();
+    this->data->SetNumberOfInstances(1);
+    vtkNew<vtkDICOMParser> parser;
+    parser->SetMetaData(this->data);
+    parser->SetFileName(name.c_str());
+    parser->Update();
+    pixelDataVL = parser->GetPixelDataVL();
+  }
 
-  this->parser->SetFileName(name.c_str());
-  this->parser->Update();
   vtkDICOMDataElementIterator iter = this->data->Begin();
   vtkDICOMDataElementIterator iterEnd = this->data->End();
-  unsigned int pixelDataVL = parser->GetPixelDataVL();
   for (; iter != iterEnd; ++iter)
   {
     printElement(this->data, 0, iter, 0, pixelDataVL, &this->dicomStrings);
@@ -419,5 +465,12 @@ void QBirchDicomTagWidget::load(const QString& fileName)
 {
   Q_D(QBirchDicomTagWidget);
   d->setFileName(fileName);
-  d->updateUi();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchDicomTagWidget::load(
+  const QString& fileName, vtkDICOMMetaData* metaData)
+{
+  Q_D(QBirchDicomTagWidget);
+  d->setFileName(fileName, metaData);
 }
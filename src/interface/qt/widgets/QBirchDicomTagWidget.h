@@ -14,6 +14,7 @@
 #include <QWidget>
 
 class QBirchDicomTagWidgetPrivate;
+class vtkDICOMMetaData;
 
 class QBirchDicomTagWidget : public QWidget
 {
@@ -24,6 +25,14 @@ class QBirchDicomTagWidget : public QWidget
     explicit QBirchDicomTagWidget(QWidget* parent = 0);
     virtual ~QBirchDicomTagWidget();
 
+    /**
+     * List the attributes of a file whose header has already been parsed,
+     * such as those of vtkImageDataReader::GetMetaData, instead of parsing
+     * the file again.  The list is only rebuilt when the file or its
+     * attributes change.  If metaData is null the file's header is parsed.
+     */
+    virtual void load(const QString& aFileName, vtkDICOMMetaData* metaData);
+
   public Q_SLOTS:
     virtual void load(const QString& aFileName);
 
@@ -185,8 +185,9 @@ QBirchFramePlayerWidgetPrivate::retrievePipelineInfo()
       return pipeInfo;
     }
 
+    // only the slices that have been loaded can be played
     pipeInfo.frameRange[0] = q->sliceViewPointer->sliceMin();
-    pipeInfo.frameRange[1] = q->sliceViewPointer->sliceMax();
+    pipeInfo.frameRange[1] = q->sliceViewPointer->loadedSliceMax();
     pipeInfo.numberOfFrames =
       pipeInfo.frameRange[1] - pipeInfo.frameRange[0] + 1;
     pipeInfo.currentFrame = q->sliceViewPointer->slice();
@@ -448,10 +449,19 @@ void QBirchFramePlayerWidget::setSliceView(QBirchSliceView* view)
   {
     connect(this->sliceViewPointer.data(), SIGNAL(imageDataChanged()),
              this, SLOT(update()));
+    connect(this->sliceViewPointer.data(), SIGNAL(loadedSlicesChanged(int)),
+             this, SLOT(onLoadedSlicesChanged()));
   }
   d->updateUi();
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchFramePlayerWidget::onLoadedSlicesChanged()
+{
+  Q_D(QBirchFramePlayerWidget);
+  d->updateUi();
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchFramePlayerWidget::goToCurrentFrame()
 {
@@ -385,6 +385,11 @@ class QBirchFramePlayerWidget : public QWidget
   protected Q_SLOTS:
     virtual void onTick();
 
+    /**
+     * Update the range of frames as the slice view's image is loaded.
+     */
+    virtual void onLoadedSlicesChanged();
+
   Q_SIGNALS:
     /** Emitted when the frame has been changed */
     void currentFrameChanged(double frame);
@@ -0,0 +1,347 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImageLoader.cxx
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#include <QBirchImageLoader.h>
+
+// Birch includes
+#include <Common.h>
+#include <vtkImageDataReader.h>
+
+// VTK includes
+#include <vtkAlgorithm.h>
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMedicalImageProperties.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+// vtk-dicom includes
+#include <vtkDICOMMetaData.h>
+
+// Qt includes
+#include <QMutex>
+#include <QMutexLocker>
+
+// C++ includes
+#include <sstream>
+#include <stdexcept>
+
+class QBirchImageLoaderPrivate
+{
+  Q_DECLARE_PUBLIC(QBirchImageLoader);
+  protected:
+    QBirchImageLoader* const q_ptr;
+
+  public:
+    explicit QBirchImageLoaderPrivate(QBirchImageLoader& object);
+    virtual ~QBirchImageLoaderPrivate();
+
+    void readerEvent(vtkObject* caller, unsigned long event, void* callData);
+
+    QString fileName;
+    QString errorMessage;
+    bool aborted;
+    int streamingSlabSize;
+    vtkSmartPointer<vtkImageData> ImageData;
+    vtkSmartPointer<vtkImageData> PartialImageData;
+    vtkSmartPointer<vtkMedicalImageProperties> MedicalImageProperties;
+    vtkSmartPointer<vtkDICOMMetaData> MetaData;
+
+    // guards the reader, which is shared between run() and abort(), and
+    // the reader's streamed volume, whose scalars the partial volume shares
+    mutable QMutex mutex;
+    vtkImageDataReader* Reader;
+    vtkSmartPointer<vtkImageData> StreamedImageData;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+class QBirchImageLoaderCallback : public vtkCommand
+{
+  public:
+    static QBirchImageLoaderCallback* New()
+      { return new QBirchImageLoaderCallback; }
+
+    void Execute(vtkObject* caller, unsigned long event, void* callData)
+    {
+      if (!this->pimpl) return;
+      this->pimpl->readerEvent(caller, event, callData);
+    }
+
+    QBirchImageLoaderCallback():pimpl(0){}
+    ~QBirchImageLoaderCallback(){ this->pimpl = 0; }
+    QBirchImageLoaderPrivate* pimpl;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImageLoaderPrivate methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageLoaderPrivate::QBirchImageLoaderPrivate(
+  QBirchImageLoader& object)
+  : q_ptr(&object)
+{
+  this->aborted = false;
+  this->streamingSlabSize = 0;
+  this->Reader = 0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageLoaderPrivate::~QBirchImageLoaderPrivate()
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageLoaderPrivate::readerEvent(
+  vtkObject* caller, unsigned long event, void* callData)
+{
+  Q_Q(QBirchImageLoader);
+  switch (event)
+  {
+    case vtkCommand::StartEvent:
+      emit q->loadStarted(QString("Loading %1").arg(this->fileName));
+      break;
+    case vtkCommand::ProgressEvent:
+      emit q->loadProgress(*(reinterpret_cast<double*>(callData)));
+      break;
+    case vtkCommand::EndEvent:
+      emit q->loadProgress(1.0);
+      break;
+    case Birch::Common::SlicesLoadedEvent:
+      {
+        // the loaded slices are shared by updatePartialImageData, the rest
+        // of the volume is still being written
+        QMutexLocker locker(&this->mutex);
+        if (!this->StreamedImageData)
+        {
+          vtkImageDataReader* reader =
+            vtkImageDataReader::SafeDownCast(caller);
+          this->StreamedImageData = reader->GetStreamedOutput();
+        }
+      }
+      emit q->slicesLoaded(*(reinterpret_cast<int*>(callData)));
+      break;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImageLoader methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageLoader::QBirchImageLoader(QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new QBirchImageLoaderPrivate(*this))
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageLoader::~QBirchImageLoader()
+{
+  this->abort();
+  this->wait();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageLoader::setFileName(const QString& fileName)
+{
+  Q_D(QBirchImageLoader);
+  if (this->isRunning()) return;
+  d->fileName = fileName;
+  QMutexLocker locker(&d->mutex);
+  d->aborted = false;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QString QBirchImageLoader::fileName() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->fileName;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageLoader::setStreamingSlabSize(int size)
+{
+  Q_D(QBirchImageLoader);
+  if (this->isRunning()) return;
+  d->streamingSlabSize = qMax(0, size);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int QBirchImageLoader::streamingSlabSize() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->streamingSlabSize;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* QBirchImageLoader::partialImageData() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->PartialImageData.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* QBirchImageLoader::updatePartialImageData()
+{
+  Q_D(QBirchImageLoader);
+  if (d->PartialImageData)
+    return d->PartialImageData.GetPointer();
+
+  vtkSmartPointer<vtkImageData> streamed;
+  {
+    QMutexLocker locker(&d->mutex);
+    streamed = d->StreamedImageData;
+  }
+  if (!streamed || !streamed->GetPointData()->GetScalars())
+    return 0;
+
+  // a volume of this thread's own sharing the reader's scalars, nothing is
+  // copied: the slices not yet reported as loaded are still being written
+  // and are left to the view not to read
+  d->PartialImageData = vtkSmartPointer<vtkImageData>::New();
+  d->PartialImageData->SetExtent(streamed->GetExtent());
+  d->PartialImageData->SetSpacing(streamed->GetSpacing());
+  d->PartialImageData->SetOrigin(streamed->GetOrigin());
+  d->PartialImageData->GetPointData()->SetScalars(
+    streamed->GetPointData()->GetScalars());
+  return d->PartialImageData.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* QBirchImageLoader::imageData() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->ImageData.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkMedicalImageProperties* QBirchImageLoader::medicalImageProperties() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->MedicalImageProperties.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkDICOMMetaData* QBirchImageLoader::metaData() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->MetaData.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QString QBirchImageLoader::errorMessage() const
+{
+  Q_D(const QBirchImageLoader);
+  return d->errorMessage;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool QBirchImageLoader::isAborted() const
+{
+  Q_D(const QBirchImageLoader);
+  QMutexLocker locker(&d->mutex);
+  return d->aborted;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageLoader::abort()
+{
+  Q_D(QBirchImageLoader);
+  QMutexLocker locker(&d->mutex);
+  if (!this->isRunning()) return;
+  d->aborted = true;
+  if (d->Reader)
+  {
+    d->Reader->SetAbortExecute(1);
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageLoader::run()
+{
+  Q_D(QBirchImageLoader);
+  d->ImageData = 0;
+  d->PartialImageData = 0;
+  {
+    QMutexLocker locker(&d->mutex);
+    d->StreamedImageData = 0;
+  }
+  d->MedicalImageProperties = 0;
+  d->MetaData = 0;
+  d->errorMessage.clear();
+
+  bool success = false;
+  std::string fileName = d->fileName.toStdString();
+  vtkNew<vtkImageDataReader> reader;
+  vtkNew<QBirchImageLoaderCallback> callback;
+  callback->pimpl = d;
+  try
+  {
+    if (!vtkImageDataReader::IsValidFileName(fileName.c_str()))
+    {
+      std::stringstream stream;
+      stream << "Unable to load image file \"" << fileName << "\"";
+      throw std::runtime_error(stream.str());
+    }
+
+    reader->SetFileName(fileName.c_str());
+    reader->SetStreamingSlabSize(d->streamingSlabSize);
+
+    reader->AddObserver(vtkCommand::StartEvent, callback.GetPointer());
+    reader->AddObserver(vtkCommand::ProgressEvent, callback.GetPointer());
+    reader->AddObserver(vtkCommand::EndEvent, callback.GetPointer());
+    reader->AddObserver(
+      Birch::Common::SlicesLoadedEvent, callback.GetPointer());
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Reader = reader.GetPointer();
+      if (d->aborted)
+        reader->SetAbortExecute(1);
+    }
+
+    vtkImageData* image = reader->GetOutput();
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Reader = 0;
+    }
+
+    if (!this->isAborted())
+    {
+      if (!image)
+      {
+        std::stringstream stream;
+        stream << "Unable to load image file \"" << fileName << "\"";
+        throw std::runtime_error(stream.str());
+      }
+
+      // hand over a copy detached from the reader's pipeline
+      d->ImageData = vtkSmartPointer<vtkImageData>::New();
+      d->ImageData->ShallowCopy(image);
+      d->MedicalImageProperties =
+        vtkSmartPointer<vtkMedicalImageProperties>::New();
+      d->MedicalImageProperties->DeepCopy(
+        reader->GetMedicalImageProperties());
+      d->MetaData = reader->GetMetaData();
+      success = true;
+    }
+  }
+  catch (std::exception& e)
+  {
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Reader = 0;
+    }
+    d->errorMessage = e.what();
+  }
+
+  emit this->loadFinished(success);
+}
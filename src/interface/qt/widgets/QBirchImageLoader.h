@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImageLoader.h
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#ifndef __QBirchImageLoader_h
+#define __QBirchImageLoader_h
+
+// Qt includes
+#include <QThread>
+
+class QBirchImageLoaderPrivate;
+class vtkDICOMMetaData;
+class vtkImageData;
+class vtkMedicalImageProperties;
+
+/**
+ * @class QBirchImageLoader
+ *
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief Load an image file on a worker thread.
+ *
+ * The file is read by a vtkImageDataReader in the thread's run method.
+ * The reader's start, progress and end events are re-emitted as signals,
+ * which Qt queues across to the receiver's thread, and the load can be
+ * cancelled through the reader's AbortExecute flag.  The image is only
+ * made available once it has been completely read, unless the load is
+ * streamed, in which case a volume sharing the scalars the reader is
+ * filling, without copying them, can be displayed as it is filled.  Only
+ * the slices reported by slicesLoaded may then be read from it: the rest
+ * are still being written by the loading thread.
+ */
+class QBirchImageLoader : public QThread
+{
+  Q_OBJECT
+
+  public:
+    typedef QThread Superclass;
+    explicit QBirchImageLoader(QObject* parent = 0);
+    virtual ~QBirchImageLoader();
+
+    void setFileName(const QString& fileName);
+    QString fileName() const;
+
+    /**
+     * Set/Get the number of slices read at a time.  When non-zero the
+     * volume is streamed: slicesLoaded is emitted after each slab and the
+     * partially read volume is available from partialImageData.
+     */
+    void setStreamingSlabSize(int size);
+    int streamingSlabSize() const;
+
+    /**
+     * The volume being filled by a streamed load, null until the first
+     * call to updatePartialImageData.  Only its first slices, as many as
+     * slicesLoaded last reported, may be read until the load finishes.
+     */
+    vtkImageData* partialImageData() const;
+
+    /**
+     * Return the partial volume, creating it on the first call after
+     * slicesLoaded has been emitted.  It shares the scalars of the
+     * reader's volume, which are not copied, and holds the complete image
+     * once the load succeeds.  Must be called from the thread the volume
+     * is displayed on, never from the loading thread.
+     */
+    vtkImageData* updatePartialImageData();
+
+    /**
+     * The loaded image and its properties.  These are null unless the
+     * loadFinished signal reported success.
+     */
+    vtkImageData* imageData() const;
+    vtkMedicalImageProperties* medicalImageProperties() const;
+
+    /**
+     * The DICOM attributes read along with the image, null if the image is
+     * not DICOM or the load did not succeed.
+     */
+    vtkDICOMMetaData* metaData() const;
+
+    QString errorMessage() const;
+    bool isAborted() const;
+
+  public slots:
+    void abort();
+
+  Q_SIGNALS:
+    void loadStarted(const QString& message);
+    void loadProgress(double value);
+    void slicesLoaded(int count);
+    void loadFinished(bool success);
+
+  protected:
+    QScopedPointer<QBirchImageLoaderPrivate> d_ptr;
+
+    virtual void run();
+
+  private:
+    Q_DECLARE_PRIVATE(QBirchImageLoader);
+    Q_DISABLE_COPY(QBirchImageLoader);
+};
+
+#endif
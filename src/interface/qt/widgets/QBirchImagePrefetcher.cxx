@@ -0,0 +1,208 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImagePrefetcher.cxx
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#include <QBirchImagePrefetcher.h>
+
+// Birch includes
+#include <vtkImageDataReader.h>
+
+// VTK includes
+#include <vtkNew.h>
+
+// Qt includes
+#include <QDir>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+// C++ includes
+#include <stdexcept>
+#include <string>
+
+class QBirchImagePrefetcherPrivate
+{
+  Q_DECLARE_PUBLIC(QBirchImagePrefetcher);
+  protected:
+    QBirchImagePrefetcher* const q_ptr;
+
+  public:
+    explicit QBirchImagePrefetcherPrivate(QBirchImagePrefetcher& object);
+    virtual ~QBirchImagePrefetcherPrivate();
+
+    void read(const QString& fileName, int generation);
+
+    QThreadPool pool;
+
+    // guards the generation and the readers, tasks queued by an earlier
+    // generation are dropped when they come to run
+    QMutex mutex;
+    int generation;
+    QList<vtkImageDataReader*> readers;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+class QBirchImagePrefetcherTask : public QRunnable
+{
+  public:
+    QBirchImagePrefetcherTask(QBirchImagePrefetcherPrivate* pimpl,
+      const QString& fileName, int generation)
+      : pimpl(pimpl), fileName(fileName), generation(generation) {}
+
+    void run()
+    {
+      QThread::currentThread()->setPriority(QThread::LowestPriority);
+      this->pimpl->read(this->fileName, this->generation);
+    }
+
+  private:
+    QBirchImagePrefetcherPrivate* pimpl;
+    QString fileName;
+    int generation;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImagePrefetcherPrivate methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImagePrefetcherPrivate::QBirchImagePrefetcherPrivate(
+  QBirchImagePrefetcher& object)
+  : q_ptr(&object)
+{
+  // one file at a time, the readers decode on several threads themselves
+  this->pool.setMaxThreadCount(1);
+  this->generation = 0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImagePrefetcherPrivate::~QBirchImagePrefetcherPrivate()
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImagePrefetcherPrivate::read(
+  const QString& fileName, int taskGeneration)
+{
+  std::string name = fileName.toStdString();
+  vtkNew<vtkImageDataReader> reader;
+  try
+  {
+    if (!vtkImageDataReader::IsValidFileName(name.c_str()))
+      return;
+    reader->SetFileName(name.c_str());
+  }
+  catch (std::exception&)
+  {
+    return;
+  }
+
+  // mapped images are not kept by the cache, so decode instead, and read
+  // a slab at a time so that cancel() is heeded between slabs even by
+  // readers which never check AbortExecute themselves
+  reader->MemoryMappingOff();
+  reader->SetStreamingSlabSize(16);
+
+  {
+    QMutexLocker locker(&this->mutex);
+    if (taskGeneration != this->generation)
+      return;
+    this->readers.append(reader.GetPointer());
+  }
+
+  // the decoded image is kept by the reader's cache
+  try
+  {
+    reader->GetOutput();
+  }
+  catch (std::exception&)
+  {
+  }
+
+  QMutexLocker locker(&this->mutex);
+  this->readers.removeOne(reader.GetPointer());
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImagePrefetcher methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImagePrefetcher::QBirchImagePrefetcher(QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new QBirchImagePrefetcherPrivate(*this))
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImagePrefetcher::~QBirchImagePrefetcher()
+{
+  Q_D(QBirchImagePrefetcher);
+  this->cancel();
+  d->pool.waitForDone();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImagePrefetcher::prefetch(const QStringList& fileNames)
+{
+  Q_D(QBirchImagePrefetcher);
+  this->cancel();
+
+  int generation;
+  {
+    QMutexLocker locker(&d->mutex);
+    generation = d->generation;
+  }
+  foreach (const QString& fileName, fileNames)
+  {
+    if (!fileName.isEmpty())
+      d->pool.start(new QBirchImagePrefetcherTask(d, fileName, generation));
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImagePrefetcher::cancel()
+{
+  Q_D(QBirchImagePrefetcher);
+  d->pool.clear();
+
+  QMutexLocker locker(&d->mutex);
+  d->generation++;
+  foreach (vtkImageDataReader* reader, d->readers)
+  {
+    reader->SetAbortExecute(1);
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QStringList QBirchImagePrefetcher::neighbours(const QString& fileName)
+{
+  QStringList result;
+  QFileInfo info(fileName);
+  if (fileName.isEmpty() || !info.exists())
+    return result;
+
+  // series are opened as directories, their neighbours are directories
+  QDir::Filters filters = info.isDir() ?
+    QDir::Dirs | QDir::NoDotAndDotDot : QDir::Files;
+  QDir directory = info.absoluteDir();
+  QStringList entries = directory.entryList(filters, QDir::Name);
+  int index = entries.indexOf(info.fileName());
+  if (-1 == index)
+    return result;
+
+  if (index + 1 < entries.size())
+    result << directory.filePath(entries[index + 1]);
+  if (0 < index)
+    result << directory.filePath(entries[index - 1]);
+  return result;
+}
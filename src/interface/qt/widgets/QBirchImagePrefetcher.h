@@ -0,0 +1,70 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImagePrefetcher.h
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#ifndef __QBirchImagePrefetcher_h
+#define __QBirchImagePrefetcher_h
+
+// Qt includes
+#include <QObject>
+#include <QStringList>
+
+class QBirchImagePrefetcherPrivate;
+
+/**
+ * @class QBirchImagePrefetcher
+ *
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief Decode image files in the background ahead of their being opened.
+ *
+ * Each file is read by a vtkImageDataReader on a low priority thread of the
+ * prefetcher's own thread pool, which leaves the decoded image in the
+ * reader's cache of decoded images.  A later load of the same file then
+ * hits the cache instead of decoding the file.  Files are decoded rather
+ * than memory mapped, since mapped images are not cached, and read in slabs
+ * so that a cancelled read stops at the next slab.  Files which cannot be
+ * read are silently skipped.
+ */
+class QBirchImagePrefetcher : public QObject
+{
+  Q_OBJECT
+
+  public:
+    typedef QObject Superclass;
+    explicit QBirchImagePrefetcher(QObject* parent = 0);
+    virtual ~QBirchImagePrefetcher();
+
+    /**
+     * Replace any files waiting to be prefetched with fileNames, which are
+     * decoded in order.
+     */
+    void prefetch(const QStringList& fileNames);
+
+    /**
+     * The files or, for a directory, the directories either side of
+     * fileName in its parent directory, sorted by name.
+     */
+    static QStringList neighbours(const QString& fileName);
+
+  public slots:
+    /**
+     * Drop the files waiting to be prefetched and abort those being read,
+     * so that a foreground load has the machine to itself.
+     */
+    void cancel();
+
+  protected:
+    QScopedPointer<QBirchImagePrefetcherPrivate> d_ptr;
+
+  private:
+    Q_DECLARE_PRIVATE(QBirchImagePrefetcher);
+    Q_DISABLE_COPY(QBirchImagePrefetcher);
+};
+
+#endif
@@ -0,0 +1,417 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImageSaver.cxx
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#include <QBirchImageSaver.h>
+
+// Birch includes
+#include <Utilities.h>
+#include <vtkImageDataWriter.h>
+
+// VTK includes
+#include <vtkAlgorithm.h>
+#include <vtkCommand.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+
+// Qt includes
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+// C++ includes
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+class QBirchImageSaverPrivate
+{
+  Q_DECLARE_PUBLIC(QBirchImageSaver);
+  protected:
+    QBirchImageSaver* const q_ptr;
+
+  public:
+    explicit QBirchImageSaverPrivate(QBirchImageSaver& object);
+    virtual ~QBirchImageSaverPrivate();
+
+    void writerEvent(unsigned long event, void* callData);
+    void abortWriter();
+    static std::string partialFileName(const std::string& fileName);
+    static bool replaceFile(const std::string& from, const std::string& to);
+
+    QString fileName;
+    QString errorMessage;
+    bool aborted;
+    QBirchImageSaver::Mode mode;
+    int orientation;
+    int slice;
+    int slicesWritten;
+    int compressor;
+    int compressionLevel;
+    vtkSmartPointer<vtkImageData> ImageData;
+
+    // guards the writer, which is shared between run() and abort()
+    mutable QMutex mutex;
+    vtkImageDataWriter* Writer;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+class QBirchImageSaverCallback : public vtkCommand
+{
+  public:
+    static QBirchImageSaverCallback* New()
+      { return new QBirchImageSaverCallback; }
+
+    void Execute(vtkObject*, unsigned long event, void* callData)
+    {
+      if (!this->pimpl) return;
+      this->pimpl->writerEvent(event, callData);
+    }
+
+    QBirchImageSaverCallback():pimpl(0){}
+    ~QBirchImageSaverCallback(){ this->pimpl = 0; }
+    QBirchImageSaverPrivate* pimpl;
+};
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImageSaverPrivate methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageSaverPrivate::QBirchImageSaverPrivate(
+  QBirchImageSaver& object)
+  : q_ptr(&object)
+{
+  this->aborted = false;
+  this->mode = QBirchImageSaver::WholeImage;
+  this->orientation = 2;
+  this->slice = 0;
+  this->slicesWritten = 0;
+  this->compressor = vtkImageDataWriter::DEFAULT;
+  this->compressionLevel = 5;
+  this->Writer = 0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageSaverPrivate::~QBirchImageSaverPrivate()
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaverPrivate::writerEvent(unsigned long event, void* callData)
+{
+  Q_Q(QBirchImageSaver);
+  switch (event)
+  {
+    case vtkCommand::StartEvent:
+      emit q->saveStarted(QString("Saving %1").arg(this->fileName));
+      break;
+    case vtkCommand::ProgressEvent:
+      emit q->saveProgress(*(reinterpret_cast<double*>(callData)));
+      break;
+    case vtkCommand::EndEvent:
+      emit q->saveProgress(1.0);
+      break;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaverPrivate::abortWriter()
+{
+  // the slice export and the underlying file writer each have their own flag
+  this->Writer->AbortExecuteOn();
+  if (this->Writer->GetWriter())
+  {
+    this->Writer->GetWriter()->SetAbortExecute(1);
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+std::string QBirchImageSaverPrivate::partialFileName(
+  const std::string& fileName)
+{
+  // the extension is kept, it decides which file writer is used, and a
+  // MetaImage header names its data file, so .mhd files are written in place
+  std::string extension = Birch::Utilities::getFileExtension(fileName);
+  if (".mhd" == Birch::Utilities::toLower(extension))
+  {
+    return fileName;
+  }
+  return fileName.substr(0, fileName.size() - extension.size()) +
+    ".partial" + extension;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool QBirchImageSaverPrivate::replaceFile(
+  const std::string& from, const std::string& to)
+{
+  if (from == to || 0 == std::rename(from.c_str(), to.c_str()))
+  {
+    return true;
+  }
+
+  // rename does not replace an existing file everywhere
+  QFile::remove(QString::fromStdString(to));
+  return QFile::rename(
+    QString::fromStdString(from), QString::fromStdString(to));
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// QBirchImageSaver methods
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageSaver::QBirchImageSaver(QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new QBirchImageSaverPrivate(*this))
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageSaver::~QBirchImageSaver()
+{
+  this->abort();
+  this->wait();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setFileName(const QString& fileName)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->fileName = fileName;
+  QMutexLocker locker(&d->mutex);
+  d->aborted = false;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QString QBirchImageSaver::fileName() const
+{
+  Q_D(const QBirchImageSaver);
+  return d->fileName;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setImageData(vtkImageData* image)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->ImageData = 0;
+  if (image)
+  {
+    // the scalars are shared, not copied, the saver only reads them
+    d->ImageData = vtkSmartPointer<vtkImageData>::New();
+    d->ImageData->ShallowCopy(image);
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setMode(Mode mode)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->mode = mode;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QBirchImageSaver::Mode QBirchImageSaver::mode() const
+{
+  Q_D(const QBirchImageSaver);
+  return d->mode;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setOrientation(int orientation)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->orientation = orientation;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setSlice(int slice)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->slice = slice;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::setCompression(int compressor, int level)
+{
+  Q_D(QBirchImageSaver);
+  if (this->isRunning()) return;
+  d->compressor = compressor;
+  d->compressionLevel = level;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int QBirchImageSaver::slicesWritten() const
+{
+  Q_D(const QBirchImageSaver);
+  return d->slicesWritten;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+QString QBirchImageSaver::errorMessage() const
+{
+  Q_D(const QBirchImageSaver);
+  return d->errorMessage;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool QBirchImageSaver::isAborted() const
+{
+  Q_D(const QBirchImageSaver);
+  QMutexLocker locker(&d->mutex);
+  return d->aborted;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::abort()
+{
+  Q_D(QBirchImageSaver);
+  QMutexLocker locker(&d->mutex);
+  if (!this->isRunning()) return;
+  d->aborted = true;
+  if (d->Writer)
+  {
+    d->abortWriter();
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchImageSaver::run()
+{
+  Q_D(QBirchImageSaver);
+  d->errorMessage.clear();
+  d->slicesWritten = 0;
+
+  bool success = false;
+  std::string fileName = d->fileName.toStdString();
+  std::string partialFileName =
+    QBirchImageSaverPrivate::partialFileName(fileName);
+  std::vector<std::string> partialFileNames;
+  std::vector<std::string> fileNames;
+  vtkNew<vtkImageDataWriter> writer;
+  vtkNew<QBirchImageSaverCallback> callback;
+  callback->pimpl = d;
+  try
+  {
+    if (!d->ImageData ||
+        !vtkImageDataWriter::IsValidFileName(fileName.c_str()))
+    {
+      std::stringstream stream;
+      stream << "Unable to save image file \"" << fileName << "\"";
+      throw std::runtime_error(stream.str());
+    }
+
+    // the file is written under another name in the same directory and
+    // only replaces the one asked for once it is complete
+    writer->SetFileName(partialFileName.c_str());
+    writer->SetInputData(d->ImageData);
+    if (QBirchImageSaver::AllSlices == d->mode)
+    {
+      int* extent = d->ImageData->GetExtent();
+      int numberOfSlices =
+        extent[2 * d->orientation + 1] - extent[2 * d->orientation] + 1;
+      vtkNew<vtkImageDataWriter> names;
+      names->SetFileName(fileName.c_str());
+      for (int i = 0; i < numberOfSlices; ++i)
+      {
+        partialFileNames.push_back(
+          writer->GetSliceFileName(i, numberOfSlices));
+        fileNames.push_back(names->GetSliceFileName(i, numberOfSlices));
+      }
+    }
+    else
+    {
+      partialFileNames.push_back(partialFileName);
+      fileNames.push_back(fileName);
+    }
+
+    writer->SetCompressor(d->compressor);
+    writer->SetCompressionLevel(d->compressionLevel);
+
+    // slices and compressed files report progress through the writer,
+    // other files through the file writer it wraps
+    vtkObject* observed[2] = { writer.GetPointer(), writer->GetWriter() };
+    for (int i = 0; i < 2; ++i)
+    {
+      observed[i]->AddObserver(vtkCommand::StartEvent, callback.GetPointer());
+      observed[i]->AddObserver(
+        vtkCommand::ProgressEvent, callback.GetPointer());
+      observed[i]->AddObserver(vtkCommand::EndEvent, callback.GetPointer());
+    }
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Writer = writer.GetPointer();
+    }
+
+    // an abort which came before the writer was set is not lost
+    if (!this->isAborted())
+    {
+      switch (d->mode)
+      {
+        case QBirchImageSaver::WholeImage:
+          writer->Write();
+          break;
+        case QBirchImageSaver::CurrentSlice:
+          writer->WriteSlice(d->orientation, d->slice);
+          break;
+        case QBirchImageSaver::AllSlices:
+          d->slicesWritten = writer->WriteSlices(d->orientation);
+          break;
+      }
+    }
+
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Writer = 0;
+    }
+    success = !this->isAborted();
+
+    for (size_t i = 0; success && i < partialFileNames.size(); ++i)
+    {
+      if (Birch::Utilities::fileExists(partialFileNames[i]) &&
+          !QBirchImageSaverPrivate::replaceFile(
+            partialFileNames[i], fileNames[i]))
+      {
+        std::stringstream stream;
+        stream << "Unable to replace image file \"" << fileNames[i] << "\"";
+        throw std::runtime_error(stream.str());
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    {
+      QMutexLocker locker(&d->mutex);
+      d->Writer = 0;
+    }
+    d->errorMessage = e.what();
+  }
+
+  // an aborted or failed save leaves no partial files behind, though a
+  // .mhd file written in place has already overwritten the one asked for
+  if (!success || !d->errorMessage.isEmpty())
+  {
+    success = false;
+    for (size_t i = 0; i < partialFileNames.size(); ++i)
+    {
+      if (partialFileNames[i] != fileNames[i])
+      {
+        std::remove(partialFileNames[i].c_str());
+      }
+    }
+  }
+
+  emit this->saveFinished(success);
+}
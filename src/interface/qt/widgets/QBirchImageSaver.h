@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   QBirchImageSaver.h
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#ifndef __QBirchImageSaver_h
+#define __QBirchImageSaver_h
+
+// Qt includes
+#include <QThread>
+
+class QBirchImageSaverPrivate;
+class vtkImageData;
+
+/**
+ * @class QBirchImageSaver
+ *
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief Save an image file on a worker thread.
+ *
+ * The image is written by a vtkImageDataWriter in the thread's run method.
+ * The saver keeps a snapshot of the image it is given, which shares the
+ * image's scalars but not its pipeline, so the image on display can be
+ * replaced while the file is written.  The writer's start, progress and
+ * end events are re-emitted as signals, which Qt queues across to the
+ * receiver's thread, and the save can be cancelled with abort.
+ *
+ * Files are written under a temporary name (image.partial.png) in the same
+ * directory and renamed over the requested ones only when the save
+ * succeeds, so an aborted or failed save leaves any existing file intact.
+ * MetaImage .mhd headers name their data file and are written in place.
+ */
+class QBirchImageSaver : public QThread
+{
+  Q_OBJECT
+
+  public:
+    typedef QThread Superclass;
+    explicit QBirchImageSaver(QObject* parent = 0);
+    virtual ~QBirchImageSaver();
+
+    enum Mode { WholeImage, CurrentSlice, AllSlices };
+
+    void setFileName(const QString& fileName);
+    QString fileName() const;
+
+    /**
+     * Set the image to save, a snapshot of which is taken.
+     */
+    void setImageData(vtkImageData* image);
+
+    /**
+     * Save the whole image, the slice given by setSlice, or every slice
+     * along the orientation to numbered files.  The default is WholeImage.
+     */
+    void setMode(Mode mode);
+    Mode mode() const;
+
+    /**
+     * Set the orientation (0 = YZ, 1 = XZ, 2 = XY) and the slice, as an
+     * index into the image's extent, used by the slice modes.
+     */
+    void setOrientation(int orientation);
+    void setSlice(int slice);
+
+    /**
+     * Set the compressor and level of .vti and MetaImage files, see
+     * vtkImageDataWriter::SetCompressor.  The default leaves the file
+     * writers' own settings.
+     */
+    void setCompression(int compressor, int level);
+
+    /**
+     * The number of slices written by the AllSlices mode.
+     */
+    int slicesWritten() const;
+
+    QString errorMessage() const;
+    bool isAborted() const;
+
+  public slots:
+    void abort();
+
+  Q_SIGNALS:
+    void saveStarted(const QString& message);
+    void saveProgress(double value);
+    void saveFinished(bool success);
+
+  protected:
+    QScopedPointer<QBirchImageSaverPrivate> d_ptr;
+
+    virtual void run();
+
+  private:
+    Q_DECLARE_PRIVATE(QBirchImageSaver);
+    Q_DISABLE_COPY(QBirchImageSaver);
+};
+
+#endif
@@ -124,10 +124,11 @@ void QBirchImageWidget::save(const QString& fileName)
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchImageWidget::setImageData(vtkImageData* data)
+void QBirchImageWidget::setImageData(
+  vtkImageData* data, vtkMedicalImageProperties* properties)
 {
   Q_D(QBirchImageWidget);
-  d->sliceView->setImageData(data);
+  d->sliceView->setImageData(data, properties);
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
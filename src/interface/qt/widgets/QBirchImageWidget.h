@@ -17,6 +17,7 @@ class QBirchImageWidgetPrivate;
 class QBirchSliceView;
 class vtkEventForwarderCommand;
 class vtkImageData;
+class vtkMedicalImageProperties;
 
 class QBirchImageWidget : public QWidget
 {
@@ -34,7 +35,8 @@ class QBirchImageWidget : public QWidget
     void save(const QString& fileName);
     QBirchSliceView* sliceView();
     vtkImageData* imageData();
-    void setImageData(vtkImageData* data);
+    void setImageData(vtkImageData* data,
+      vtkMedicalImageProperties* properties = 0);
 
   protected:
     QScopedPointer<QBirchImageWidgetPrivate> d_ptr;
@@ -10,7 +10,9 @@
 #include <QBirchSliceView_p.h>
 
 // Alder includes
+#include <vtkCineWriter.h>
 #include <vtkImageDataReader.h>
+#include <vtkImageDataStatistics.h>
 #include <vtkImageDataWriter.h>
 
 // Qt includes
@@ -21,20 +23,20 @@
 #include <vtkCommand.h>
 #include <vtkDataArray.h>
 #include <vtkEventForwarderCommand.h>
-#include <vtkImageChangeInformation.h>
-#include <vtkImageClip.h>
 #include <vtkImageData.h>
-#include <vtkImagePermute.h>
 #include <vtkImageProperty.h>
 #include <vtkImageSinusoidSource.h>
 #include <vtkMedicalImageProperties.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkTextProperty.h>
 
 // C++ includes
+#include <algorithm>
 #include <map>
+#include <stdexcept>
 #include <string>
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -62,6 +64,7 @@ class QBirchWindowLevelCallback : public vtkCommand
           this->pimpl->doWindowLevelEvent();
           break;
         case vtkCommand::EndWindowLevelEvent:
+          this->pimpl->doEndWindowLevelEvent();
           break;
       }
     }
@@ -148,6 +151,9 @@ QBirchSliceViewPrivate::QBirchSliceViewPrivate(QBirchSliceView& object)
   this->ImageSliceMapper->SliceAtFocalPointOff();
   this->ImageSliceMapper->BorderOff();
   this->ImageSliceMapper->CroppingOff();
+  // ask the window level filter, and so the reader, for the displayed
+  // slice alone rather than the whole volume
+  this->ImageSliceMapper->StreamingOn();
 
   this->ImageSlice = vtkSmartPointer<vtkImageSlice>::New();
   vtkImageProperty* property = this->ImageSlice->GetProperty();
@@ -172,8 +178,18 @@ QBirchSliceViewPrivate::QBirchSliceViewPrivate(QBirchSliceView& object)
   this->orientation = QBirchSliceView::OrientationXY;
   this->dimensionality = 0;
   this->frameRate = 25;
+  this->loadedSlices = -1;
   this->annotateOverView = true;
   this->cursorOverView = true;
+  this->autoWindowLevel = true;
+  this->autoWindowLevelPercentiles[0] = 1.0;
+  this->autoWindowLevelPercentiles[1] = 99.0;
+  this->interactiveSliceSize = 1024*1024;
+  this->interactiveShrinkFactor = 1;
+  this->refineTimer.setSingleShot(true);
+  this->refineTimer.setInterval(200);
+  QObject::connect(&this->refineTimer, SIGNAL(timeout()),
+    this, SLOT(refineWindowLevel()));
 
   this->InteractorStyle =
     vtkSmartPointer<vtkCustomInteractorStyleImage>::New();
@@ -204,7 +220,9 @@ int* QBirchSliceViewPrivate::sliceRange()
     vtkImageData::SafeDownCast(this->WindowLevel->GetInput());
   if (input)
   {
-    this->WindowLevel->Update();
+    // updating the filter itself would window / level the whole volume, the
+    // slice mapper asks it for the displayed slice only
+    this->WindowLevel->UpdateInformation();
     return input->GetExtent() + 2*this->orientation;
   }
   return 0;
@@ -232,9 +250,48 @@ int QBirchSliceViewPrivate::sliceMax()
   return 0;
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int QBirchSliceViewPrivate::loadedSliceMax()
+{
+  int max = this->sliceMax();
+  if (0 <= this->loadedSlices &&
+      QBirchSliceView::OrientationXY == this->orientation)
+  {
+    max = qMin(max, this->sliceMin() + this->loadedSlices - 1);
+  }
+  return max;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceViewPrivate::cropToLoadedSlices()
+{
+  // the loader is still writing the xy slices past those read, which the
+  // image shares, so they are cropped from the views across them and are
+  // never windowed, rendered or probed
+  vtkImageData* input =
+    vtkImageData::SafeDownCast(this->WindowLevel->GetInput());
+  int* extent = input ? input->GetExtent() : 0;
+  if (!extent || 0 > this->loadedSlices ||
+      this->loadedSlices > extent[5] - extent[4])
+  {
+    this->ImageSliceMapper->CroppingOff();
+    this->CornerAnnotation->SetText(1, "");
+    return;
+  }
+
+  int region[6];
+  std::copy(extent, extent + 6, region);
+  region[5] = region[4] + qMax(0, this->loadedSlices - 1);
+  this->ImageSliceMapper->SetCroppingRegion(region);
+  this->ImageSliceMapper->CroppingOn();
+  this->CornerAnnotation->SetText(1,
+    QBirchSliceView::OrientationXY == this->orientation ? "" : "loading...");
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchSliceViewPrivate::setSlice(const int& _slice)
 {
+  // the xy slices that have not been read yet cannot be chosen
   int* range = this->sliceRange();
   int slice = _slice;
   if (range)
@@ -243,9 +300,9 @@ void QBirchSliceViewPrivate::setSlice(const int& _slice)
     {
       slice = range[0];
     }
-    else if (slice > range[1])
+    else if (slice > this->loadedSliceMax())
     {
-      slice = range[1];
+      slice = this->loadedSliceMax();
     }
   }
 
@@ -253,6 +310,7 @@ void QBirchSliceViewPrivate::setSlice(const int& _slice)
   this->lastSlice[this->orientation] = this->slice;
   this->slice = slice;
 
+  this->cropToLoadedSlices();
   this->ImageSliceMapper->SetSliceNumber(this->slice);
   this->ImageSliceMapper->Update();
 
@@ -271,11 +329,13 @@ void QBirchSliceViewPrivate::setSlice(const int& _slice)
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchSliceViewPrivate::setImageData(vtkImageData* input)
+void QBirchSliceViewPrivate::setImageData(
+  vtkImageData* input, const int& loaded)
 {
   this->setupRendering(false);
   this->dimensionality = 0;
   this->frameRate = 25;
+  this->loadedSlices = loaded;
   if (input)
   {
     int dims[3];
@@ -321,6 +381,7 @@ void QBirchSliceViewPrivate::setImageData(vtkImageData* input)
     this->WindowLevel->SetInputData(input);
     this->ImageSliceMapper->SetInputConnection(
       this->WindowLevel->GetOutputPort());
+    this->cropToLoadedSlices();
     int components = input->GetNumberOfScalarComponents();
     switch (components)
     {
@@ -468,6 +529,35 @@ void QBirchSliceViewPrivate::doStartWindowLevelEvent()
 {
   this->initialColorWindow = this->WindowLevel->GetWindow();
   this->initialColorLevel = this->WindowLevel->GetLevel();
+
+  this->WindowLevel->SetSliceOrientation(this->orientation);
+  this->interactiveShrinkFactor =
+    this->WindowLevel->ComputeShrinkFactor(this->interactiveSliceSize);
+
+  // the cropping to the slices read is in input slices, which a view
+  // across them would shrink
+  if (0 <= this->loadedSlices &&
+      QBirchSliceView::OrientationXY != this->orientation)
+  {
+    this->interactiveShrinkFactor = 1;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceViewPrivate::doEndWindowLevelEvent()
+{
+  this->refineTimer.stop();
+  this->refineWindowLevel();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceViewPrivate::refineWindowLevel()
+{
+  if (1 < this->WindowLevel->GetShrinkFactor())
+  {
+    this->WindowLevel->SetShrinkFactor(1);
+    this->RenderWindow->Render();
+  }
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -543,6 +633,12 @@ void QBirchSliceViewPrivate::doWindowLevelEvent()
   }
 
   this->setColorWindowLevel(newWindow, newLevel);
+
+  if (1 < this->interactiveShrinkFactor)
+  {
+    this->WindowLevel->SetShrinkFactor(this->interactiveShrinkFactor);
+    this->refineTimer.start();
+  }
   this->RenderWindow->Render();
 }
 
@@ -553,7 +649,7 @@ void QBirchSliceViewPrivate::initializeCameraViews()
     vtkImageData::SafeDownCast(this->WindowLevel->GetInput());
   if (!input)
     return;
-  this->WindowLevel->Update();
+  this->WindowLevel->UpdateInformation();
   double* origin = input->GetOrigin();
   double* spacing = input->GetSpacing();
   int* extent = input->GetExtent();
@@ -635,31 +731,45 @@ void QBirchSliceViewPrivate::initializeWindowLevel()
   vtkImageData* input =
     vtkImageData::SafeDownCast(this->WindowLevel->GetInput());
   if (!input) return;
-  this->WindowLevel->Update();
+  this->WindowLevel->UpdateInformation();
 
-  int components = input->GetNumberOfScalarComponents();
-  double dataMin = input->GetScalarTypeMax();
-  double dataMax = input->GetScalarTypeMin();
-  if (1 == components)
+  // while the image is loading only the xy slices read so far are counted,
+  // the rest are still being written
+  vtkSmartPointer<vtkImageData> image = input;
+  vtkDataArray* scalars = input->GetPointData()->GetScalars();
+  int* extent = input->GetExtent();
+  if (scalars && 0 < this->loadedSlices &&
+      this->loadedSlices < extent[5] - extent[4] + 1)
   {
-    dataMin = input->GetScalarRange()[0];
-    dataMax = input->GetScalarRange()[1];
+    image = vtkSmartPointer<vtkImageData>::New();
+    image->SetExtent(extent[0], extent[1], extent[2], extent[3],
+      extent[4], extent[4] + this->loadedSlices - 1);
+    vtkSmartPointer<vtkDataArray> loaded;
+    loaded.TakeReference(
+      vtkDataArray::CreateDataArray(scalars->GetDataType()));
+    loaded->SetNumberOfComponents(scalars->GetNumberOfComponents());
+    loaded->SetVoidArray(scalars->GetVoidPointer(0),
+      image->GetNumberOfPoints() * scalars->GetNumberOfComponents(), 1);
+    image->GetPointData()->SetScalars(loaded);
   }
-  else
+
+  // the range of all of the components, shared with the image's other
+  // consumers once it is loaded
+  double range[2] = { input->GetScalarTypeMin(), input->GetScalarTypeMax() };
+  vtkImageDataStatistics* statistics =
+    vtkImageDataStatistics::GetStatistics(image);
+  if (statistics && 0 < statistics->GetNumberOfComponents())
   {
-    vtkDataArray* data = 0;
-    if (input->GetPointData() &&
-        0 != (data = input->GetPointData()->GetScalars()))
-    {
-      for (int i = 0; i < components; ++i)
-      {
-        double min = data->GetRange(i)[0];
-        double max = data->GetRange(i)[1];
-        if (dataMin > min) dataMin = min;
-        if (dataMax < max) dataMax = max;
-      }
-    }
+    statistics->GetRange(range);
   }
+  if (this->autoWindowLevel && statistics &&
+      1 == statistics->GetNumberOfComponents())
+  {
+    statistics->GetPercentileRange(this->autoWindowLevelPercentiles[0],
+      this->autoWindowLevelPercentiles[1], range);
+  }
+  double dataMin = range[0];
+  double dataMax = range[1];
 
   this->originalColorWindow = dataMax - dataMin;
   this->originalColorLevel =  0.5*(dataMin + dataMax);
@@ -809,8 +919,10 @@ void QBirchSliceViewPrivate::setOrientation(
   this->recordCameraView();
   this->lastSlice[this->orientation] = this->slice;
   this->orientation = _orientation;
-  this->slice = this->lastSlice[this->orientation];
+  this->slice = qMin(
+    this->lastSlice[this->orientation], this->loadedSliceMax());
 
+  this->cropToLoadedSlices();
   this->ImageSliceMapper->SetOrientation(this->orientation);
   this->ImageSliceMapper->SetSliceNumber(this->slice);
   this->ImageSliceMapper->Update();
@@ -1088,6 +1200,42 @@ int QBirchSliceView::sliceMax()
   return d->sliceMax();
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int QBirchSliceView::loadedSliceMax()
+{
+  Q_D(QBirchSliceView);
+  return d->loadedSliceMax();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceView::setLoadedSlices(int count)
+{
+  Q_D(QBirchSliceView);
+  vtkImageData* image = this->imageData();
+  if (!image) return;
+
+  // the loader has written more of the image's scalars, so let the
+  // pipeline (and the cached scalar range) know they have changed
+  d->loadedSlices = count;
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (scalars)
+    scalars->Modified();
+  image->Modified();
+  d->setSlice(d->slice);
+
+  emit loadedSlicesChanged(count);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceView::setPartialImageData(vtkImageData* data, int count)
+{
+  Q_D(QBirchSliceView);
+  d->setImageData(data, data ? count : -1);
+  emit imageDataChanged();
+  if (data)
+    emit loadedSlicesChanged(count);
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void QBirchSliceView::setInterpolation(int newInterpolation)
 {
@@ -1102,6 +1250,53 @@ int QBirchSliceView::interpolation() const
   return d->interpolation;
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceView::setAutoWindowLevel(bool autoWindowLevel)
+{
+  Q_D(QBirchSliceView);
+  if (autoWindowLevel == d->autoWindowLevel) return;
+  d->autoWindowLevel = autoWindowLevel;
+  if (!this->hasImageData()) return;
+
+  d->initializeWindowLevel();
+  d->RenderWindow->Render();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void QBirchSliceView::setAutoWindowLevelPercentiles(double lower, double upper)
+{
+  Q_D(QBirchSliceView);
+  if (lower == d->autoWindowLevelPercentiles[0] &&
+      upper == d->autoWindowLevelPercentiles[1]) return;
+  d->autoWindowLevelPercentiles[0] = lower;
+  d->autoWindowLevelPercentiles[1] = upper;
+  if (!this->hasImageData() || !d->autoWindowLevel) return;
+
+  d->initializeWindowLevel();
+  d->RenderWindow->Render();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double QBirchSliceView::autoWindowLevelLowerPercentile() const
+{
+  Q_D(const QBirchSliceView);
+  return d->autoWindowLevelPercentiles[0];
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double QBirchSliceView::autoWindowLevelUpperPercentile() const
+{
+  Q_D(const QBirchSliceView);
+  return d->autoWindowLevelPercentiles[1];
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool QBirchSliceView::autoWindowLevel() const
+{
+  Q_D(const QBirchSliceView);
+  return d->autoWindowLevel;
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 int QBirchSliceView::dimensionality() const
 {
@@ -1161,73 +1356,110 @@ void QBirchSliceView::writeSlice(const QString& fileName)
   {
     vtkNew<vtkImageDataWriter> writer;
     writer->SetFileName(fileName.toStdString().c_str());
+    writer->SetInputData(input);
     if(3 == d->dimensionality)
     {
-      vtkNew<vtkImageClip> clip;
-
-      int extent[6];
-      int u, v, w = d->orientation;
-      switch (w)
-      {
-        case 0: u = 1; v = 2; break;
-        case 1: u = 0; v = 2; break;
-        case 2: u = 0; v = 1; break;
-      }
-      int* w_ext = input->GetExtent();
-      extent[2*u] = w_ext[2*u];
-      extent[2*u+1] = w_ext[2*u+1];
-      extent[2*v] = w_ext[2*v];
-      extent[2*v+1] = w_ext[2*v+1];
-      extent[2*w] = d->slice;
-      extent[2*w+1] = d->slice;
-
-      clip->SetOutputWholeExtent(extent);
-      clip->ClipDataOn();
-      clip->SetInputData(input);
-      clip->Update();
-
-      int ec[6];
-      clip->GetOutput()->GetExtent(ec);
-
-      int et[] = {0, 0, 0};  // extent translation
-      int op[] = {0, 1, 2};  // output axes permutation
-
-      // translate to an x-y plane:
-      // 1) change extents via vtkImageChangeInformation
-      // 2) permute the axes
-      switch (w)
-      {
-        case 0: et[0] = -ec[0];
-                op[0] = 2; op[1] = 0; op[2] = 1;
-                break;  // YZ
-        case 1: et[1] = -ec[2];
-                op[0] = 0; op[1] = 2; op[2] = 1;
-                break;  // XZ
-        case 2: et[2] = -ec[4];
-                break;  // XY
-      }
-
-      vtkNew<vtkImageChangeInformation> change;
-      change->SetExtentTranslation(et);
-      change->SetInputConnection(clip->GetOutputPort());
-      change->Update();
-
-      vtkNew<vtkImagePermute> permute;
-      permute->SetFilteredAxes(op);
-      permute->SetInputConnection(change->GetOutputPort());
-      permute->Update();
-
-      writer->SetInputData(permute->GetOutput());
-      writer->Write();
+      writer->WriteSlice(d->orientation, d->slice);
     }
     else
     {
-      writer->SetInputData(input);
       writer->Write();
     }
   }
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int QBirchSliceView::writeCine(vtkCineWriter* writer, bool annotate)
+{
+  Q_D(QBirchSliceView);
+  if (!writer || !this->hasImageData()) return 0;
+
+  // the frames are rendered offscreen by a pipeline of their own, set up
+  // as the view is now, so that neither the view's slice, camera and
+  // window level nor anything shown on screen while events are processed
+  // between frames changes them
+  vtkNew<vtkImageData> image;
+  image->ShallowCopy(this->imageData());
+  vtkImageWindowLevel* viewWindowLevel = d->WindowLevel;
+  vtkNew<vtkImageWindowLevel> windowLevel;
+  windowLevel->SetInputData(image.GetPointer());
+  windowLevel->SetWindow(viewWindowLevel->GetWindow());
+  windowLevel->SetLevel(viewWindowLevel->GetLevel());
+  windowLevel->SetLookupTable(viewWindowLevel->GetLookupTable());
+  windowLevel->SetActiveComponent(viewWindowLevel->GetActiveComponent());
+  windowLevel->SetPassAlphaToOutput(viewWindowLevel->GetPassAlphaToOutput());
+  windowLevel->SetOutputFormat(viewWindowLevel->GetOutputFormat());
+  windowLevel->SetSliceOrientation(d->orientation);
+
+  vtkNew<vtkImageSliceMapper> mapper;
+  mapper->SetInputConnection(windowLevel->GetOutputPort());
+  mapper->SetOrientation(d->orientation);
+  mapper->SliceFacesCameraOff();
+  mapper->SliceAtFocalPointOff();
+  mapper->BorderOff();
+  mapper->CroppingOff();
+  mapper->StreamingOn();
+
+  vtkNew<vtkImageSlice> imageSlice;
+  imageSlice->SetMapper(mapper.GetPointer());
+  imageSlice->GetProperty()->DeepCopy(d->ImageSlice->GetProperty());
+
+  vtkNew<vtkCamera> camera;
+  camera->DeepCopy(d->Renderer->GetActiveCamera());
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(d->Renderer->GetBackground());
+  renderer->SetActiveCamera(camera.GetPointer());
+  renderer->AddViewProp(imageSlice.GetPointer());
+
+  vtkNew<vtkCustomCornerAnnotation> annotation;
+  if (annotate && d->CornerAnnotation->GetVisibility())
+  {
+    vtkCustomCornerAnnotation* viewAnnotation = d->CornerAnnotation;
+    annotation->SetMaximumFontSize(viewAnnotation->GetMaximumFontSize());
+    annotation->SetLinearFontScaleFactor(
+      viewAnnotation->GetLinearFontScaleFactor());
+    annotation->SetMaximumLineHeight(viewAnnotation->GetMaximumLineHeight());
+    annotation->GetTextProperty()->ShallowCopy(
+      viewAnnotation->GetTextProperty());
+    annotation->SetText(2, viewAnnotation->GetText(2));
+    annotation->SetText(3, viewAnnotation->GetText(3));
+    annotation->SetImageSlice(imageSlice.GetPointer());
+    annotation->SetWindowLevel(windowLevel.GetPointer());
+    renderer->AddViewProp(annotation.GetPointer());
+  }
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->OffScreenRenderingOn();
+  renderWindow->SetSize(d->RenderWindow->GetSize());
+  renderWindow->AddRenderer(renderer.GetPointer());
+
+  int frames = 0;
+  std::string errorMessage;
+  try
+  {
+    writer->SetRenderWindow(renderWindow.GetPointer());
+    writer->Start(d->sliceMax() - d->sliceMin() + 1);
+    for (int i = d->sliceMin();
+         i <= d->sliceMax() && !writer->GetAbortExecute(); ++i)
+    {
+      mapper->SetSliceNumber(i);
+      renderer->ResetCameraClippingRange();
+      renderWindow->Render();
+      writer->WriteFrame();
+    }
+    frames = writer->End();
+  }
+  catch (std::exception& e)
+  {
+    errorMessage = e.what();
+  }
+
+  writer->SetRenderWindow(NULL);
+  if (!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+  return frames;
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 bool QBirchSliceView::load(
   const QString& fileName, vtkEventForwarderCommand* forward)
@@ -1240,29 +1472,16 @@ bool QBirchSliceView::load(
     reader->SetFileName(fileName.toStdString().c_str());
     if (forward)
     {
-      reader->GetReader()->AddObserver(
-        vtkCommand::StartEvent, forward);
-      reader->GetReader()->AddObserver(
-        vtkCommand::ProgressEvent, forward);
-      reader->GetReader()->AddObserver(
-        vtkCommand::EndEvent, forward);
+      reader->AddObserver(vtkCommand::StartEvent, forward);
+      reader->AddObserver(vtkCommand::ProgressEvent, forward);
+      reader->AddObserver(vtkCommand::EndEvent, forward);
     }
+
+    // an unchanged file read before comes from the reader's image cache
     vtkImageData* image = reader->GetOutput();
     if (image)
     {
-      d->setImageData(image);
-      if (3 == d->dimensionality)
-      {
-        vtkMedicalImageProperties* properties =
-          reader->GetMedicalImageProperties();
-        if (properties && NULL != properties->GetUserDefinedValue("CineRate"))
-        {
-          std::string s = properties->GetUserDefinedValue("CineRate");
-          int rate = vtkVariant(s.c_str()).ToInt();
-          d->frameRate = rate;
-        }
-      }
-      emit imageDataChanged();
+      this->setImageData(image, reader->GetMedicalImageProperties());
       success = true;
     }
   }
@@ -1278,10 +1497,18 @@ vtkImageData* QBirchSliceView::imageData()
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void QBirchSliceView::setImageData(vtkImageData* data)
+void QBirchSliceView::setImageData(
+  vtkImageData* data, vtkMedicalImageProperties* properties)
 {
   Q_D(QBirchSliceView);
   d->setImageData(data);
+  if (3 == d->dimensionality && properties &&
+      NULL != properties->GetUserDefinedValue("CineRate"))
+  {
+    std::string s = properties->GetUserDefinedValue("CineRate");
+    int rate = vtkVariant(s.c_str()).ToInt();
+    d->frameRate = rate;
+  }
   emit imageDataChanged();
 }
 
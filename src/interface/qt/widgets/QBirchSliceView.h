@@ -13,8 +13,10 @@
 #include <QBirchAbstractView.h>
 
 class QBirchSliceViewPrivate;
+class vtkCineWriter;
 class vtkEventForwarderCommand;
 class vtkImageData;
+class vtkMedicalImageProperties;
 
 class QBirchSliceView : public QBirchAbstractView
 {
@@ -28,6 +30,8 @@ class QBirchSliceView : public QBirchAbstractView
   Q_PROPERTY(Orientation orientation READ orientation
     WRITE setOrientation NOTIFY orientationChanged)
   Q_PROPERTY(int interpolation READ interpolation WRITE setInterpolation)
+  Q_PROPERTY(bool autoWindowLevel READ autoWindowLevel
+    WRITE setAutoWindowLevel)
   Q_PROPERTY(QColor annotationColor READ annotationColor
     WRITE setAnnotationColor)
   Q_ENUMS(Orientation)
@@ -46,6 +50,16 @@ class QBirchSliceView : public QBirchAbstractView
     int sliceMin();
     int sliceMax();
     int interpolation() const;
+
+    /**
+     * Whether a single component image is windowed from the lower to the
+     * upper percentile of its values, rather than across its whole range,
+     * when it is shown and when the window level is reset.  Default true,
+     * from the 1st to the 99th percentile, as vtkMedicalImageViewer.
+     */
+    bool autoWindowLevel() const;
+    double autoWindowLevelLowerPercentile() const;
+    double autoWindowLevelUpperPercentile() const;
     bool annotateOverView() const;
     bool cursorOverView() const;
     bool hasImageData() const;
@@ -53,11 +67,27 @@ class QBirchSliceView : public QBirchAbstractView
     void setImageToSinusoid();
     bool load(const QString& fileName, vtkEventForwarderCommand* forward = 0);
     void writeSlice(const QString& fileName);
+
+    /**
+     * Render every slice along the current orientation offscreen and write
+     * them as a cine loop with the writer, with or without the corner
+     * annotation.  The frames are rendered by a render window of their own
+     * as the view is when called, and the view itself is left untouched.
+     * Returns the number of frames written.
+     */
+    int writeCine(vtkCineWriter* writer, bool annotate = true);
     virtual QColor annotationColor() const;
     vtkImageData* imageData();
-    void setImageData(vtkImageData* data);
+    void setImageData(vtkImageData* data,
+      vtkMedicalImageProperties* properties = 0);
     int frameRate() const;
 
+    /**
+     * The last slice along the current orientation that has been read,
+     * which is less than sliceMax while the image is still being loaded.
+     */
+    int loadedSliceMax();
+
   public slots:
     void setColorLevel(double newColorLevel);
     void setColorWindow(double newColorWindow);
@@ -68,15 +98,36 @@ class QBirchSliceView : public QBirchAbstractView
     void setAnnotateOverView(bool view);
     void rotateCamera(double angle);
     void setInterpolation(int newInterpolation);
+    void setAutoWindowLevel(bool autoWindowLevel);
+    void setAutoWindowLevelPercentiles(double lower, double upper);
     void flipCameraHorizontal();
     void flipCameraVertical();
     void rotateCameraClockwise();
     void rotateCameraCounterClockwise();
     void setAnnotationColor(const QColor& qcolor);
 
+    /**
+     * Set the number of xy slices of the image data that have been read
+     * while it is being loaded, or -1 once the image is complete.  The
+     * view is refreshed.  The slices not yet read, which the loader may be
+     * writing, are never read by the view: they cannot be chosen as the xy
+     * slice and are cropped from the xz and yz slices.  setImageData
+     * resets this to -1.
+     */
+    void setLoadedSlices(int count);
+
+    /**
+     * Display an image which is still being loaded, of which the first
+     * count xy slices have been read.  As setImageData followed by
+     * setLoadedSlices, but the window level is found from the slices read
+     * rather than from the whole image.
+     */
+    void setPartialImageData(vtkImageData* data, int count);
+
   Q_SIGNALS:
     void orientationChanged(QBirchSliceView::Orientation orientation);
     void imageDataChanged();
+    void loadedSlicesChanged(int count);
 
   private:
     Q_DECLARE_PRIVATE(QBirchSliceView);
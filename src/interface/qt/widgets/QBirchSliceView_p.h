@@ -11,6 +11,7 @@
 
 // Qt includes
 #include <QObject>
+#include <QTimer>
 
 // Birch includes
 #include <QBirchSliceView.h>
@@ -43,15 +44,19 @@ class QBirchSliceViewPrivate : public QBirchAbstractViewPrivate
     void flipCameraHorizontal();
     void rotateCamera(const double& angle);
     void setSlice(const int& slice);
-    void setImageData(vtkImageData* image);
+    void setImageData(vtkImageData* image, const int& loaded = -1);
     void setOrientation(const QBirchSliceView::Orientation& orientation);
     void setInterpolation(const int& interp);
     int sliceMin();
     int sliceMax();
+    int loadedSliceMax();
+    void cropToLoadedSlices();
 
     void doResetWindowLevelEvent();
     void doStartWindowLevelEvent();
     void doWindowLevelEvent();
+    void doEndWindowLevelEvent();
+    void initializeWindowLevel();
 
     vtkSmartPointer<vtkCustomCornerAnnotation>     CornerAnnotation;
     vtkSmartPointer<vtkImageSlice>                 ImageSlice;
@@ -71,6 +76,13 @@ class QBirchSliceViewPrivate : public QBirchAbstractViewPrivate
     int dimensionality;
     int interpolation;
     int frameRate;
+    int loadedSlices;
+    bool autoWindowLevel;
+    double autoWindowLevelPercentiles[2];
+    int interactiveSliceSize;
+
+  public slots:
+    void refineWindowLevel();
 
   private:
     int lastSlice[3];
@@ -86,11 +98,15 @@ class QBirchSliceViewPrivate : public QBirchAbstractViewPrivate
     double initialColorWindow;
     double initialColorLevel;
 
+    // large slices are window levelled shrunk while the mouse is dragged
+    // and at full resolution once it is released or rests
+    int interactiveShrinkFactor;
+    QTimer refineTimer;
+
     int* sliceRange();
 
     void computeCameraFromCurrentSlice(const bool& useCamera = true);
     void updateCameraView();
-    void initializeWindowLevel();
     void initializeCameraViews();
     void recordCameraView(const int& specified = -1);
 
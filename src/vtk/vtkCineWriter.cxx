@@ -0,0 +1,491 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   vtkCineWriter.cxx
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#include <vtkCineWriter.h>
+
+// Birch includes
+#include <Utilities.h>
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkConditionVariable.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkMutexLock.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPNGWriter.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+#include <vtkWindowToImageFilter.h>
+#include <vtk_zlib.h>
+
+// C++ includes
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+vtkStandardNewMacro(vtkCineWriter);
+vtkCxxSetObjectMacro(vtkCineWriter, RenderWindow, vtkRenderWindow);
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// The encoder.  Frames are passed from the rendering thread to the encoder
+// thread through a short queue.  An animated PNG is one PNG holding every
+// frame: the first frame is the default image and each one is introduced
+// by a frame control chunk, see https://wiki.mozilla.org/APNG_Specification
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+class vtkCineWriterInternals
+{
+  public:
+    vtkCineWriter* Self;
+    std::string FileName;
+    int Format;
+    int FrameRate;
+    int NumberOfFrames;
+    int QueuedFrames;
+    int EncodedFrames;
+    bool Done;
+    bool Failed;
+    std::string ErrorMessage;
+
+    std::deque<vtkSmartPointer<vtkImageData> > Queue;
+    vtkSimpleMutexLock Lock;
+    vtkSimpleConditionVariable Condition;
+
+    vtkNew<vtkMultiThreader> Threader;
+    int ThreadId;
+    vtkNew<vtkWindowToImageFilter> Capture;
+
+    // the animated PNG being written
+    std::ofstream File;
+    unsigned int Sequence;
+    int Dimensions[2];
+    int Components;
+};
+
+namespace
+{
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkCineWriterPut32(std::vector<unsigned char>& data, unsigned int value)
+  {
+    data.push_back(static_cast<unsigned char>((value >> 24) & 0xff));
+    data.push_back(static_cast<unsigned char>((value >> 16) & 0xff));
+    data.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+    data.push_back(static_cast<unsigned char>(value & 0xff));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkCineWriterPut16(std::vector<unsigned char>& data,
+    unsigned short value)
+  {
+    data.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+    data.push_back(static_cast<unsigned char>(value & 0xff));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Write a PNG chunk: its length, type, data and CRC of type and data
+  void vtkCineWriterChunk(std::ofstream& file, const char* type,
+    const std::vector<unsigned char>& data)
+  {
+    std::vector<unsigned char> head;
+    vtkCineWriterPut32(head, static_cast<unsigned int>(data.size()));
+    head.insert(head.end(), type, type + 4);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, &head[4], 4);
+    if (!data.empty())
+    {
+      crc = crc32(crc, &data[0], static_cast<uInt>(data.size()));
+    }
+    std::vector<unsigned char> tail;
+    vtkCineWriterPut32(tail, static_cast<unsigned int>(crc));
+
+    file.write(reinterpret_cast<const char*>(&head[0]), head.size());
+    if (!data.empty())
+    {
+      file.write(reinterpret_cast<const char*>(&data[0]), data.size());
+    }
+    file.write(reinterpret_cast<const char*>(&tail[0]), tail.size());
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // The file name of a frame of a PNG sequence
+  std::string vtkCineWriterFrameFileName(const std::string& fileName,
+    int frame, int numberOfFrames)
+  {
+    int digits = 1;
+    for (int n = numberOfFrames - 1; 10 <= n; n /= 10)
+    {
+      digits++;
+    }
+
+    std::string extension = Birch::Utilities::getFileExtension(fileName);
+    std::stringstream stream;
+    stream << fileName.substr(0, fileName.size() - extension.size());
+    stream << "_" << std::setfill('0') << std::setw(std::max(3, digits));
+    stream << frame << extension;
+    return stream.str();
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Compress a frame as PNG image data, top row first, each row filtered
+  // by its difference from the row above
+  void vtkCineWriterCompressFrame(vtkImageData* frame,
+    std::vector<unsigned char>& data)
+  {
+    int* dimensions = frame->GetDimensions();
+    int rowSize = dimensions[0] * frame->GetNumberOfScalarComponents();
+    const unsigned char* pixels =
+      static_cast<const unsigned char*>(frame->GetScalarPointer());
+
+    std::vector<unsigned char> filtered;
+    filtered.reserve(static_cast<size_t>(rowSize + 1) * dimensions[1]);
+    for (int y = dimensions[1] - 1; y >= 0; --y)
+    {
+      const unsigned char* row = pixels + static_cast<size_t>(y) * rowSize;
+      const unsigned char* above =
+        y < dimensions[1] - 1 ? row + rowSize : NULL;
+      filtered.push_back(above ? 2 : 0);  // up or none
+      for (int i = 0; i < rowSize; ++i)
+      {
+        filtered.push_back(static_cast<unsigned char>(
+          above ? row[i] - above[i] : row[i]));
+      }
+    }
+
+    uLongf length = compressBound(static_cast<uLong>(filtered.size()));
+    data.resize(length);
+    if (Z_OK != compress2(&data[0], &length, &filtered[0],
+          static_cast<uLong>(filtered.size()), Z_DEFAULT_COMPRESSION))
+    {
+      throw std::runtime_error("Unable to compress a cine frame.");
+    }
+    data.resize(length);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Add a frame to the animated PNG, writing the file header first
+  void vtkCineWriterEncodeAnimated(vtkCineWriterInternals* internals,
+    vtkImageData* frame, int index)
+  {
+    int* dimensions = frame->GetDimensions();
+    int components = frame->GetNumberOfScalarComponents();
+    std::ofstream& file = internals->File;
+    std::vector<unsigned char> chunk;
+    if (0 == index)
+    {
+      internals->Dimensions[0] = dimensions[0];
+      internals->Dimensions[1] = dimensions[1];
+      internals->Components = components;
+
+      const unsigned char signature[8] =
+        { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+      file.write(reinterpret_cast<const char*>(signature), 8);
+
+      vtkCineWriterPut32(chunk, dimensions[0]);
+      vtkCineWriterPut32(chunk, dimensions[1]);
+      chunk.push_back(8);                          // bit depth
+      chunk.push_back(4 == components ? 6 : 2);    // RGBA or RGB
+      chunk.push_back(0);                          // deflate
+      chunk.push_back(0);                          // adaptive filtering
+      chunk.push_back(0);                          // no interlace
+      vtkCineWriterChunk(file, "IHDR", chunk);
+
+      chunk.clear();
+      vtkCineWriterPut32(chunk, internals->NumberOfFrames);
+      vtkCineWriterPut32(chunk, 0);                // loop forever
+      vtkCineWriterChunk(file, "acTL", chunk);
+    }
+    else if (dimensions[0] != internals->Dimensions[0] ||
+             dimensions[1] != internals->Dimensions[1] ||
+             components != internals->Components)
+    {
+      throw std::runtime_error(
+        "The render window changed size while writing a cine loop.");
+    }
+
+    chunk.clear();
+    vtkCineWriterPut32(chunk, internals->Sequence++);
+    vtkCineWriterPut32(chunk, dimensions[0]);
+    vtkCineWriterPut32(chunk, dimensions[1]);
+    vtkCineWriterPut32(chunk, 0);                  // x offset
+    vtkCineWriterPut32(chunk, 0);                  // y offset
+    vtkCineWriterPut16(chunk, 1);                  // delay of 1 / rate
+    vtkCineWriterPut16(chunk,
+      static_cast<unsigned short>(internals->FrameRate));
+    chunk.push_back(0);                            // no disposal
+    chunk.push_back(0);                            // replace, no blending
+    vtkCineWriterChunk(file, "fcTL", chunk);
+
+    std::vector<unsigned char> data;
+    vtkCineWriterCompressFrame(frame, data);
+    if (0 == index)
+    {
+      vtkCineWriterChunk(file, "IDAT", data);
+    }
+    else
+    {
+      chunk.clear();
+      vtkCineWriterPut32(chunk, internals->Sequence++);
+      chunk.insert(chunk.end(), data.begin(), data.end());
+      vtkCineWriterChunk(file, "fdAT", chunk);
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkCineWriterEncodeThread(void* arg)
+  {
+    vtkCineWriterInternals* internals = static_cast<vtkCineWriterInternals*>(
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+
+    while (true)
+    {
+      internals->Lock.Lock();
+      while (internals->Queue.empty() && !internals->Done)
+      {
+        internals->Condition.Wait(internals->Lock);
+      }
+      if (internals->Queue.empty())
+      {
+        internals->Lock.Unlock();
+        break;
+      }
+      vtkSmartPointer<vtkImageData> frame = internals->Queue.front();
+      internals->Queue.pop_front();
+      int index = internals->EncodedFrames;
+      internals->Lock.Unlock();
+
+      std::string errorMessage;
+      try
+      {
+        if (vtkCineWriter::ANIMATED_PNG == internals->Format)
+        {
+          vtkCineWriterEncodeAnimated(internals, frame, index);
+        }
+        else
+        {
+          vtkNew<vtkPNGWriter> writer;
+          writer->SetFileName(vtkCineWriterFrameFileName(
+            internals->FileName, index, internals->NumberOfFrames).c_str());
+          writer->SetInputData(frame);
+          writer->Write();
+        }
+      }
+      catch (std::exception& e)
+      {
+        errorMessage = e.what();
+      }
+
+      // the rendering thread may be waiting for room in the queue
+      internals->Lock.Lock();
+      if (!errorMessage.empty())
+      {
+        internals->Failed = true;
+        internals->ErrorMessage = errorMessage;
+        internals->Queue.clear();
+      }
+      else
+      {
+        internals->EncodedFrames++;
+      }
+      internals->Condition.Broadcast();
+      internals->Lock.Unlock();
+      if (!errorMessage.empty())
+      {
+        break;
+      }
+    }
+
+    return VTK_THREAD_RETURN_VALUE;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkCineWriter::vtkCineWriter()
+{
+  this->RenderWindow = NULL;
+  this->Format = vtkCineWriter::ANIMATED_PNG;
+  this->FrameRate = 10;
+  this->AbortExecute = 0;
+  this->Internals = new vtkCineWriterInternals;
+  this->Internals->Self = this;
+  this->Internals->ThreadId = -1;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkCineWriter::~vtkCineWriter()
+{
+  if (-1 != this->Internals->ThreadId)
+  {
+    this->AbortExecuteOn();
+    try
+    {
+      this->End();
+    }
+    catch (std::exception&)
+    {
+    }
+  }
+  delete this->Internals;
+  this->SetRenderWindow(NULL);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkCineWriter::Start(int numberOfFrames)
+{
+  vtkCineWriterInternals* internals = this->Internals;
+  if (-1 != internals->ThreadId || NULL == this->RenderWindow ||
+      this->FileName.empty() || 0 >= numberOfFrames)
+  {
+    return;
+  }
+
+  internals->FileName = this->FileName;
+  internals->Format = this->Format;
+  internals->FrameRate = this->FrameRate;
+  internals->NumberOfFrames = numberOfFrames;
+  internals->QueuedFrames = 0;
+  internals->EncodedFrames = 0;
+  internals->Done = false;
+  internals->Failed = false;
+  internals->ErrorMessage.clear();
+  internals->Sequence = 0;
+
+  if (vtkCineWriter::ANIMATED_PNG == this->Format)
+  {
+    internals->File.open(
+      this->FileName.c_str(), std::ios::out | std::ios::binary);
+    if (!internals->File)
+    {
+      std::stringstream stream;
+      stream << __FILE__;
+      stream << " ";
+      stream << __LINE__;
+      stream << " ";
+      stream << "Unable to open '" << this->FileName << "' for writing.";
+      throw std::runtime_error(stream.str());
+    }
+  }
+
+  // read the back buffer, which the caller has rendered the frame into
+  internals->Capture->SetInput(this->RenderWindow);
+  internals->Capture->ReadFrontBufferOff();
+  internals->Capture->ShouldRerenderOff();
+  internals->Capture->SetInputBufferTypeToRGB();
+
+  this->InvokeEvent(vtkCommand::StartEvent);
+  internals->ThreadId = internals->Threader->SpawnThread(
+    vtkCineWriterEncodeThread, internals);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkCineWriter::WriteFrame()
+{
+  vtkCineWriterInternals* internals = this->Internals;
+  if (-1 == internals->ThreadId || this->AbortExecute ||
+      internals->QueuedFrames >= internals->NumberOfFrames)
+  {
+    return;
+  }
+
+  // capture while the encoder works on the frames already queued
+  internals->Capture->Modified();
+  internals->Capture->Update();
+  vtkSmartPointer<vtkImageData> frame = vtkSmartPointer<vtkImageData>::New();
+  frame->DeepCopy(internals->Capture->GetOutput());
+
+  internals->Lock.Lock();
+  while (2u <= internals->Queue.size() && !internals->Failed)
+  {
+    internals->Condition.Wait(internals->Lock);
+  }
+  if (!internals->Failed)
+  {
+    internals->Queue.push_back(frame);
+    internals->QueuedFrames++;
+    internals->Condition.Broadcast();
+  }
+  double progress =
+    static_cast<double>(internals->EncodedFrames) / internals->NumberOfFrames;
+  internals->Lock.Unlock();
+
+  this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkCineWriter::End()
+{
+  vtkCineWriterInternals* internals = this->Internals;
+  if (-1 == internals->ThreadId)
+  {
+    return 0;
+  }
+
+  internals->Lock.Lock();
+  internals->Done = true;
+  internals->Condition.Broadcast();
+  internals->Lock.Unlock();
+  internals->Threader->TerminateThread(internals->ThreadId);
+  internals->ThreadId = -1;
+
+  bool complete = !internals->Failed &&
+    internals->EncodedFrames == internals->NumberOfFrames;
+  if (vtkCineWriter::ANIMATED_PNG == this->Format)
+  {
+    // the frame count is in the header, so a short animation is discarded
+    if (complete)
+    {
+      vtkCineWriterChunk(
+        internals->File, "IEND", std::vector<unsigned char>());
+    }
+    internals->File.close();
+    if (!complete || internals->File.fail())
+    {
+      std::remove(this->FileName.c_str());
+      if (!internals->Failed && complete)
+      {
+        internals->Failed = true;
+        internals->ErrorMessage = "Unable to write the animation.";
+      }
+    }
+  }
+
+  this->InvokeEvent(vtkCommand::EndEvent);
+
+  if (internals->Failed)
+  {
+    std::stringstream stream;
+    stream << __FILE__;
+    stream << " ";
+    stream << __LINE__;
+    stream << " ";
+    stream << "Unable to write '" << this->FileName << "': "
+           << internals->ErrorMessage;
+    throw std::runtime_error(stream.str());
+  }
+  return vtkCineWriter::ANIMATED_PNG == this->Format && !complete ?
+    0 : internals->EncodedFrames;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkCineWriter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "RenderWindow: " << this->RenderWindow << "\n";
+  os << indent << "FileName: " << this->FileName << "\n";
+  os << indent << "Format: " << this->Format << "\n";
+  os << indent << "FrameRate: " << this->FrameRate << "\n";
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Program:  Birch
+  Module:   vtkCineWriter.h
+  Language: C++
+
+  Author: Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+/**
+ * @class vtkCineWriter
+ *
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief Stream rendered frames of a cine loop to an animated PNG or to
+ * a sequence of numbered PNG files.
+ *
+ * The frames are captured from a render window's back buffer with
+ * vtkWindowToImageFilter, so a caller which turns the window's buffer
+ * swapping off renders them offscreen.  Each captured frame is handed to
+ * an encoder thread, which compresses and writes frame N while the caller
+ * renders frame N+1.  No more than a couple of frames are queued, so the
+ * caller waits rather than running ahead of the encoder.
+ *
+ * Call Start with the number of frames, then WriteFrame after rendering
+ * each one and finally End, which waits for the encoder to finish.  A
+ * progress event is invoked from WriteFrame and, once AbortExecute is set,
+ * frames are no longer queued and End discards an unfinished animation.
+ *
+ * @see vtkMedicalImageViewer::WriteCine
+ */
+
+#ifndef __vtkCineWriter_h
+#define __vtkCineWriter_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// C++ includes
+#include <string>
+
+class vtkCineWriterInternals;
+class vtkRenderWindow;
+
+class vtkCineWriter : public vtkObject
+{
+  public:
+    static vtkCineWriter* New();
+    vtkTypeMacro(vtkCineWriter, vtkObject);
+    void PrintSelf(ostream& os, vtkIndent indent);
+
+    enum FormatType
+    {
+      ANIMATED_PNG = 0,
+      PNG_SEQUENCE
+    };
+
+    //@{
+    /**
+     * Set/Get the render window the frames are captured from.
+     */
+    virtual void SetRenderWindow(vtkRenderWindow* window);
+    vtkGetObjectMacro(RenderWindow, vtkRenderWindow);
+    //@}
+
+    //@{
+    /**
+     * Set/Get the file name.  A PNG sequence is written to files named
+     * with the zero-padded frame number before the extension.
+     */
+    void SetFileName(const std::string& name) { this->FileName = name; }
+    std::string GetFileName() { return this->FileName; }
+    //@}
+
+    //@{
+    /**
+     * Set/Get whether an animated PNG or a PNG sequence is written.
+     * Default is ANIMATED_PNG.
+     */
+    vtkSetClampMacro(Format, int, ANIMATED_PNG, PNG_SEQUENCE);
+    vtkGetMacro(Format, int);
+    void SetFormatToAnimatedPNG() { this->SetFormat(ANIMATED_PNG); }
+    void SetFormatToPNGSequence() { this->SetFormat(PNG_SEQUENCE); }
+    //@}
+
+    //@{
+    /**
+     * Set/Get the frame rate of an animated PNG.  Default 10.
+     */
+    vtkSetClampMacro(FrameRate, int, 1, 60);
+    vtkGetMacro(FrameRate, int);
+    //@}
+
+    //@{
+    /**
+     * Set/Get the flag which stops the export.
+     */
+    vtkSetMacro(AbortExecute, int);
+    vtkGetMacro(AbortExecute, int);
+    vtkBooleanMacro(AbortExecute, int);
+    //@}
+
+    /**
+     * Start the encoder thread for the given number of frames.
+     */
+    void Start(int numberOfFrames);
+
+    /**
+     * Capture the frame rendered in the render window and queue it.
+     */
+    void WriteFrame();
+
+    /**
+     * Wait for the queued frames to be written and stop the encoder.
+     * Returns the number of frames written.
+     */
+    int End();
+
+  protected:
+    vtkCineWriter();
+    ~vtkCineWriter();
+
+    vtkRenderWindow* RenderWindow;
+    std::string FileName;
+    int Format;
+    int FrameRate;
+    int AbortExecute;
+
+    vtkCineWriterInternals* Internals;
+
+  private:
+    vtkCineWriter(const vtkCineWriter&);  /** Not implemented */
+    void operator=(const vtkCineWriter&);  /** Not implemented */
+};
+
+#endif
@@ -9,41 +9,81 @@
 #include <vtkImageDataReader.h>
 
 // Birch inludes
+#include <Common.h>
 #include <Utilities.h>
 
 // VTK includes
 #include <vtkBMPReader.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCriticalSection.h>
+#include <vtkDataArray.h>
+#include <vtkDirectory.h>
+#include <vtkEventForwarderCommand.h>
 #include <vtkGESignaReader.h>
 #include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkIntArray.h>
 #include <vtkJPEGReader.h>
 #include <vtkMedicalImageProperties.h>
 #include <vtkMetaImageReader.h>
+#include <vtkMetaImageWriter.h>
 #include <vtkMINCImageReader.h>
+#include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNGReader.h>
 #include <vtkPNMReader.h>
+#include <vtkPointData.h>
 #include <vtkSLCReader.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkStringArray.h>
 #include <vtkTIFFReader.h>
+#include <vtkVersion.h>
 #include <vtkXMLImageDataReader.h>
+#include <vtkXMLReader.h>
 
 // vtk-dicom includes
+#include <vtkDICOMDirectory.h>
 #include <vtkDICOMReader.h>
 #include <vtkDICOMMetaData.h>
+#include <vtkDICOMParser.h>
+#include <vtkNIFTIHeader.h>
 #include <vtkNIFTIReader.h>
 #include <vtkScancoCTReader.h>
 
 // GDCM includes
-#include <gdcmDirectoryHelper.h>
-#include <gdcmImageReader.h>
+#include <gdcmAttribute.h>
+#include <gdcmImageHelper.h>
+#include <gdcmJPEG2000Codec.h>
+#include <gdcmJPEGCodec.h>
+#include <gdcmJPEGLSCodec.h>
+#include <gdcmReader.h>
+#include <gdcmSequenceOfFragments.h>
 #include <vtkGDCMImageReader.h>
 
+// C includes
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
 // C++ includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
 #include <map>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageDataReader);
 vtkCxxSetObjectMacro(vtkImageDataReader, Reader, vtkAlgorithm);
@@ -54,6 +94,10 @@ vtkImageDataReader::vtkImageDataReader()
   this->Reader = NULL;
   this->MedicalImageProperties =
     vtkSmartPointer<vtkMedicalImageProperties>::New();
+  this->StreamingSlabSize = 0;
+  this->AbortExecute = 0;
+  this->MemoryMapping = 1;
+  this->CachedOutput = 0;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -69,493 +113,1959 @@ vtkMedicalImageProperties* vtkImageDataReader::GetMedicalImageProperties()
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void vtkImageDataReader::SetFileName(const char* fileName)
+vtkDICOMMetaData* vtkImageDataReader::GetMetaData()
 {
-  std::string fileExtension, filePath, fileNameOnly,
-    fileNameStr(fileName);
+  return this->MetaData;
+}
 
-  if (this->FileName.empty() && NULL == fileName)
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::GetStreamedOutput()
+{
+  return this->StreamedImage;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetAbortExecute(int abort)
+{
+  // no Modified(): aborting does not change what is to be read
+  this->AbortExecute = abort;
+  if (this->Reader)
   {
-    return;
+    this->Reader->SetAbortExecute(abort);
   }
+}
 
-  if (!this->FileName.empty() &&
-      !fileNameStr.empty() &&
-      (this->FileName == fileNameStr))
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// The format registry.  Each supported reader is listed once, in order of
+// preference, along with an optional signature test which identifies the
+// file from its leading bytes.  Readers are only instantiated to harvest
+// their file extensions (once per process) and to call CanReadFile when the
+// signature test is inconclusive.  The format chosen for a file is cached
+// against its modification time and size so that IsValidFileName followed
+// by SetFileName probes the file only once.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  enum vtkImageDataReaderSignature
   {
-    return;
-  }
+    SignatureUnknown = 0,
+    SignatureMatch,
+    SignatureMismatch
+  };
 
-  // delete and set the file name to empty
-  this->FileName.clear();
+  // number of leading bytes read when probing a file, enough for the
+  // DICOM preamble and the NIfTI-1 header
+  const std::size_t ProbeHeaderSize = 512;
 
-  if (!fileNameStr.empty())
-  {
-    this->FileName = fileNameStr;
-  }
+  // maximum number of probe results kept before the cache is cleared
+  const std::size_t ProbeCacheSize = 1024;
 
-  // mark the object as modified
-  this->Modified();
+  typedef vtkAlgorithm* (*vtkImageDataReaderNewFunction)();
+  typedef int (*vtkImageDataReaderSignatureFunction)(const std::string&);
 
-  // don't do anything else if the new file name is null
-  if (this->FileName.empty())
+  struct vtkImageDataReaderFormat
   {
-    return;
-  }
+    vtkImageDataReaderNewFunction NewReader;
+    vtkImageDataReaderSignatureFunction Signature;
+    std::string Extensions;
+  };
 
-  // make sure FileName exists, throw an exception if it doesn't
-  if (!Birch::Utilities::fileExists(this->FileName))
+  struct vtkImageDataReaderProbe
   {
-    std::stringstream error;
-    error << "File '" << this->FileName << "' not found.";
-    throw std::runtime_error(error.str());
-  }
-
-  fileExtension = Birch::Utilities::getFileExtension(this->FileName);
-  fileNameOnly = Birch::Utilities::getFilenameName(this->FileName);
+    time_t MTime;
+    off_t Size;
+    int Format;
+  };
 
-  // need an instance of all readers to scan valid extensions
-  vtkSmartPointer<vtkBMPReader> BMPReader =
-    vtkSmartPointer<vtkBMPReader>::New();
-  vtkSmartPointer<vtkDICOMReader> DICOMReader =
-    vtkSmartPointer<vtkDICOMReader>::New();
-  vtkSmartPointer<vtkGDCMImageReader> GDCMImageReader =
-    vtkSmartPointer<vtkGDCMImageReader>::New();
-  vtkSmartPointer<vtkGESignaReader> GESignaReader =
-    vtkSmartPointer<vtkGESignaReader>::New();
-  vtkSmartPointer<vtkJPEGReader> JPEGReader =
-    vtkSmartPointer<vtkJPEGReader>::New();
-  vtkSmartPointer<vtkMetaImageReader> MetaImageReader =
-    vtkSmartPointer<vtkMetaImageReader>::New();
-  vtkSmartPointer<vtkMINCImageReader> MINCImageReader =
-    vtkSmartPointer<vtkMINCImageReader>::New();
-  vtkSmartPointer<vtkNIFTIReader> NIFTIReader =
-    vtkSmartPointer<vtkNIFTIReader>::New();
-  vtkSmartPointer<vtkPNGReader> PNGReader =
-    vtkSmartPointer<vtkPNGReader>::New();
-  vtkSmartPointer<vtkPNMReader> PNMReader =
-    vtkSmartPointer<vtkPNMReader>::New();
-  vtkSmartPointer<vtkSLCReader> SLCReader =
-    vtkSmartPointer<vtkSLCReader>::New();
-  vtkSmartPointer<vtkScancoCTReader> ScancoCTReader =
-    vtkSmartPointer<vtkScancoCTReader>::New();
-  vtkSmartPointer<vtkTIFFReader> TIFFReader =
-    vtkSmartPointer<vtkTIFFReader>::New();
-  vtkSmartPointer<vtkXMLImageDataReader> XMLImageDataReader =
-    vtkSmartPointer<vtkXMLImageDataReader>::New();
-
-  // search through each reader to see which 'likes' the file extension
-
-  const char* fname = this->FileName.c_str();
-  if (std::string::npos != Birch::Utilities::toLower(
-    DICOMReader->GetFileExtensions()).find(fileExtension)
-    && DICOMReader->CanReadFile(fname))
-  {
-    // DICOM (preferred)
-    this->SetReader(DICOMReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    GDCMImageReader->GetFileExtensions()).find(fileExtension)
-    && GDCMImageReader->CanReadFile(fname))
-  {
-    // DICOM
-    this->SetReader(GDCMImageReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    BMPReader->GetFileExtensions()).find(fileExtension)
-    && BMPReader->CanReadFile(fname))
-  {
-    // BMP
-    this->SetReader(BMPReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    GESignaReader->GetFileExtensions()).find(fileExtension)
-    && GESignaReader->CanReadFile(fname))
-  {
-    // GESigna file
-    this->SetReader(GESignaReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    JPEGReader->GetFileExtensions()).find(fileExtension)
-    && JPEGReader->CanReadFile(fname))
-  {
-    // JPEG file
-    this->SetReader(JPEGReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    MetaImageReader->GetFileExtensions()).find(fileExtension)
-    && MetaImageReader->CanReadFile(fname))
-  {
-    // MetaImage file
-    this->SetReader(MetaImageReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    MINCImageReader->GetFileExtensions()).find(fileExtension)
-    && MINCImageReader->CanReadFile(fname))
-  {
-    // MINCImage file
-    this->SetReader(MINCImageReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    NIFTIReader->GetFileExtensions()).find(fileExtension)
-    && NIFTIReader->CanReadFile(fname))
-  {
-    // NIFTI file
-    this->SetReader(NIFTIReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    PNGReader->GetFileExtensions()).find(fileExtension)
-    && PNGReader->CanReadFile(fname))
-  {
-    // PNG file
-    this->SetReader(PNGReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    PNMReader->GetFileExtensions()).find(fileExtension)
-    && PNMReader->CanReadFile(fname))
-  {
-    // PNM file
-    this->SetReader(PNMReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    SLCReader->GetFileExtensions()).find(fileExtension)
-    && SLCReader->CanReadFile(fname))
-  {
-    // SLC file
-    this->SetReader(SLCReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    ScancoCTReader->GetFileExtensions()).find(fileExtension)
-    && ScancoCTReader->CanReadFile(fname))
-  {
-    // ScancoCT file
-    this->SetReader(ScancoCTReader);
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    TIFFReader->GetFileExtensions()).find(fileExtension)
-    && TIFFReader->CanReadFile(fname))
-  {
-    // TIFF file
-    this->SetReader(TIFFReader);
-  }
-  else if (".vti" == fileExtension  // no GetFileExtensions() method
-    && XMLImageDataReader->CanReadFile(fname))
-  {
-    // VTI file
-    this->SetReader(XMLImageDataReader);
-  }
-  else  // don't know how to handle this file, set the reader to NULL and
-        // mark the file type as unknown
+  template <class T>
+  vtkAlgorithm* vtkImageDataReaderNew()
   {
-    this->SetReader(NULL);
-    std::stringstream error;
-    error << "Unable to read '" << fileNameOnly << "', unknown file type.";
-    throw std::runtime_error(error.str());
+    return T::New();
   }
-}
 
-// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-bool vtkImageDataReader::IsValidFileName(const char* fileName)
-{
-  if (NULL == fileName || !Birch::Utilities::fileExists(fileName))
+  int vtkDICOMSignature(const std::string& header)
   {
-    return false;
+    // files without the preamble (ACR-NEMA) are left to CanReadFile
+    if (132 <= header.size() && 0 == header.compare(128, 4, "DICM"))
+    {
+      return SignatureMatch;
+    }
+    return SignatureUnknown;
   }
 
-  bool knownFileType = false;
-  std::string fileExtension;
-
-  // ok, we have a valid file or directory name, get some details
-  fileExtension = Birch::Utilities::getFileExtension(
-    Birch::Utilities::toLower(fileName));
-
-  // we need an instance of all readers so we can scan extensions
-  vtkNew<vtkBMPReader> BMPReader;
-  vtkNew<vtkDICOMReader> DICOMReader;
-  vtkNew<vtkGDCMImageReader> GDCMImageReader;
-  vtkNew<vtkGESignaReader> GESignaReader;
-  vtkNew<vtkJPEGReader> JPEGReader;
-  vtkNew<vtkMetaImageReader> MetaImageReader;
-  vtkNew<vtkMINCImageReader> MINCImageReader;
-  vtkNew<vtkNIFTIReader> NIFTIReader;
-  vtkNew<vtkPNGReader> PNGReader;
-  vtkNew<vtkPNMReader> PNMReader;
-  vtkNew<vtkSLCReader> SLCReader;
-  vtkNew<vtkScancoCTReader> ScancoCTReader;
-  vtkNew<vtkTIFFReader> TIFFReader;
-  vtkNew<vtkXMLImageDataReader> XMLImageDataReader;
-
-  // now search through each reader to see which 'likes' the file extension
-  if (std::string::npos != Birch::Utilities::toLower(
-    DICOMReader->GetFileExtensions()).find(fileExtension)
-    && DICOMReader->CanReadFile(fileName))
-  {
-    // DICOM (preferred)
-    knownFileType = true;
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    GDCMImageReader->GetFileExtensions()).find(fileExtension)
-    && GDCMImageReader->CanReadFile(fileName))
-  {
-    // DICOM
-    knownFileType = true;
-  }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    BMPReader->GetFileExtensions()).find(fileExtension)
-    && BMPReader->CanReadFile(fileName))
+  int vtkBMPSignature(const std::string& header)
   {
-    // BMP
-    knownFileType = true;
+    return 0 == header.compare(0, 2, "BM") ?
+      SignatureMatch : SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    GESignaReader->GetFileExtensions()).find(fileExtension)
-    && GESignaReader->CanReadFile(fileName))
+
+  int vtkJPEGSignature(const std::string& header)
   {
-    // GESigna file
-    knownFileType = true;
+    return 0 == header.compare(0, 3, "\xff\xd8\xff") ?
+      SignatureMatch : SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    JPEGReader->GetFileExtensions()).find(fileExtension)
-    && JPEGReader->CanReadFile(fileName))
+
+  int vtkMINCSignature(const std::string& header)
   {
-    // JPEG file
-    knownFileType = true;
+    // netCDF classic and 64-bit offset formats (MINC1)
+    if (0 == header.compare(0, 4, std::string("CDF\x01", 4)) ||
+        0 == header.compare(0, 4, std::string("CDF\x02", 4)))
+    {
+      return SignatureMatch;
+    }
+    return SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    MetaImageReader->GetFileExtensions()).find(fileExtension)
-    && MetaImageReader->CanReadFile(fileName))
+
+  int vtkNIFTISignature(const std::string& header)
   {
-    // MetaImage file
-    knownFileType = true;
+    // compressed and NIfTI-2 files are left to CanReadFile
+    if (348 <= header.size() &&
+        (0 == header.compare(344, 4, std::string("n+1\0", 4)) ||
+         0 == header.compare(344, 4, std::string("ni1\0", 4))))
+    {
+      return SignatureMatch;
+    }
+    return SignatureUnknown;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    MINCImageReader->GetFileExtensions()).find(fileExtension)
-    && MINCImageReader->CanReadFile(fileName))
+
+  int vtkPNGSignature(const std::string& header)
   {
-    // MINCImage file
-    knownFileType = true;
+    return 0 == header.compare(0, 8, "\x89PNG\r\n\x1a\n") ?
+      SignatureMatch : SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    NIFTIReader->GetFileExtensions()).find(fileExtension)
-    && NIFTIReader->CanReadFile(fileName))
+
+  int vtkPNMSignature(const std::string& header)
   {
-    // NIFTI file
-    knownFileType = true;
+    if (2 <= header.size() && 'P' == header[0] &&
+        '1' <= header[1] && '6' >= header[1])
+    {
+      return SignatureMatch;
+    }
+    return SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    PNGReader->GetFileExtensions()).find(fileExtension)
-    && PNGReader->CanReadFile(fileName))
+
+  int vtkTIFFSignature(const std::string& header)
   {
-    // PNG file
-    knownFileType = true;
+    // classic TIFF or BigTIFF, in either byte order
+    if (0 == header.compare(0, 4, std::string("II*\0", 4)) ||
+        0 == header.compare(0, 4, std::string("MM\0*", 4)) ||
+        0 == header.compare(0, 4, std::string("II+\0", 4)) ||
+        0 == header.compare(0, 4, std::string("MM\0+", 4)))
+    {
+      return SignatureMatch;
+    }
+    return SignatureMismatch;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    PNMReader->GetFileExtensions()).find(fileExtension)
-    && PNMReader->CanReadFile(fileName))
+
+  int vtkVTISignature(const std::string& header)
   {
-    // PNM file
-    knownFileType = true;
+    std::string::size_type pos =
+      header.find_first_not_of(" \t\r\n\xef\xbb\xbf");
+    if (std::string::npos == pos || '<' != header[pos])
+    {
+      return SignatureMismatch;
+    }
+    if (std::string::npos != header.find("<VTKFile") &&
+        std::string::npos != header.find("type=\"ImageData\""))
+    {
+      return SignatureMatch;
+    }
+    return SignatureUnknown;
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    SLCReader->GetFileExtensions()).find(fileExtension)
-    && SLCReader->CanReadFile(fileName))
+
+  // bring a reader up to date for a sub-extent of its whole extent
+  void vtkImageDataReaderUpdateExtent(vtkAlgorithm* reader, int extent[6])
   {
-    // SLC file
-    knownFileType = true;
+#if VTK_MAJOR_VERSION > 7 || (VTK_MAJOR_VERSION == 7 && VTK_MINOR_VERSION > 0)
+    reader->UpdateExtent(extent);
+#else
+    reader->UpdateInformation();
+    vtkStreamingDemandDrivenPipeline::SetUpdateExtent(
+      reader->GetOutputInformation(0), extent);
+    reader->Update();
+#endif
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    ScancoCTReader->GetFileExtensions()).find(fileExtension)
-    && ScancoCTReader->CanReadFile(fileName))
+
+  vtkSimpleCriticalSection vtkImageDataReaderLock;
+  std::map<std::string, vtkImageDataReaderProbe> vtkImageDataReaderProbes;
+
+  void vtkImageDataReaderAddFormat(
+    std::vector<vtkImageDataReaderFormat>& formats,
+    vtkImageDataReaderNewFunction newReader,
+    vtkImageDataReaderSignatureFunction signature,
+    const char* extensions = NULL)
   {
-    // ScancoCT file
-    knownFileType = true;
+    vtkImageDataReaderFormat format;
+    format.NewReader = newReader;
+    format.Signature = signature;
+    if (extensions)
+    {
+      format.Extensions = extensions;
+    }
+    else
+    {
+      vtkSmartPointer<vtkAlgorithm> reader =
+        vtkSmartPointer<vtkAlgorithm>::Take(newReader());
+      vtkImageReader2* imageReader = vtkImageReader2::SafeDownCast(reader);
+      if (imageReader && imageReader->GetFileExtensions())
+      {
+        format.Extensions =
+          Birch::Utilities::toLower(imageReader->GetFileExtensions());
+      }
+    }
+    formats.push_back(format);
   }
-  else if (std::string::npos != Birch::Utilities::toLower(
-    TIFFReader->GetFileExtensions()).find(fileExtension)
-    && TIFFReader->CanReadFile(fileName))
+
+  // must be called while holding vtkImageDataReaderLock
+  const std::vector<vtkImageDataReaderFormat>& vtkImageDataReaderFormats()
   {
-    // TIFF file
-    knownFileType = true;
+    static std::vector<vtkImageDataReaderFormat> formats;
+    if (formats.empty())
+    {
+      // order of preference: vtk-dicom's reader is preferred over GDCM's
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkDICOMReader>, vtkDICOMSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkGDCMImageReader>, vtkDICOMSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkBMPReader>, vtkBMPSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkGESignaReader>, NULL);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkJPEGReader>, vtkJPEGSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkMetaImageReader>, NULL);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkMINCImageReader>, vtkMINCSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkNIFTIReader>, vtkNIFTISignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkPNGReader>, vtkPNGSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkPNMReader>, vtkPNMSignature);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkSLCReader>, NULL);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkScancoCTReader>, NULL);
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkTIFFReader>, vtkTIFFSignature);
+      // no GetFileExtensions() method
+      vtkImageDataReaderAddFormat(formats,
+        vtkImageDataReaderNew<vtkXMLImageDataReader>, vtkVTISignature,
+        ".vti");
+    }
+    return formats;
   }
-  else if (".vti" == fileExtension  // no GetFileExtensions() method
-    && XMLImageDataReader->CanReadFile(fileName))
+
+  // identify the format of a file, returning its index in the registry
+  // or -1 if no reader can read the file
+  int vtkImageDataReaderProbeFile(const std::string& fileName)
   {
-    // VTI file
-    knownFileType = true;
-  }
+    struct stat info;
+    if (0 != stat(fileName.c_str(), &info))
+    {
+      return -1;
+    }
 
-  return knownFileType;
-}
+    vtkImageDataReaderLock.Lock();
+    const std::vector<vtkImageDataReaderFormat>& formats =
+      vtkImageDataReaderFormats();
+    std::map<std::string, vtkImageDataReaderProbe>::const_iterator it =
+      vtkImageDataReaderProbes.find(fileName);
+    if (it != vtkImageDataReaderProbes.end() &&
+        it->second.MTime == info.st_mtime &&
+        it->second.Size == info.st_size)
+    {
+      int format = it->second.Format;
+      vtkImageDataReaderLock.Unlock();
+      return format;
+    }
+    vtkImageDataReaderLock.Unlock();
 
-// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-vtkImageData* vtkImageDataReader::GetOutputAsNewInstance()
-{
-  vtkImageData* newImage = NULL;
-  vtkImageData* image = this->GetOutput();
+    // read the leading bytes once for all of the signature tests
+    std::string header;
+    std::ifstream stream(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (stream.is_open())
+    {
+      char buffer[ProbeHeaderSize];
+      stream.read(buffer, ProbeHeaderSize);
+      header.assign(buffer, stream.gcount());
+    }
 
-  if (image)
-  {
-    // create a copy of the image
-    // this copy MUST be deleted by the caller of this method
-    newImage = image->NewInstance();
-    newImage->DeepCopy(image);
-  }
+    std::string fileExtension = Birch::Utilities::getFileExtension(
+      Birch::Utilities::toLower(fileName));
 
-  return newImage;
-}
+    // search through each reader to see which 'likes' the file
+    int format = -1;
+    for (std::size_t i = 0; i < formats.size() && -1 == format; ++i)
+    {
+      if (std::string::npos == formats[i].Extensions.find(fileExtension))
+      {
+        continue;
+      }
 
-// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-vtkImageData* vtkImageDataReader::GetOutput()
-{
-  std::string fileNameOnly;
-  vtkXMLImageDataReader* XMLReader = NULL;
-  vtkGDCMImageReader* gdcmReader = NULL;
-  vtkImageReader2* imageReader = NULL;
-  vtkImageData* image = NULL;
-  this->MedicalImageProperties->Clear();
+      int signature = formats[i].Signature ?
+        formats[i].Signature(header) : SignatureUnknown;
+      if (SignatureMatch == signature)
+      {
+        format = static_cast<int>(i);
+      }
+      else if (SignatureUnknown == signature)
+      {
+        vtkSmartPointer<vtkAlgorithm> reader =
+          vtkSmartPointer<vtkAlgorithm>::Take(formats[i].NewReader());
+        vtkImageReader2* imageReader = vtkImageReader2::SafeDownCast(reader);
+        vtkXMLReader* xmlReader = vtkXMLReader::SafeDownCast(reader);
+        if ((imageReader && imageReader->CanReadFile(fileName.c_str())) ||
+            (xmlReader && xmlReader->CanReadFile(fileName.c_str())))
+        {
+          format = static_cast<int>(i);
+        }
+      }
+    }
 
-  // if the file name or reader are null simply return null
-  if (this->FileName.empty() || NULL == this->Reader)
-  {
-    return NULL;
-  }
+    vtkImageDataReaderProbe probe;
+    probe.MTime = info.st_mtime;
+    probe.Size = info.st_size;
+    probe.Format = format;
 
-  // we might need this
-  fileNameOnly = Birch::Utilities::getFilenameName(this->FileName);
+    vtkImageDataReaderLock.Lock();
+    if (ProbeCacheSize <= vtkImageDataReaderProbes.size())
+    {
+      vtkImageDataReaderProbes.clear();
+    }
+    vtkImageDataReaderProbes[fileName] = probe;
+    vtkImageDataReaderLock.Unlock();
 
-  // Ok, we have a valid file and reader, process based on reader type
-  if (this->Reader->IsA("vtkXMLImageDataReader"))
+    return format;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Read the attributes of a DICOM file, stopping at the pixel data,
+  // returning NULL if the file cannot be parsed
+  vtkSmartPointer<vtkDICOMMetaData> vtkImageDataReaderParseHeader(
+    const std::string& fileName)
   {
-    // we know that Reader must be a vtkXMLImageDataReader object
-    XMLReader = vtkXMLImageDataReader::SafeDownCast(this->Reader);
+    vtkSmartPointer<vtkDICOMMetaData> meta =
+      vtkSmartPointer<vtkDICOMMetaData>::New();
+    meta->SetNumberOfInstances(1);
+    vtkNew<vtkDICOMParser> parser;
+    parser->SetMetaData(meta);
+    parser->SetFileName(fileName.c_str());
+    parser->Update();
+    if (0 != parser->GetErrorCode())
+    {
+      return NULL;
+    }
+    return meta;
+  }
 
-    // see if we have already read the data from the disk
-    // and return it if we have
-    if (this->ReadMTime >= this->GetMTime())
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Find the largest run of numbered 2D images in a directory, such as
+  // slice_0001.png to slice_2000.png, returning their paths in numeric
+  // order, or none if there is no run of at least two images.  A run in
+  // which two names give the same number, such as slice_1 and slice_01,
+  // has no single order and is never chosen.
+  std::vector<std::string> vtkImageDataReaderFindStack(const std::string& path)
+  {
+    std::vector<std::string> stack;
+    vtkNew<vtkDirectory> directory;
+    if (!directory->Open(path.c_str()))
     {
-      image = XMLReader->GetOutput();
+      return stack;
     }
-    else  // this reader is not up to date, re-read the file
+
+    // runs are keyed by the text around the number
+    typedef std::map<std::string, std::string> vtkImageDataReaderRun;
+    std::map<std::string, vtkImageDataReaderRun> runs;
+    std::set<std::string> ambiguous;
+    for (vtkIdType i = 0; i < directory->GetNumberOfFiles(); ++i)
     {
-      // check that we can read the file
-      if (!XMLReader->CanReadFile(this->FileName.c_str()))
+      std::string name = directory->GetFile(i);
+      std::string extension =
+        Birch::Utilities::toLower(Birch::Utilities::getFileExtension(name));
+      if (".bmp" != extension && ".jpeg" != extension &&
+          ".jpg" != extension && ".png" != extension &&
+          ".tif" != extension && ".tiff" != extension)
       {
-        std::stringstream error;
-        error << "Unable to read '" << fileNameOnly << "' as a VTI file.";
-        throw std::runtime_error(error.str());
+        continue;
       }
 
-      XMLReader->SetFileName(this->FileName.c_str());
+      std::string stem = name.substr(0, name.size() - extension.size());
+      size_t digits = stem.find_last_not_of("0123456789") + 1;
+      if (digits == stem.size())
+      {
+        continue;
+      }
 
-      // get a reference to the (updated) output image
-      XMLReader->Update();
-      image = XMLReader->GetOutput();
+      // compare the numbers by value: strip the leading zeros and pad
+      std::string number = stem.substr(digits);
+      number.erase(0, std::min(number.find_first_not_of('0'),
+        number.size() - 1));
+      number.insert(0, 20 - std::min(number.size(), size_t(20)), '0');
+      std::string key = stem.substr(0, digits) + "*" + extension;
+      if (!runs[key].insert(std::make_pair(number, path + "/" + name)).second)
+      {
+        ambiguous.insert(key);
+      }
     }
-  }
-  else  // if we get here then the reader is some form of vtkImageReader2
-  {
-    // we know that Reader must be a vtkImageReader2 object
-    imageReader = vtkImageReader2::SafeDownCast(this->Reader);
 
-    // if this reader is not up to date, re-read the file
-    if (this->ReadMTime >= this->GetMTime())
+    std::map<std::string, vtkImageDataReaderRun>::const_iterator run;
+    std::map<std::string, vtkImageDataReaderRun>::const_iterator largest =
+      runs.end();
+    for (run = runs.begin(); run != runs.end(); ++run)
     {
-      image = imageReader->GetOutput();
+      if (ambiguous.count(run->first))
+      {
+        continue;
+      }
+      if (largest == runs.end() || largest->second.size() < run->second.size())
+      {
+        largest = run;
+      }
     }
-    else
+    if (largest != runs.end() && 1 < largest->second.size())
     {
-      // check that we can read the file
-      if (!imageReader->CanReadFile(this->FileName.c_str()))
+      vtkImageDataReaderRun::const_iterator it;
+      for (it = largest->second.begin(); it != largest->second.end(); ++it)
       {
-        std::stringstream error;
-        error << "Unable to read '" << fileNameOnly << "' as a ";
-        error << imageReader->GetDescriptiveName() << " file.";
-        throw std::runtime_error(error.str());
+        stack.push_back(it->second);
       }
+    }
+    return stack;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Memory mapping.  Uncompressed MetaImage, single file NIfTI and raw
+// appended VTI files store their voxels contiguously in native layout, so
+// the scalars can wrap the file's pages directly instead of being copied.
+// The mapping is private (copy on write) and is released when the scalar
+// array is deleted.  Pages not yet written to are still read from the
+// file, so a file truncated by another program while it is mapped raises
+// SIGBUS when the voxels past its new end are touched: mapped files must
+// not be rewritten in place while they are viewed.  The geometry comes
+// from the reader's information pass; only the location of the voxels is
+// parsed here.  Anything unusual about a file (compression, foreign byte
+// order, several arrays or pieces, slice reordering) makes these functions
+// return false so that the reader is used as before.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+#ifdef VTK_WORDS_BIGENDIAN
+  const bool NativeBigEndian = true;
+#else
+  const bool NativeBigEndian = false;
+#endif
 
-      imageReader->SetFileName(this->FileName.c_str());
+  struct vtkImageDataReaderMapping
+  {
+    void* Address;
+    size_t Length;
+  };
 
-      // get a reference to the (updated) output image
-      imageReader->Update();
-      image = imageReader->GetOutput();
-    }
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataReaderUnmap(vtkObject* vtkNotUsed(caller),
+    unsigned long vtkNotUsed(event), void* clientData,
+    void* vtkNotUsed(callData))
+  {
+#ifndef _WIN32
+    vtkImageDataReaderMapping* mapping =
+      static_cast<vtkImageDataReaderMapping*>(clientData);
+    munmap(mapping->Address, mapping->Length);
+    delete mapping;
+#endif
   }
 
-  // if we did get an image, check that it has valid extents:
-  // GetNumberOfCells is zero for invalid vtkImageData Extents
-  if (image)
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Wrap the voxels found at offset in fileName as the scalars of image,
+  // whose extent must already be set
+  bool vtkImageDataReaderMapScalars(const std::string& fileName,
+    vtkTypeInt64 offset, int scalarType, int components, vtkImageData* image)
   {
-    vtkIdType nCells = image->GetNumberOfCells();
-    if (nCells == 0)
+#ifdef _WIN32
+    return false;
+#else
+    int typeSize = vtkDataArray::GetDataTypeSize(scalarType);
+    if (0 >= typeSize || 0 >= components || 0 > offset ||
+        0 != offset % typeSize)
     {
-      return NULL;
+      return false;
+    }
+
+    vtkIdType values = image->GetNumberOfPoints() * components;
+    vtkTypeInt64 bytes = static_cast<vtkTypeInt64>(values) * typeSize;
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (0 > fd)
+    {
+      return false;
     }
+
+    struct stat info;
+    if (0 != fstat(fd, &info) || info.st_size < offset + bytes)
+    {
+      close(fd);
+      return false;
+    }
+
+    // mmap offsets must be page aligned
+    vtkTypeInt64 pageSize = sysconf(_SC_PAGESIZE);
+    vtkTypeInt64 start = offset - offset % pageSize;
+    size_t length = static_cast<size_t>(offset + bytes - start);
+    void* address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+      fd, static_cast<off_t>(start));
+    close(fd);
+    if (MAP_FAILED == address)
+    {
+      return false;
+    }
+
+    vtkDataArray* scalars = vtkDataArray::CreateDataArray(scalarType);
+    scalars->SetNumberOfComponents(components);
+    scalars->SetVoidArray(
+      static_cast<char*>(address) + (offset - start), values, 1);
+
+    vtkImageDataReaderMapping* mapping = new vtkImageDataReaderMapping;
+    mapping->Address = address;
+    mapping->Length = length;
+    vtkNew<vtkCallbackCommand> unmap;
+    unmap->SetCallback(vtkImageDataReaderUnmap);
+    unmap->SetClientData(mapping);
+    scalars->AddObserver(vtkCommand::DeleteEvent, unmap.GetPointer());
+
+    image->GetPointData()->SetScalars(scalars);
+    scalars->Delete();
+    return true;
+#endif
   }
 
-  // set up the medical image properties
-  if (this->Reader->IsA("vtkGESignaReader"))
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataReaderIsTrue(const std::string& value)
   {
-    vtkGESignaReader* imageReader =
-      vtkGESignaReader::SafeDownCast(this->Reader);
-    this->MedicalImageProperties->DeepCopy(
-      imageReader->GetMedicalImageProperties());
+    std::string lower = Birch::Utilities::toLower(value);
+    return "true" == lower || "1" == lower;
   }
-  else if (this->Reader->IsA("vtkDICOMReader"))
-  {
-    vtkDICOMReader* imageReader =
-      vtkDICOMReader::SafeDownCast(this->Reader);
-    this->MedicalImageProperties->DeepCopy(
-      imageReader->GetMedicalImageProperties());
-
-    std::map<std::string, vtkDICOMTag> dicomMap;
-    dicomMap["AcquisitionDateTime"] = vtkDICOMTag(0x0008, 0x002a);
-    dicomMap["SeriesNumber"] = vtkDICOMTag(0x0020, 0x0011);
-    dicomMap["CineRate"] = vtkDICOMTag(0x0018, 0x0040);
-    dicomMap["RecommendedDisplayFrameRate"] = vtkDICOMTag(0x0008, 0x2114);
-    vtkDICOMMetaData* meta = imageReader->GetMetaData();
 
-    for (auto it = dicomMap.cbegin(); it != dicomMap.cend(); ++it)
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Find the file and offset of the voxels of a MetaImage (.mha or .mhd),
+  // which must hold all of the bytes of the voxels
+  bool vtkImageDataReaderLocateMetaImage(const std::string& fileName,
+    vtkTypeInt64 bytes, std::string& dataFile, vtkTypeInt64& offset)
+  {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    std::string line;
+    vtkTypeInt64 headerSize = 0;
+    while (std::getline(file, line))
     {
-      if (meta->HasAttribute(it->second))
+      size_t pos = line.find('=');
+      if (std::string::npos == pos)
       {
-        std::string name = it->first;
-        std::string value =
-          meta->GetAttributeValue(it->second).AsString();
-        if (!value.empty())
+        continue;
+      }
+      std::string key = line.substr(0, pos);
+      std::string value = line.substr(pos + 1);
+      Birch::Utilities::trim(key);
+      Birch::Utilities::trim(value);
+
+      if ("CompressedData" == key)
+      {
+        if (vtkImageDataReaderIsTrue(value)) return false;
+      }
+      else if ("BinaryData" == key)
+      {
+        if (!vtkImageDataReaderIsTrue(value)) return false;
+      }
+      else if ("BinaryDataByteOrderMSB" == key || "ElementByteOrderMSB" == key)
+      {
+        if (vtkImageDataReaderIsTrue(value) != NativeBigEndian) return false;
+      }
+      else if ("HeaderSize" == key)
+      {
+        std::stringstream stream(value);
+        stream >> headerSize;
+        if (stream.fail() || 0 > headerSize) return false;
+      }
+      else if ("ElementDataFile" == key)
+      {
+        // ElementDataFile is always the last field of the header, local
+        // voxels follow the end of its line
+        if ("LOCAL" == value)
         {
-          value = Birch::Utilities::trim(value);
-          this->MedicalImageProperties->AddUserDefinedValue(
-            name.c_str(), value.c_str());
+          vtkTypeInt64 position = static_cast<vtkTypeInt64>(file.tellg());
+          if (0 > position)
+          {
+            return false;
+          }
+          dataFile = fileName;
+          offset = position + headerSize;
+        }
+        else
+        {
+          if ("LIST" == value.substr(0, 4) ||
+              std::string::npos != value.find('%') ||
+              std::string::npos != value.find(' '))
+          {
+            return false;
+          }
+          size_t slash = fileName.find_last_of("/\\");
+          dataFile = std::string::npos == slash || '/' == value[0] ?
+            value : fileName.substr(0, slash + 1) + value;
+          offset = headerSize;
         }
+
+        struct stat info;
+        return 0 == stat(dataFile.c_str(), &info) &&
+          info.st_size >= offset + bytes;
       }
     }
+    return false;
   }
-  else if (this->Reader->IsA("vtkGDCMImageReader"))
-  {
-    vtkGDCMImageReader* imageReader =
-      vtkGDCMImageReader::SafeDownCast(this->Reader);
-    this->MedicalImageProperties->DeepCopy(
-      imageReader->GetMedicalImageProperties());
-
-    gdcm::ImageReader reader;
-    reader.SetFileName(imageReader->GetFileName());
-    reader.Read();
-    const gdcm::File& file = reader.GetFile();
-    const gdcm::DataSet& ds = file.GetDataSet();
 
-    std::map<std::string, gdcm::Tag> dicomMap;
-    dicomMap["AcquisitionDateTime"] = gdcm::Tag(0x0008, 0x002a);
-    dicomMap["SeriesNumber"] = gdcm::Tag(0x0020, 0x0011);
-    dicomMap["CineRate"] = gdcm::Tag(0x0018, 0x0040);
-    dicomMap["RecommendedDisplayFrameRate"] = gdcm::Tag(0x0008, 0x2114);
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Find the offset of the voxels of a single file NIfTI (.nii) image
+  bool vtkImageDataReaderLocateNIFTI(const std::string& fileName,
+    vtkNIFTIReader* reader, vtkTypeInt64& offset)
+  {
+    // the reader reverses the slice order when the qfac is negative
+    std::string extension = Birch::Utilities::toLower(
+      fileName.substr(fileName.size() < 4 ? 0 : fileName.size() - 4));
+    if (".nii" != extension || 0 > reader->GetQFac())
+    {
+      return false;
+    }
+
+    // the header size reads correctly only in the file's byte order
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    vtkTypeInt32 headerSize = 0;
+    file.read(reinterpret_cast<char*>(&headerSize), 4);
+    if (!file || (348 != headerSize && 540 != headerSize))
+    {
+      return false;
+    }
+
+    offset =
+      static_cast<vtkTypeInt64>(reader->GetNIFTIHeader()->GetVoxOffset());
+    return true;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Get the value of an XML attribute from a tag's text
+  std::string vtkImageDataReaderAttribute(const std::string& tag,
+    const std::string& name)
+  {
+    std::string key = " " + name + "=\"";
+    size_t pos = tag.find(key);
+    if (std::string::npos == pos)
+    {
+      return "";
+    }
+    pos += key.size();
+    size_t end = tag.find('"', pos);
+    return std::string::npos == end ? "" : tag.substr(pos, end - pos);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Get the text of the first tag named name at or after pos
+  std::string vtkImageDataReaderTag(const std::string& text,
+    const std::string& name, size_t pos = 0)
+  {
+    size_t start = text.find("<" + name, pos);
+    if (std::string::npos == start)
+    {
+      return "";
+    }
+    size_t end = text.find('>', start);
+    return std::string::npos == end ? "" : text.substr(start, end - start + 1);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Find the offset of the voxels of a VTI file holding a single raw,
+  // uncompressed, appended point data array
+  bool vtkImageDataReaderLocateVTI(const std::string& fileName,
+    vtkTypeInt64 bytes, vtkTypeInt64& offset)
+  {
+    // the XML header precedes the appended data and is small
+    const size_t maxHeader = 1 << 20;
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    std::string header;
+    size_t marker = std::string::npos;
+    char buffer[4096];
+    while (std::string::npos == marker && header.size() < maxHeader &&
+           file.read(buffer, sizeof(buffer)).gcount() > 0)
+    {
+      header.append(buffer, static_cast<size_t>(file.gcount()));
+      size_t appended = header.find("<AppendedData");
+      if (std::string::npos != appended)
+      {
+        marker = header.find('_', header.find('>', appended));
+      }
+    }
+    if (std::string::npos == marker)
+    {
+      return false;
+    }
+
+    std::string vtkFile = vtkImageDataReaderTag(header, "VTKFile");
+    std::string appendedData = vtkImageDataReaderTag(header, "AppendedData");
+    if (!vtkImageDataReaderAttribute(vtkFile, "compressor").empty() ||
+        "raw" != vtkImageDataReaderAttribute(appendedData, "encoding") ||
+        ("BigEndian" == vtkImageDataReaderAttribute(vtkFile, "byte_order")) !=
+          NativeBigEndian)
+    {
+      return false;
+    }
+
+    // a single piece with a single array, which must be the scalars
+    size_t piece = header.find("<Piece");
+    std::string pointData = vtkImageDataReaderTag(header, "PointData");
+    std::string dataArray = vtkImageDataReaderTag(header, "DataArray");
+    if (std::string::npos == piece ||
+        std::string::npos != header.find("<Piece", piece + 1) ||
+        header.find("<DataArray") != header.rfind("<DataArray") ||
+        vtkImageDataReaderAttribute(pointData, "Scalars").empty() ||
+        vtkImageDataReaderAttribute(pointData, "Scalars") !=
+          vtkImageDataReaderAttribute(dataArray, "Name") ||
+        "appended" != vtkImageDataReaderAttribute(dataArray, "format") ||
+        header.find("<PointData") > header.find("<DataArray"))
+    {
+      return false;
+    }
+
+    std::stringstream stream(vtkImageDataReaderAttribute(dataArray, "offset"));
+    vtkTypeInt64 arrayOffset = -1;
+    stream >> arrayOffset;
+    if (stream.fail() || 0 > arrayOffset)
+    {
+      return false;
+    }
+
+    // each appended array is preceded by its size in bytes
+    bool header64 =
+      "UInt64" == vtkImageDataReaderAttribute(vtkFile, "header_type");
+    vtkTypeInt64 blockStart = static_cast<vtkTypeInt64>(marker) + 1 +
+      arrayOffset;
+    vtkTypeUInt64 blockSize = 0;
+    file.clear();
+    file.seekg(blockStart);
+    if (header64)
+    {
+      file.read(reinterpret_cast<char*>(&blockSize), 8);
+    }
+    else
+    {
+      vtkTypeUInt32 size32 = 0;
+      file.read(reinterpret_cast<char*>(&size32), 4);
+      blockSize = size32;
+    }
+    if (!file || static_cast<vtkTypeUInt64>(bytes) != blockSize)
+    {
+      return false;
+    }
+
+    offset = blockStart + (header64 ? 8 : 4);
+    return true;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Map the voxels of the file read by reader, returning NULL if the file
+  // cannot be mapped
+  vtkSmartPointer<vtkImageData> vtkImageDataReaderMapImage(
+    vtkAlgorithm* reader, const std::string& fileName)
+  {
+    reader->UpdateInformation();
+
+    vtkInformation* info = reader->GetOutputInformation(0);
+    int extent[6];
+    info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    int scalarType = vtkImageData::GetScalarType(info);
+    int components = vtkImageData::GetNumberOfScalarComponents(info);
+
+    vtkSmartPointer<vtkImageData> image =
+      vtkSmartPointer<vtkImageData>::New();
+    image->SetExtent(extent);
+    if (0 == image->GetNumberOfPoints())
+    {
+      return NULL;
+    }
+    vtkTypeInt64 bytes =
+      static_cast<vtkTypeInt64>(image->GetNumberOfPoints()) *
+      components * vtkDataArray::GetDataTypeSize(scalarType);
+
+    std::string dataFile = fileName;
+    vtkTypeInt64 offset = -1;
+    bool located = false;
+    if (reader->IsA("vtkMetaImageReader"))
+    {
+      located = vtkImageDataReaderLocateMetaImage(
+        fileName, bytes, dataFile, offset);
+    }
+    else if (reader->IsA("vtkNIFTIReader"))
+    {
+      // planar multi-component data has to be interleaved by the reader
+      located = 1 == components && vtkImageDataReaderLocateNIFTI(
+        fileName, vtkNIFTIReader::SafeDownCast(reader), offset);
+    }
+    else if (reader->IsA("vtkXMLImageDataReader"))
+    {
+      located = vtkImageDataReaderLocateVTI(fileName, bytes, offset);
+    }
+
+    if (!located || !vtkImageDataReaderMapScalars(
+          dataFile, offset, scalarType, components, image))
+    {
+      return NULL;
+    }
+
+    if (info->Has(vtkDataObject::ORIGIN()))
+    {
+      image->SetOrigin(info->Get(vtkDataObject::ORIGIN()));
+    }
+    if (info->Has(vtkDataObject::SPACING()))
+    {
+      image->SetSpacing(info->Get(vtkDataObject::SPACING()));
+    }
+
+    return image;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetFileName(const char* fileName)
+{
+  std::string fileNameOnly, fileNameStr(fileName ? fileName : "");
+
+  if (this->FileName.empty() && NULL == fileName)
+  {
+    return;
+  }
+
+  if (!this->FileName.empty() &&
+      !fileNameStr.empty() &&
+      (this->FileName == fileNameStr))
+  {
+    return;
+  }
+
+  // delete and set the file name to empty
+  this->FileName.clear();
+  this->SeriesFileNames = NULL;
+  this->StreamedImage = NULL;
+  this->OutputImage = NULL;
+  this->MetaData = NULL;
+  this->CachedOutput = 0;
+  this->AbortExecute = 0;
+
+  if (!fileNameStr.empty())
+  {
+    this->FileName = fileNameStr;
+  }
+
+  // mark the object as modified
+  this->Modified();
+
+  // don't do anything else if the new file name is null
+  if (this->FileName.empty())
+  {
+    return;
+  }
+
+  // make sure FileName exists, throw an exception if it doesn't
+  if (!Birch::Utilities::fileExists(this->FileName))
+  {
+    std::stringstream error;
+    error << "File '" << this->FileName << "' not found.";
+    throw std::runtime_error(error.str());
+  }
+
+  fileNameOnly = Birch::Utilities::getFilenameName(this->FileName);
+
+  // a directory is read as a DICOM series or a numbered image stack
+  if (Birch::Utilities::isDirectory(this->FileName))
+  {
+    vtkNew<vtkDICOMDirectory> directory;
+    directory->SetDirectoryName(this->FileName.c_str());
+    directory->SetScanDepth(0);
+    directory->Update();
+
+    // the directory may hold several series, read the largest
+    vtkStringArray* fileNames = NULL;
+    for (int i = 0; i < directory->GetNumberOfSeries(); ++i)
+    {
+      vtkStringArray* series = directory->GetFileNamesForSeries(i);
+      if (NULL == fileNames ||
+          fileNames->GetNumberOfValues() < series->GetNumberOfValues())
+      {
+        fileNames = series;
+      }
+    }
+    if (fileNames && 0 < fileNames->GetNumberOfValues())
+    {
+      this->SeriesFileNames = vtkSmartPointer<vtkStringArray>::New();
+      this->SeriesFileNames->DeepCopy(fileNames);
+      this->SetReader(vtkSmartPointer<vtkDICOMReader>::New());
+      return;
+    }
+
+    // the stack's slices are read by the reader of its first slice
+    std::vector<std::string> stack =
+      vtkImageDataReaderFindStack(this->FileName);
+    int format = stack.empty() ? -1 : vtkImageDataReaderProbeFile(stack[0]);
+    vtkSmartPointer<vtkAlgorithm> reader;
+    if (-1 != format)
+    {
+      vtkImageDataReaderLock.Lock();
+      vtkImageDataReaderNewFunction newReader =
+        vtkImageDataReaderFormats()[format].NewReader;
+      vtkImageDataReaderLock.Unlock();
+      reader = vtkSmartPointer<vtkAlgorithm>::Take(newReader());
+    }
+    if (NULL == vtkImageReader2::SafeDownCast(reader))
+    {
+      this->SetReader(NULL);
+      std::stringstream error;
+      error << "Unable to read '" << fileNameOnly
+            << "', no DICOM series or numbered image stack found.";
+      throw std::runtime_error(error.str());
+    }
+
+    this->SeriesFileNames = vtkSmartPointer<vtkStringArray>::New();
+    for (size_t i = 0; i < stack.size(); ++i)
+    {
+      this->SeriesFileNames->InsertNextValue(stack[i]);
+    }
+    this->SetReader(reader);
+    return;
+  }
+
+  int format = vtkImageDataReaderProbeFile(this->FileName);
+  if (-1 == format)
+  {
+    // don't know how to handle this file, set the reader to NULL and
+    // mark the file type as unknown
+    this->SetReader(NULL);
+    std::stringstream error;
+    error << "Unable to read '" << fileNameOnly << "', unknown file type.";
+    throw std::runtime_error(error.str());
+  }
+
+  vtkImageDataReaderLock.Lock();
+  vtkImageDataReaderNewFunction newReader =
+    vtkImageDataReaderFormats()[format].NewReader;
+  vtkImageDataReaderLock.Unlock();
+
+  vtkSmartPointer<vtkAlgorithm> reader =
+    vtkSmartPointer<vtkAlgorithm>::Take(newReader());
+  this->SetReader(reader);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool vtkImageDataReader::IsValidFileName(const char* fileName)
+{
+  if (NULL == fileName || !Birch::Utilities::fileExists(fileName))
+  {
+    return false;
+  }
+
+  // a directory is valid if it holds at least one DICOM file or a
+  // numbered image stack
+  if (Birch::Utilities::isDirectory(fileName))
+  {
+    vtkNew<vtkDirectory> directory;
+    if (!directory->Open(fileName))
+    {
+      return false;
+    }
+    std::string path(fileName);
+    path += "/";
+    for (vtkIdType i = 0; i < directory->GetNumberOfFiles(); ++i)
+    {
+      std::string name = path + directory->GetFile(i);
+      if (Birch::Utilities::isDirectory(name))
+      {
+        continue;
+      }
+      int format = vtkImageDataReaderProbeFile(name);
+      if (-1 == format)
+      {
+        continue;
+      }
+      vtkImageDataReaderLock.Lock();
+      bool isDICOM = vtkImageDataReaderNew<vtkDICOMReader> ==
+        vtkImageDataReaderFormats()[format].NewReader;
+      vtkImageDataReaderLock.Unlock();
+      if (isDICOM)
+      {
+        return true;
+      }
+    }
+    return !vtkImageDataReaderFindStack(fileName).empty();
+  }
+
+  return -1 != vtkImageDataReaderProbeFile(fileName);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::GetOutputAsNewInstance()
+{
+  vtkImageData* newImage = NULL;
+  vtkImageData* image = this->GetOutput();
+
+  if (image)
+  {
+    // create a copy of the image sharing its scalars
+    // this copy MUST be deleted by the caller of this method
+    newImage = image->NewInstance();
+    newImage->ShallowCopy(image);
+  }
+
+  return newImage;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// The decoded image cache.  Images read from disk are kept, along with
+// their medical image properties, in a least recently used list keyed by
+// file name, size and modification time, so that reopening an unchanged
+// file does not decode it again.  A directory read as a series or stack is
+// keyed by the sizes and modification times of its member files, since
+// rewriting a slice in place need not change the directory's own.  The
+// cached images share their scalars with the images handed out.  Entries
+// are evicted once the total size of the cached images exceeds the cache
+// size.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  struct vtkImageDataReaderCacheEntry
+  {
+    std::string FileName;
+    std::string Stamp;
+    unsigned long Kibibytes;
+    vtkSmartPointer<vtkImageData> Image;
+    vtkSmartPointer<vtkMedicalImageProperties> Properties;
+    vtkSmartPointer<vtkDICOMMetaData> MetaData;
+  };
+
+  // most recently used first, guarded by vtkImageDataReaderLock
+  std::list<vtkImageDataReaderCacheEntry> vtkImageDataReaderCache;
+  vtkIdType vtkImageDataReaderCacheSize = 512 * 1024;
+  vtkIdType vtkImageDataReaderCacheUsed = 0;
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // The size and modification time of a file, followed by those of each of
+  // a series' files, if any, or an empty stamp if any of them is missing
+  std::string vtkImageDataReaderStamp(
+    const std::string& fileName, vtkStringArray* seriesFileNames)
+  {
+    std::stringstream stamp;
+    struct stat info;
+    if (0 != stat(fileName.c_str(), &info))
+    {
+      return "";
+    }
+    stamp << info.st_size << ":" << info.st_mtime;
+
+    vtkIdType count =
+      seriesFileNames ? seriesFileNames->GetNumberOfValues() : 0;
+    for (vtkIdType i = 0; i < count; ++i)
+    {
+      if (0 != stat(seriesFileNames->GetValue(i).c_str(), &info))
+      {
+        return "";
+      }
+      stamp << " " << info.st_size << ":" << info.st_mtime;
+    }
+    return stamp.str();
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // must be called while holding vtkImageDataReaderLock
+  void vtkImageDataReaderEvict()
+  {
+    while (!vtkImageDataReaderCache.empty() &&
+           vtkImageDataReaderCacheUsed > vtkImageDataReaderCacheSize)
+    {
+      vtkImageDataReaderCacheUsed -= vtkImageDataReaderCache.back().Kibibytes;
+      vtkImageDataReaderCache.pop_back();
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // must be called while holding vtkImageDataReaderLock
+  std::list<vtkImageDataReaderCacheEntry>::iterator vtkImageDataReaderFind(
+    const std::string& fileName)
+  {
+    std::list<vtkImageDataReaderCacheEntry>::iterator it;
+    for (it = vtkImageDataReaderCache.begin();
+         it != vtkImageDataReaderCache.end(); ++it)
+    {
+      if (it->FileName == fileName)
+      {
+        break;
+      }
+    }
+    return it;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetCacheSize(vtkIdType kibibytes)
+{
+  vtkImageDataReaderLock.Lock();
+  vtkImageDataReaderCacheSize = std::max(static_cast<vtkIdType>(0), kibibytes);
+  vtkImageDataReaderEvict();
+  vtkImageDataReaderLock.Unlock();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkIdType vtkImageDataReader::GetCacheSize()
+{
+  vtkImageDataReaderLock.Lock();
+  vtkIdType size = vtkImageDataReaderCacheSize;
+  vtkImageDataReaderLock.Unlock();
+  return size;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::ClearCache()
+{
+  vtkImageDataReaderLock.Lock();
+  vtkImageDataReaderCache.clear();
+  vtkImageDataReaderCacheUsed = 0;
+  vtkImageDataReaderLock.Unlock();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool vtkImageDataReader::FindCachedOutput()
+{
+  std::string stamp =
+    vtkImageDataReaderStamp(this->FileName, this->SeriesFileNames);
+  if (stamp.empty())
+  {
+    return false;
+  }
+
+  bool found = false;
+  vtkImageDataReaderLock.Lock();
+  std::list<vtkImageDataReaderCacheEntry>::iterator it =
+    vtkImageDataReaderFind(this->FileName);
+  if (it != vtkImageDataReaderCache.end())
+  {
+    if (it->Stamp == stamp)
+    {
+      // hand out a copy so that the cached image's geometry is never
+      // changed by its users
+      this->OutputImage = vtkSmartPointer<vtkImageData>::New();
+      this->OutputImage->ShallowCopy(it->Image);
+      this->MedicalImageProperties->DeepCopy(it->Properties);
+      this->MetaData = it->MetaData;
+      vtkImageDataReaderCache.splice(
+        vtkImageDataReaderCache.begin(), vtkImageDataReaderCache, it);
+      found = true;
+    }
+    else
+    {
+      // the file has changed since it was cached
+      vtkImageDataReaderCacheUsed -= it->Kibibytes;
+      vtkImageDataReaderCache.erase(it);
+    }
+  }
+  vtkImageDataReaderLock.Unlock();
+  return found;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::AddCachedOutput(vtkImageData* image)
+{
+  std::string stamp = NULL == image ? std::string() :
+    vtkImageDataReaderStamp(this->FileName, this->SeriesFileNames);
+  if (stamp.empty())
+  {
+    return;
+  }
+
+  vtkImageDataReaderCacheEntry entry;
+  entry.FileName = this->FileName;
+  entry.Stamp = stamp;
+  entry.Kibibytes = image->GetActualMemorySize();
+  entry.Image = vtkSmartPointer<vtkImageData>::New();
+  entry.Image->ShallowCopy(image);
+  entry.Properties = vtkSmartPointer<vtkMedicalImageProperties>::New();
+  entry.Properties->DeepCopy(this->MedicalImageProperties);
+  entry.MetaData = this->MetaData;
+
+  vtkImageDataReaderLock.Lock();
+  std::list<vtkImageDataReaderCacheEntry>::iterator it =
+    vtkImageDataReaderFind(this->FileName);
+  if (it != vtkImageDataReaderCache.end())
+  {
+    vtkImageDataReaderCacheUsed -= it->Kibibytes;
+    vtkImageDataReaderCache.erase(it);
+  }
+  if (static_cast<vtkIdType>(entry.Kibibytes) <= vtkImageDataReaderCacheSize)
+  {
+    vtkImageDataReaderCache.push_front(entry);
+    vtkImageDataReaderCacheUsed += entry.Kibibytes;
+    vtkImageDataReaderEvict();
+  }
+  vtkImageDataReaderLock.Unlock();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// The decoded image disk cache.  Files which are slow to decode, such as
+// compressed DICOM, are written once decoded to an uncompressed MetaImage
+// sidecar in the disk cache directory, along with their medical image
+// properties in a text file of the same name.  Sidecars are named by a
+// hash of the file's path, size and modification time, so a later open of
+// the unchanged file maps the sidecar instead of decoding it again.  A
+// sidecar's modification time records its last use and the least recently
+// used sidecars are deleted once the directory exceeds the disk cache size.
+// The properties name the patient, so the directory and the sidecars are
+// readable by their owner only.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  // guarded by vtkImageDataReaderLock
+  std::string vtkImageDataReaderDiskCacheDirectory;
+  vtkIdType vtkImageDataReaderDiskCacheSize = 4 * 1024 * 1024;
+
+  struct vtkImageDataReaderSidecar
+  {
+    std::string Name;
+    time_t MTime;
+    vtkIdType Kibibytes;
+
+    bool operator<(const vtkImageDataReaderSidecar& rhs) const
+    {
+      return this->MTime < rhs.MTime;
+    }
+  };
+
+  typedef char* (vtkMedicalImageProperties::*vtkImageDataReaderGetter)();
+  typedef void (vtkMedicalImageProperties::*vtkImageDataReaderSetter)(
+    const char*);
+
+  struct vtkImageDataReaderProperty
+  {
+    const char* Name;
+    vtkImageDataReaderGetter Get;
+    vtkImageDataReaderSetter Set;
+  };
+
+#define vtkImageDataReaderPropertyMacro(name) \
+  { #name, &vtkMedicalImageProperties::Get##name, \
+    &vtkMedicalImageProperties::Set##name }
+
+  // the properties kept in a sidecar's text file
+  const vtkImageDataReaderProperty vtkImageDataReaderProperties[] =
+  {
+    vtkImageDataReaderPropertyMacro(PatientName),
+    vtkImageDataReaderPropertyMacro(PatientID),
+    vtkImageDataReaderPropertyMacro(PatientAge),
+    vtkImageDataReaderPropertyMacro(PatientSex),
+    vtkImageDataReaderPropertyMacro(PatientBirthDate),
+    vtkImageDataReaderPropertyMacro(StudyDate),
+    vtkImageDataReaderPropertyMacro(StudyTime),
+    vtkImageDataReaderPropertyMacro(StudyID),
+    vtkImageDataReaderPropertyMacro(StudyDescription),
+    vtkImageDataReaderPropertyMacro(AcquisitionDate),
+    vtkImageDataReaderPropertyMacro(AcquisitionTime),
+    vtkImageDataReaderPropertyMacro(ImageDate),
+    vtkImageDataReaderPropertyMacro(ImageTime),
+    vtkImageDataReaderPropertyMacro(ImageNumber),
+    vtkImageDataReaderPropertyMacro(SeriesNumber),
+    vtkImageDataReaderPropertyMacro(SeriesDescription),
+    vtkImageDataReaderPropertyMacro(Modality),
+    vtkImageDataReaderPropertyMacro(Manufacturer),
+    vtkImageDataReaderPropertyMacro(ManufacturerModelName),
+    vtkImageDataReaderPropertyMacro(StationName),
+    vtkImageDataReaderPropertyMacro(InstitutionName),
+    vtkImageDataReaderPropertyMacro(SliceThickness),
+  };
+
+#undef vtkImageDataReaderPropertyMacro
+
+  // user defined values are kept under this prefix
+  const std::string vtkImageDataReaderUserDefined = "UserDefined.";
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // A key naming a file's sidecar, from a hash of the file's path and its
+  // size and modification time, or an empty key on failure.  The contents
+  // are not hashed, which would read every file twice.
+  std::string vtkImageDataReaderSidecarKey(const std::string& fileName)
+  {
+    struct stat info;
+    if (0 != stat(fileName.c_str(), &info))
+    {
+      return "";
+    }
+
+    // 64 bit FNV-1a
+    vtkTypeUInt64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < fileName.size(); ++i)
+    {
+      hash ^= static_cast<unsigned char>(fileName[i]);
+      hash *= 1099511628211ULL;
+    }
+
+    std::stringstream key;
+    key << std::hex << hash << "-" << info.st_size << "-" << info.st_mtime;
+    return key.str();
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Whether a DICOM file's pixel data is compressed, and so worth a
+  // sidecar: uncompressed pixel data is read about as fast as a sidecar
+  bool vtkImageDataReaderIsCompressed(vtkDICOMMetaData* meta)
+  {
+    if (NULL == meta)
+    {
+      return true;
+    }
+    std::string syntax = meta->GetAttributeValue(
+      vtkDICOMTag(0x0002, 0x0010)).AsString();
+    return !(syntax.empty() ||
+      "1.2.840.10008.1.2" == syntax ||                  // implicit LE
+      "1.2.840.10008.1.2.1" == syntax ||                // explicit LE
+      "1.2.840.10008.1.2.2" == syntax);                 // explicit BE
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Allow only the owner to read a file or directory of the disk cache
+  void vtkImageDataReaderRestrict(const std::string& fileName, bool directory)
+  {
+#ifndef _WIN32
+    chmod(fileName.c_str(), directory ? S_IRWXU : (S_IRUSR | S_IWUSR));
+#else
+    (void)fileName;
+    (void)directory;
+#endif
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataReaderRemoveSidecar(const std::string& sidecar)
+  {
+    std::remove((sidecar + ".mha").c_str());
+    std::remove((sidecar + ".txt").c_str());
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // called without holding vtkImageDataReaderLock, since the directory is
+  // scanned and files removed, with the cache settings copied under it
+  void vtkImageDataReaderDiskEvict(const std::string& path, vtkIdType size)
+  {
+    vtkNew<vtkDirectory> directory;
+    if (path.empty() || !directory->Open(path.c_str()))
+    {
+      return;
+    }
+
+    std::vector<vtkImageDataReaderSidecar> sidecars;
+    vtkIdType used = 0;
+    for (vtkIdType i = 0; i < directory->GetNumberOfFiles(); ++i)
+    {
+      std::string name = directory->GetFile(i);
+      std::string fileName = path + "/" + name;
+      struct stat info;
+      if (".mha" != Birch::Utilities::getFileExtension(name) ||
+          0 != stat(fileName.c_str(), &info))
+      {
+        continue;
+      }
+
+      vtkImageDataReaderSidecar sidecar;
+      sidecar.Name = fileName.substr(0, fileName.size() - 4);
+      sidecar.MTime = info.st_mtime;
+      sidecar.Kibibytes = static_cast<vtkIdType>(info.st_size / 1024);
+      used += sidecar.Kibibytes;
+      sidecars.push_back(sidecar);
+    }
+
+    // least recently used first
+    std::sort(sidecars.begin(), sidecars.end());
+    std::vector<vtkImageDataReaderSidecar>::const_iterator it;
+    for (it = sidecars.begin();
+         it != sidecars.end() && used > size; ++it)
+    {
+      vtkImageDataReaderRemoveSidecar(it->Name);
+      used -= it->Kibibytes;
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataReaderWriteProperties(const std::string& fileName,
+    vtkMedicalImageProperties* properties)
+  {
+    std::ofstream file(fileName.c_str(), std::ios::out | std::ios::trunc);
+    const int count = sizeof(vtkImageDataReaderProperties) /
+      sizeof(vtkImageDataReaderProperty);
+    for (int i = 0; i < count; ++i)
+    {
+      const char* value = (properties->*vtkImageDataReaderProperties[i].Get)();
+      if (value && '\0' != value[0])
+      {
+        file << vtkImageDataReaderProperties[i].Name << "=" << value << "\n";
+      }
+    }
+    for (int i = 0; i < properties->GetNumberOfUserDefinedValues(); ++i)
+    {
+      file << vtkImageDataReaderUserDefined
+           << properties->GetUserDefinedNameByIndex(i) << "="
+           << properties->GetUserDefinedValueByIndex(i) << "\n";
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataReaderReadProperties(const std::string& fileName,
+    vtkMedicalImageProperties* properties)
+  {
+    std::ifstream file(fileName.c_str(), std::ios::in);
+    std::string line;
+    const int count = sizeof(vtkImageDataReaderProperties) /
+      sizeof(vtkImageDataReaderProperty);
+    properties->Clear();
+    while (std::getline(file, line))
+    {
+      size_t pos = line.find('=');
+      if (std::string::npos == pos)
+      {
+        continue;
+      }
+      std::string name = line.substr(0, pos);
+      std::string value = line.substr(pos + 1);
+      if (0 == name.find(vtkImageDataReaderUserDefined))
+      {
+        name = name.substr(vtkImageDataReaderUserDefined.size());
+        properties->AddUserDefinedValue(name.c_str(), value.c_str());
+        continue;
+      }
+      for (int i = 0; i < count; ++i)
+      {
+        if (name == vtkImageDataReaderProperties[i].Name)
+        {
+          (properties->*vtkImageDataReaderProperties[i].Set)(value.c_str());
+        }
+      }
+    }
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetDiskCacheDirectory(const std::string& path)
+{
+  vtkImageDataReaderLock.Lock();
+  vtkImageDataReaderDiskCacheDirectory = path;
+  vtkImageDataReaderLock.Unlock();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+std::string vtkImageDataReader::GetDiskCacheDirectory()
+{
+  vtkImageDataReaderLock.Lock();
+  std::string path = vtkImageDataReaderDiskCacheDirectory;
+  vtkImageDataReaderLock.Unlock();
+  return path;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkIdType vtkImageDataReader::GetDiskCacheSize()
+{
+  vtkImageDataReaderLock.Lock();
+  vtkIdType size = vtkImageDataReaderDiskCacheSize;
+  vtkImageDataReaderLock.Unlock();
+  return size;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool vtkImageDataReader::FindDiskCachedOutput()
+{
+  this->DiskCacheKey.clear();
+
+  vtkImageDataReaderLock.Lock();
+  std::string directory = vtkImageDataReaderDiskCacheDirectory;
+  vtkIdType size = vtkImageDataReaderDiskCacheSize;
+  vtkImageDataReaderLock.Unlock();
+
+  // only single files which are slow to decode are given a sidecar
+  if (directory.empty() || 0 == size || this->SeriesFileNames ||
+      !(this->Reader->IsA("vtkDICOMReader") ||
+        this->Reader->IsA("vtkGDCMImageReader")))
+  {
+    return false;
+  }
+
+  this->DiskCacheKey = vtkImageDataReaderSidecarKey(this->FileName);
+  std::string sidecar = directory + "/" + this->DiskCacheKey;
+  if (this->DiskCacheKey.empty() ||
+      !Birch::Utilities::fileExists(sidecar + ".mha"))
+  {
+    return false;
+  }
+
+  vtkNew<vtkMetaImageReader> reader;
+  reader->SetFileName((sidecar + ".mha").c_str());
+  vtkSmartPointer<vtkImageData> image;
+  if (this->MemoryMapping)
+  {
+    image = vtkImageDataReaderMapImage(reader.GetPointer(), sidecar + ".mha");
+  }
+  if (!image)
+  {
+    reader->Update();
+    image = reader->GetOutput();
+  }
+
+  // a damaged sidecar is removed and the file decoded again
+  if (!image || 0 == image->GetNumberOfCells())
+  {
+    vtkImageDataReaderRemoveSidecar(sidecar);
+    return false;
+  }
+
+  vtkImageDataReaderReadProperties(
+    sidecar + ".txt", this->MedicalImageProperties);
+  this->MetaData = vtkImageDataReaderParseHeader(this->FileName);
+  utime((sidecar + ".mha").c_str(), NULL);
+  this->OutputImage = image;
+  return true;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Sidecars are written on threads of their own, so that a newly decoded
+// image reaches the display without waiting for its sidecar, and the cache
+// is trimmed on one when its size is set.  Finished threads are joined
+// when the next job starts and any still running when the program exits
+// are waited for.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  struct vtkImageDataReaderSidecarJob
+  {
+    std::string Directory;
+    std::string Sidecar;
+    vtkIdType Size;
+    vtkSmartPointer<vtkImageData> Image;
+    vtkSmartPointer<vtkMedicalImageProperties> Properties;
+    int ThreadId;
+    bool Done;                           // guarded by vtkImageDataReaderLock
+  };
+
+  class vtkImageDataReaderSidecarWriters
+  {
+    public:
+      vtkImageDataReaderSidecarWriters() : Threader(NULL) {}
+      ~vtkImageDataReaderSidecarWriters() { this->Join(false); }
+
+      // join the finished threads, or all of them, which must be done
+      // without holding vtkImageDataReaderLock
+      void Join(bool finishedOnly)
+      {
+        std::list<vtkImageDataReaderSidecarJob*> joined;
+        vtkImageDataReaderLock.Lock();
+        std::list<vtkImageDataReaderSidecarJob*>::iterator it =
+          this->Jobs.begin();
+        while (it != this->Jobs.end())
+        {
+          if (!finishedOnly || (*it)->Done)
+          {
+            joined.push_back(*it);
+            it = this->Jobs.erase(it);
+          }
+          else
+          {
+            ++it;
+          }
+        }
+        vtkImageDataReaderLock.Unlock();
+
+        for (it = joined.begin(); it != joined.end(); ++it)
+        {
+          this->Threader->TerminateThread((*it)->ThreadId);
+          delete *it;
+        }
+        if (!finishedOnly && this->Threader)
+        {
+          this->Threader->Delete();
+          this->Threader = NULL;
+        }
+      }
+
+      std::list<vtkImageDataReaderSidecarJob*> Jobs;
+      vtkMultiThreader* Threader;
+  };
+
+  vtkImageDataReaderSidecarWriters vtkImageDataReaderSidecarWriter;
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataReaderWriteSidecar(void* arg)
+  {
+    vtkImageDataReaderSidecarJob* job =
+      static_cast<vtkImageDataReaderSidecarJob*>(
+        static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+
+    // a job without an image only trims the cache to its size
+    if (!job->Image)
+    {
+      vtkImageDataReaderDiskEvict(job->Directory, job->Size);
+      vtkImageDataReaderLock.Lock();
+      job->Done = true;
+      vtkImageDataReaderLock.Unlock();
+      return VTK_THREAD_RETURN_VALUE;
+    }
+
+    // both files are written under temporary names and renamed once
+    // complete, the properties first since the image marks a sidecar as
+    // present
+    const std::string& sidecar = job->Sidecar;
+    std::string partial = sidecar + ".partial";
+    vtkImageDataReaderWriteProperties(partial + ".txt", job->Properties);
+    vtkImageDataReaderRestrict(partial + ".txt", false);
+    bool success =
+      0 == std::rename((partial + ".txt").c_str(), (sidecar + ".txt").c_str());
+    if (success)
+    {
+      vtkNew<vtkMetaImageWriter> writer;
+      writer->SetCompression(false);
+      writer->SetFileName((partial + ".mha").c_str());
+      writer->SetInputData(job->Image);
+      writer->Write();
+      vtkImageDataReaderRestrict(partial + ".mha", false);
+      success = 0 ==
+        std::rename((partial + ".mha").c_str(), (sidecar + ".mha").c_str());
+    }
+    if (success)
+    {
+      vtkImageDataReaderDiskEvict(job->Directory, job->Size);
+    }
+    else
+    {
+      std::remove((partial + ".txt").c_str());
+      std::remove((partial + ".mha").c_str());
+      vtkImageDataReaderRemoveSidecar(sidecar);
+    }
+
+    // the scalars are shared with the displayed image, let them go now
+    job->Image = NULL;
+    vtkImageDataReaderLock.Lock();
+    job->Done = true;
+    vtkImageDataReaderLock.Unlock();
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Run a sidecar job on a thread of its own, which owns the job from
+  // then on.  Called without holding vtkImageDataReaderLock.
+  void vtkImageDataReaderStartSidecarJob(vtkImageDataReaderSidecarJob* job)
+  {
+    vtkImageDataReaderSidecarWriters& writers =
+      vtkImageDataReaderSidecarWriter;
+    writers.Join(true);
+    if (NULL == writers.Threader)
+    {
+      writers.Threader = vtkMultiThreader::New();
+    }
+    job->Done = false;
+
+    // the job is listed before the thread can mark it done
+    vtkImageDataReaderLock.Lock();
+    job->ThreadId =
+      writers.Threader->SpawnThread(vtkImageDataReaderWriteSidecar, job);
+    if (0 > job->ThreadId)
+    {
+      // no thread to spare, the job is simply dropped
+      vtkImageDataReaderLock.Unlock();
+      delete job;
+      return;
+    }
+    writers.Jobs.push_back(job);
+    vtkImageDataReaderLock.Unlock();
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetDiskCacheSize(vtkIdType kibibytes)
+{
+  vtkImageDataReaderLock.Lock();
+  vtkImageDataReaderDiskCacheSize =
+    std::max(static_cast<vtkIdType>(0), kibibytes);
+  std::string directory = vtkImageDataReaderDiskCacheDirectory;
+  vtkIdType size = vtkImageDataReaderDiskCacheSize;
+  vtkImageDataReaderLock.Unlock();
+  if (directory.empty())
+  {
+    return;
+  }
+
+  // scanning the directory may take a while, so it is trimmed on a thread
+  // of its own
+  vtkImageDataReaderSidecarJob* job = new vtkImageDataReaderSidecarJob;
+  job->Directory = directory;
+  job->Size = size;
+  vtkImageDataReaderStartSidecarJob(job);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::AddDiskCachedOutput(vtkImageData* image)
+{
+  if (this->DiskCacheKey.empty() || NULL == image || this->AbortExecute)
+  {
+    return;
+  }
+
+  vtkImageDataReaderLock.Lock();
+  std::string directory = vtkImageDataReaderDiskCacheDirectory;
+  vtkIdType size = vtkImageDataReaderDiskCacheSize;
+  vtkImageDataReaderLock.Unlock();
+  if (directory.empty() || size < image->GetActualMemorySize() ||
+      !vtkImageDataReaderIsCompressed(this->MetaData))
+  {
+    return;
+  }
+  vtkDirectory::MakeDirectory(directory.c_str());
+  vtkImageDataReaderRestrict(directory, true);
+
+  // the thread writes a snapshot sharing the image's scalars
+  vtkImageDataReaderSidecarJob* job = new vtkImageDataReaderSidecarJob;
+  job->Directory = directory;
+  job->Sidecar = directory + "/" + this->DiskCacheKey;
+  job->Size = size;
+  job->Image = vtkSmartPointer<vtkImageData>::New();
+  job->Image->ShallowCopy(image);
+  job->Properties = vtkSmartPointer<vtkMedicalImageProperties>::New();
+  job->Properties->DeepCopy(this->MedicalImageProperties);
+  vtkImageDataReaderStartSidecarJob(job);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::GetOutput()
+{
+  vtkXMLImageDataReader* XMLReader = NULL;
+  vtkGDCMImageReader* gdcmReader = NULL;
+  vtkImageReader2* imageReader = NULL;
+  vtkImageData* image = NULL;
+
+  // if the file name or reader are null simply return null
+  if (this->FileName.empty() || NULL == this->Reader)
+  {
+    return NULL;
+  }
+
+  // an unchanged file decoded before may still be in the memory or disk
+  // cache
+  bool upToDate = this->ReadMTime >= this->GetMTime();
+  if (!upToDate)
+  {
+    this->MetaData = NULL;
+    this->CachedOutput =
+      this->FindCachedOutput() || this->FindDiskCachedOutput();
+    if (this->CachedOutput)
+    {
+      this->ReadMTime.Modified();
+    }
+  }
+  if (this->CachedOutput)
+  {
+    return this->OutputImage;
+  }
+
+  // Ok, we have a valid file and reader, process based on reader type
+  if (this->Reader->IsA("vtkXMLImageDataReader"))
+  {
+    // we know that Reader must be a vtkXMLImageDataReader object
+    XMLReader = vtkXMLImageDataReader::SafeDownCast(this->Reader);
+
+    // see if we have already read the data from the disk
+    // and return it if we have
+    if (this->ReadMTime >= this->GetMTime())
+    {
+      image = this->OutputImage ? this->OutputImage.GetPointer() :
+        this->StreamedImage ? this->StreamedImage.GetPointer() :
+        XMLReader->GetOutput();
+    }
+    else  // this reader is not up to date, re-read the file
+    {
+      // the file was identified as readable by SetFileName
+      this->SetReaderFileName();
+
+      // get a reference to the (updated) output image
+      if (this->MemoryMapping)
+      {
+        image = this->MapOutput();
+      }
+      if (image)
+      {
+        // the voxels are mapped from the file, nothing to read
+      }
+      else if (0 < this->StreamingSlabSize)
+      {
+        image = this->StreamOutput();
+      }
+      else
+      {
+        this->UpdateReader();
+        image = XMLReader->GetOutput();
+      }
+    }
+  }
+  else  // if we get here then the reader is some form of vtkImageReader2
+  {
+    // we know that Reader must be a vtkImageReader2 object
+    imageReader = vtkImageReader2::SafeDownCast(this->Reader);
+
+    // if this reader is not up to date, re-read the file
+    if (this->ReadMTime >= this->GetMTime())
+    {
+      image = this->OutputImage ? this->OutputImage.GetPointer() :
+        this->StreamedImage ? this->StreamedImage.GetPointer() :
+        imageReader->GetOutput();
+    }
+    else
+    {
+      // the file was identified as readable by SetFileName
+      this->SetReaderFileName();
+
+      // get a reference to the (updated) output image
+      if (this->MemoryMapping)
+      {
+        image = this->MapOutput();
+      }
+      if (!image && this->SeriesFileNames)
+      {
+        image = this->Reader->IsA("vtkDICOMReader") ?
+          this->ReadSeries() : this->ReadStack();
+      }
+      else if (!image && this->Reader->IsA("vtkDICOMReader"))
+      {
+        image = this->ReadFrames();
+      }
+      if (image || this->AbortExecute)
+      {
+        // the voxels were mapped from the file or decoded in parallel
+      }
+      else if (0 < this->StreamingSlabSize)
+      {
+        image = this->StreamOutput();
+      }
+      else
+      {
+        this->UpdateReader();
+        image = imageReader->GetOutput();
+      }
+    }
+  }
+
+  // if we did get an image, check that it has valid extents:
+  // GetNumberOfCells is zero for invalid vtkImageData Extents
+  if (image)
+  {
+    vtkIdType nCells = image->GetNumberOfCells();
+    if (nCells == 0)
+    {
+      return NULL;
+    }
+  }
+
+  this->UpdateMedicalImageProperties();
+  this->ReadMTime.Modified();
+
+  // mapped images are cheap to open again and are not cached, nor are
+  // images whose read was aborted
+  if (!upToDate && image && image != this->OutputImage.GetPointer() &&
+      !this->AbortExecute)
+  {
+    this->AddCachedOutput(image);
+    this->AddDiskCachedOutput(image);
+  }
+  return image;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkAlgorithmOutput* vtkImageDataReader::GetOutputPort()
+{
+  // if the file name or reader are null simply return null
+  if (this->FileName.empty() || NULL == this->Reader)
+  {
+    return NULL;
+  }
+
+  // only the header is read here, the pixel data is read by whichever
+  // extent the downstream consumers request
+  this->SetReaderFileName();
+  this->Reader->UpdateInformation();
+
+  int extent[6];
+  this->Reader->GetOutputInformation(0)->Get(
+    vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] > extent[5])
+  {
+    return NULL;
+  }
+
+  this->UpdateMedicalImageProperties();
+  return this->Reader->GetOutputPort();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::UpdateMedicalImageProperties()
+{
+  this->MedicalImageProperties->Clear();
+  if (this->Reader->IsA("vtkGESignaReader"))
+  {
+    vtkGESignaReader* imageReader =
+      vtkGESignaReader::SafeDownCast(this->Reader);
+    this->MedicalImageProperties->DeepCopy(
+      imageReader->GetMedicalImageProperties());
+  }
+  else if (this->Reader->IsA("vtkDICOMReader"))
+  {
+    vtkDICOMReader* imageReader =
+      vtkDICOMReader::SafeDownCast(this->Reader);
+    this->MedicalImageProperties->DeepCopy(
+      imageReader->GetMedicalImageProperties());
+
+    // the reader parsed the headers when it read the file, the copy
+    // outlives the reader's next read
+    this->MetaData = vtkSmartPointer<vtkDICOMMetaData>::New();
+    this->MetaData->ShallowCopy(imageReader->GetMetaData());
+  }
+  else if (this->Reader->IsA("vtkGDCMImageReader"))
+  {
+    vtkGDCMImageReader* imageReader =
+      vtkGDCMImageReader::SafeDownCast(this->Reader);
+    this->MedicalImageProperties->DeepCopy(
+      imageReader->GetMedicalImageProperties());
+
+    // the pixel data has already been read by the reader, so the header
+    // is parsed once, up to the pixel data
+    if (!this->MetaData)
+    {
+      this->MetaData = vtkImageDataReaderParseHeader(this->FileName);
+    }
+  }
+
+  if (this->MetaData)
+  {
+    std::map<std::string, vtkDICOMTag> dicomMap;
+    dicomMap["AcquisitionDateTime"] = vtkDICOMTag(0x0008, 0x002a);
+    dicomMap["SeriesNumber"] = vtkDICOMTag(0x0020, 0x0011);
+    dicomMap["CineRate"] = vtkDICOMTag(0x0018, 0x0040);
+    dicomMap["RecommendedDisplayFrameRate"] = vtkDICOMTag(0x0008, 0x2114);
 
     for (auto it = dicomMap.cbegin(); it != dicomMap.cend(); ++it)
     {
-      if (ds.FindDataElement(it->second))
+      if (this->MetaData->HasAttribute(it->second))
       {
         std::string name = it->first;
         std::string value =
-          gdcm::DirectoryHelper::GetStringValueFromTag(it->second, ds);
+          this->MetaData->GetAttributeValue(it->second).AsString();
         if (!value.empty())
         {
           value = Birch::Utilities::trim(value);
@@ -565,9 +2075,741 @@ vtkImageData* vtkImageDataReader::GetOutput()
       }
     }
   }
+}
 
-  this->ReadMTime.Modified();
-  return image;
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::SetReaderFileName()
+{
+  if (this->Reader->IsA("vtkXMLImageDataReader"))
+  {
+    vtkXMLImageDataReader::SafeDownCast(this->Reader)->SetFileName(
+      this->FileName.c_str());
+  }
+  else if (this->SeriesFileNames)
+  {
+    vtkImageReader2::SafeDownCast(this->Reader)->SetFileNames(
+      this->SeriesFileNames);
+  }
+  else
+  {
+    vtkImageReader2::SafeDownCast(this->Reader)->SetFileName(
+      this->FileName.c_str());
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataReader::UpdateReader()
+{
+  // report the reader's progress as our own
+  vtkNew<vtkEventForwarderCommand> forward;
+  forward->SetTarget(this);
+  unsigned long startTag =
+    this->Reader->AddObserver(vtkCommand::StartEvent, forward.GetPointer());
+  unsigned long progressTag =
+    this->Reader->AddObserver(vtkCommand::ProgressEvent, forward.GetPointer());
+  unsigned long endTag =
+    this->Reader->AddObserver(vtkCommand::EndEvent, forward.GetPointer());
+
+  this->Reader->Update();
+
+  this->Reader->RemoveObserver(startTag);
+  this->Reader->RemoveObserver(progressTag);
+  this->Reader->RemoveObserver(endTag);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::MapOutput()
+{
+  this->OutputImage = vtkImageDataReaderMapImage(this->Reader, this->FileName);
+  return this->OutputImage;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::StreamOutput()
+{
+  this->StreamedImage = NULL;
+  this->Reader->UpdateInformation();
+
+  int wholeExtent[6];
+  this->Reader->GetOutputInformation(0)->Get(
+    vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  if (wholeExtent[4] > wholeExtent[5])
+  {
+    return NULL;
+  }
+
+  this->InvokeEvent(vtkCommand::StartEvent);
+
+  int extent[6];
+  std::copy(wholeExtent, wholeExtent + 6, extent);
+  int numberOfSlices = wholeExtent[5] - wholeExtent[4] + 1;
+  int slices = 0;
+  vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+  while (slices < numberOfSlices && !this->AbortExecute)
+  {
+    extent[4] = wholeExtent[4] + slices;
+    extent[5] = std::min(extent[4] + this->StreamingSlabSize - 1,
+      wholeExtent[5]);
+    vtkImageDataReaderUpdateExtent(this->Reader, extent);
+
+    vtkImageData* slab =
+      vtkImageData::SafeDownCast(this->Reader->GetOutputDataObject(0));
+    if (NULL == slab || NULL == slab->GetPointData()->GetScalars())
+    {
+      return NULL;
+    }
+
+    int* slabExtent = slab->GetExtent();
+    if (0 == slices)
+    {
+      if (slabExtent[4] <= wholeExtent[4] && slabExtent[5] >= wholeExtent[5])
+      {
+        // the reader ignored the requested extent and read everything
+        volume->ShallowCopy(slab);
+        slices = numberOfSlices;
+      }
+      else
+      {
+        // allocate the volume, using zero as the placeholder for the
+        // slices that have yet to be read
+        volume->SetExtent(wholeExtent);
+        volume->SetSpacing(slab->GetSpacing());
+        volume->SetOrigin(slab->GetOrigin());
+        volume->AllocateScalars(
+          slab->GetScalarType(), slab->GetNumberOfScalarComponents());
+        volume->GetPointData()->GetScalars()->SetName(
+          slab->GetPointData()->GetScalars()->GetName());
+        memset(volume->GetScalarPointer(), 0,
+          volume->GetNumberOfPoints() * volume->GetScalarSize() *
+          volume->GetNumberOfScalarComponents());
+      }
+      this->StreamedImage = volume;
+    }
+
+    if (slices < numberOfSlices)
+    {
+      volume->CopyAndCastFrom(slab, extent);
+      slices = extent[5] - wholeExtent[4] + 1;
+    }
+
+    this->InvokeEvent(Birch::Common::SlicesLoadedEvent, &slices);
+    double progress = static_cast<double>(slices) / numberOfSlices;
+    this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+  }
+
+  this->InvokeEvent(vtkCommand::EndEvent);
+
+  return this->AbortExecute ? NULL : volume.GetPointer();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Parallel slice decoding.  DICOM series, numbered image stacks and
+// compressed multi-frame files are decoded by a pool of threads straight
+// into a preallocated volume.
+// Each thread takes the next few slices in order, decodes them and copies
+// them into place; progress is reported as slices complete and, when
+// streaming, the run of slices loaded from the first one on is reported
+// with a SlicesLoadedEvent so that they can be displayed early.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  struct vtkImageDataReaderJob;
+  typedef bool (*vtkImageDataReaderDecodeFunction)(
+    vtkImageDataReaderJob* job, int first, int count);
+
+  struct vtkImageDataReaderJob
+  {
+    vtkImageDataReader* Self;
+    vtkImageData* Volume;
+    vtkImageDataReaderDecodeFunction Decode;
+    int NumberOfSlices;
+    int ChunkSize;
+    int NextSlice;
+    int LoadedSlices;                    // contiguous from the first slice
+    int DecodedSlices;
+    bool Failed;
+    std::vector<bool> Decoded;
+    vtkSimpleCriticalSection Lock;
+
+    // series and stacks: the reader and one file name per slice
+    vtkDICOMReader* Reader;
+    vtkImageReader2* StackReader;
+    std::vector<std::string> FileNames;
+
+    // frames: one compressed fragment per frame and the frame of each slice
+    const gdcm::SequenceOfFragments* Fragments;
+    gdcm::TransferSyntax TransferSyntax;
+    gdcm::PixelFormat PixelFormat;
+    gdcm::PhotometricInterpretation Photometric;
+    unsigned int PlanarConfiguration;
+    unsigned int Dimensions[3];
+    std::vector<int> Frames;
+    bool FlipRows;
+    bool ConvertYBR;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataReaderDecodeSeries(vtkImageDataReaderJob* job,
+    int first, int count)
+  {
+    vtkNew<vtkStringArray> fileNames;
+    for (int i = first; i < first + count; ++i)
+    {
+      fileNames->InsertNextValue(job->FileNames[i]);
+    }
+
+    // keep the given order and decode as the series reader would
+    vtkNew<vtkDICOMReader> reader;
+    reader->SortingOff();
+    reader->SetMemoryRowOrder(job->Reader->GetMemoryRowOrder());
+    reader->SetAutoRescale(job->Reader->GetAutoRescale());
+    reader->SetFileNames(fileNames.GetPointer());
+    reader->Update();
+
+    vtkImageData* decoded = reader->GetOutput();
+    int* extent = decoded->GetExtent();
+    int* wholeExtent = job->Volume->GetExtent();
+    if (NULL == decoded->GetPointData()->GetScalars() ||
+        extent[1] - extent[0] != wholeExtent[1] - wholeExtent[0] ||
+        extent[3] - extent[2] != wholeExtent[3] - wholeExtent[2] ||
+        extent[5] - extent[4] + 1 != count ||
+        decoded->GetNumberOfScalarComponents() !=
+          job->Volume->GetNumberOfScalarComponents())
+    {
+      return false;
+    }
+
+    // relabel the slab with the extent it occupies in the volume
+    vtkNew<vtkImageData> slab;
+    slab->ShallowCopy(decoded);
+    slab->SetExtent(wholeExtent[0], wholeExtent[1],
+      wholeExtent[2], wholeExtent[3],
+      wholeExtent[4] + first, wholeExtent[4] + first + count - 1);
+    job->Volume->CopyAndCastFrom(slab.GetPointer(), slab->GetExtent());
+    return true;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataReaderDecodeStack(vtkImageDataReaderJob* job,
+    int first, int count)
+  {
+    int* wholeExtent = job->Volume->GetExtent();
+    for (int slice = first; slice < first + count; ++slice)
+    {
+      vtkSmartPointer<vtkImageReader2> reader =
+        vtkSmartPointer<vtkImageReader2>::Take(
+          job->StackReader->NewInstance());
+      reader->SetFileName(job->FileNames[slice].c_str());
+      reader->Update();
+
+      // every slice must match the first in size and type
+      vtkImageData* decoded = reader->GetOutput();
+      int* extent = decoded->GetExtent();
+      if (NULL == decoded->GetPointData()->GetScalars() ||
+          extent[1] - extent[0] != wholeExtent[1] - wholeExtent[0] ||
+          extent[3] - extent[2] != wholeExtent[3] - wholeExtent[2] ||
+          extent[5] != extent[4] ||
+          decoded->GetScalarType() != job->Volume->GetScalarType() ||
+          decoded->GetNumberOfScalarComponents() !=
+            job->Volume->GetNumberOfScalarComponents())
+      {
+        return false;
+      }
+
+      vtkNew<vtkImageData> image;
+      image->ShallowCopy(decoded);
+      image->SetExtent(wholeExtent[0], wholeExtent[1],
+        wholeExtent[2], wholeExtent[3],
+        wholeExtent[4] + slice, wholeExtent[4] + slice);
+      job->Volume->CopyAndCastFrom(image.GetPointer(), image->GetExtent());
+    }
+    return true;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Convert a row of 8-bit full range YCbCr pixels to RGB, as the DICOM
+  // reader does for YBR_FULL and YBR_FULL_422 images
+  void vtkImageDataReaderYBRToRGB(const unsigned char* source,
+    unsigned char* target, size_t numberOfPixels)
+  {
+    for (size_t i = 0; i < numberOfPixels; ++i, source += 3, target += 3)
+    {
+      double y = source[0];
+      double cb = source[1] - 128.0;
+      double cr = source[2] - 128.0;
+      double rgb[3] = {
+        y + 1.402 * cr,
+        y - 0.344136 * cb - 0.714136 * cr,
+        y + 1.772 * cb };
+      for (int j = 0; j < 3; ++j)
+      {
+        double value = rgb[j] + 0.5;
+        target[j] = static_cast<unsigned char>(
+          value < 0.0 ? 0.0 : value > 255.0 ? 255.0 : value);
+      }
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataReaderDecodeFrames(vtkImageDataReaderJob* job,
+    int first, int count)
+  {
+    gdcm::JPEGCodec jpeg;
+    gdcm::JPEGLSCodec jpegls;
+    gdcm::JPEG2000Codec jpeg2000;
+    gdcm::ImageCodec* codec =
+      jpeg.CanDecode(job->TransferSyntax) ? &jpeg :
+      jpegls.CanDecode(job->TransferSyntax) ? &jpegls :
+      jpeg2000.CanDecode(job->TransferSyntax) ?
+        static_cast<gdcm::ImageCodec*>(&jpeg2000) : NULL;
+    if (NULL == codec)
+    {
+      return false;
+    }
+
+    int* wholeExtent = job->Volume->GetExtent();
+    int rows = wholeExtent[3] - wholeExtent[2] + 1;
+    size_t columns = wholeExtent[1] - wholeExtent[0] + 1;
+    size_t rowBytes = columns *
+      job->Volume->GetNumberOfScalarComponents() *
+      job->Volume->GetScalarSize();
+
+    for (int slice = first; slice < first + count; ++slice)
+    {
+      // decode the frame's fragment on its own, as a single frame image
+      gdcm::SmartPointer<gdcm::SequenceOfFragments> fragments =
+        new gdcm::SequenceOfFragments;
+      fragments->AddFragment(job->Fragments->GetFragment(job->Frames[slice]));
+      gdcm::DataElement pixelData(gdcm::Tag(0x7fe0, 0x0010));
+      pixelData.SetVLToUndefined();
+      pixelData.SetValue(*fragments);
+
+      codec->SetDimensions(job->Dimensions);
+      codec->SetNumberOfDimensions(2);
+      codec->SetPixelFormat(job->PixelFormat);
+      codec->SetPhotometricInterpretation(job->Photometric);
+      codec->SetPlanarConfiguration(job->PlanarConfiguration);
+
+      gdcm::DataElement frame;
+      if (!codec->Decode(pixelData, frame))
+      {
+        return false;
+      }
+      const gdcm::ByteValue* bytes = frame.GetByteValue();
+      if (NULL == bytes || bytes->GetLength() < rowBytes * rows)
+      {
+        return false;
+      }
+
+      // JPEG decoders may hand back YBR_FULL (upsampled from 4:2:2) or
+      // already convert to RGB; JPEG 2000 undoes YBR_RCT and YBR_ICT itself
+      gdcm::PhotometricInterpretation::PIType decoded =
+        codec->GetPhotometricInterpretation();
+      bool ybr = job->ConvertYBR &&
+        (gdcm::PhotometricInterpretation::YBR_FULL == decoded ||
+         gdcm::PhotometricInterpretation::YBR_FULL_422 == decoded);
+      if (job->ConvertYBR && !ybr &&
+          gdcm::PhotometricInterpretation::RGB != decoded &&
+          gdcm::PhotometricInterpretation::YBR_RCT != decoded &&
+          gdcm::PhotometricInterpretation::YBR_ICT != decoded)
+      {
+        return false;
+      }
+
+      const char* source = bytes->GetPointer();
+      for (int row = 0; row < rows; ++row)
+      {
+        int j = wholeExtent[2] + (job->FlipRows ? rows - 1 - row : row);
+        void* target = job->Volume->GetScalarPointer(wholeExtent[0], j,
+          wholeExtent[4] + slice);
+        if (ybr)
+        {
+          vtkImageDataReaderYBRToRGB(
+            reinterpret_cast<const unsigned char*>(source + row * rowBytes),
+            static_cast<unsigned char*>(target), columns);
+        }
+        else
+        {
+          memcpy(target, source + row * rowBytes, rowBytes);
+        }
+      }
+    }
+    return true;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataReaderJobThread(void* arg)
+  {
+    vtkImageDataReaderJob* job = static_cast<vtkImageDataReaderJob*>(
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg)->UserData);
+
+    while (true)
+    {
+      job->Lock.Lock();
+      int first = job->NextSlice;
+      job->NextSlice += job->ChunkSize;
+      bool stop = job->Failed || job->Self->GetAbortExecute();
+      job->Lock.Unlock();
+      if (stop || first >= job->NumberOfSlices)
+      {
+        break;
+      }
+
+      int count = std::min(job->ChunkSize, job->NumberOfSlices - first);
+      bool success = job->Decode(job, first, count);
+
+      // events are invoked by one thread at a time
+      job->Lock.Lock();
+      if (!success)
+      {
+        job->Failed = true;
+      }
+      else
+      {
+        for (int i = first; i < first + count; ++i)
+        {
+          job->Decoded[i] = true;
+        }
+        job->DecodedSlices += count;
+        int loaded = job->LoadedSlices;
+        while (loaded < job->NumberOfSlices && job->Decoded[loaded])
+        {
+          ++loaded;
+        }
+
+        double progress =
+          static_cast<double>(job->DecodedSlices) / job->NumberOfSlices;
+        job->Self->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+        if (loaded > job->LoadedSlices)
+        {
+          job->LoadedSlices = loaded;
+          if (0 < job->Self->GetStreamingSlabSize())
+          {
+            job->Self->InvokeEvent(Birch::Common::SlicesLoadedEvent, &loaded);
+          }
+        }
+      }
+      job->Lock.Unlock();
+    }
+
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Allocate the volume described by the reader's output information
+  vtkSmartPointer<vtkImageData> vtkImageDataReaderAllocate(
+    vtkInformation* info)
+  {
+    vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+    volume->SetExtent(
+      info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()));
+    volume->SetOrigin(info->Get(vtkDataObject::ORIGIN()));
+    volume->SetSpacing(info->Get(vtkDataObject::SPACING()));
+    volume->AllocateScalars(vtkImageData::GetScalarType(info),
+      vtkImageData::GetNumberOfScalarComponents(info));
+    return volume;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Decode all of the job's slices, returns false on failure or abort
+  bool vtkImageDataReaderRunJob(vtkImageDataReaderJob* job, int chunkSize)
+  {
+    int numberOfThreads = std::min(
+      vtkMultiThreader::GetGlobalDefaultNumberOfThreads(),
+      job->NumberOfSlices);
+    job->ChunkSize = chunkSize;
+    job->NextSlice = 0;
+    job->LoadedSlices = 0;
+    job->DecodedSlices = 0;
+    job->Failed = false;
+    job->Decoded.assign(job->NumberOfSlices, false);
+
+    job->Self->InvokeEvent(vtkCommand::StartEvent);
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(vtkImageDataReaderJobThread, job);
+    threader->SingleMethodExecute();
+    job->Self->InvokeEvent(vtkCommand::EndEvent);
+
+    return !job->Failed && !job->Self->GetAbortExecute();
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::ReadSeries()
+{
+  vtkDICOMReader* reader = vtkDICOMReader::SafeDownCast(this->Reader);
+  this->StreamedImage = NULL;
+  if (NULL == reader)
+  {
+    return NULL;
+  }
+  reader->UpdateInformation();
+
+  // only series of single frame files, one per slice, are decoded here
+  vtkInformation* info = reader->GetOutputInformation(0);
+  int wholeExtent[6];
+  info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  int numberOfSlices = wholeExtent[5] - wholeExtent[4] + 1;
+  vtkIntArray* fileIndex = reader->GetFileIndexArray();
+  vtkIntArray* frameIndex = reader->GetFrameIndexArray();
+  if (2 > numberOfSlices || NULL == fileIndex || NULL == frameIndex ||
+      1 != fileIndex->GetNumberOfComponents() ||
+      numberOfSlices != fileIndex->GetNumberOfTuples())
+  {
+    return NULL;
+  }
+
+  vtkImageDataReaderJob job;
+  job.Self = this;
+  job.Decode = vtkImageDataReaderDecodeSeries;
+  job.NumberOfSlices = numberOfSlices;
+  job.Reader = reader;
+  for (int i = 0; i < numberOfSlices; ++i)
+  {
+    if (0 != frameIndex->GetValue(i))
+    {
+      return NULL;
+    }
+    job.FileNames.push_back(
+      this->SeriesFileNames->GetValue(fileIndex->GetValue(i)));
+  }
+
+  vtkSmartPointer<vtkImageData> volume = vtkImageDataReaderAllocate(info);
+  job.Volume = volume;
+  this->StreamedImage = volume;
+
+  // small chunks keep the threads busy to the end and the slices arriving
+  // roughly in order
+  int numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int chunkSize =
+    std::max(1, std::min(8, numberOfSlices / (4 * numberOfThreads)));
+  if (!vtkImageDataReaderRunJob(&job, chunkSize))
+  {
+    // leave a series which could not be decoded slice by slice to the reader
+    this->StreamedImage = NULL;
+    return NULL;
+  }
+
+  return volume;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::ReadStack()
+{
+  vtkImageReader2* reader = vtkImageReader2::SafeDownCast(this->Reader);
+  this->StreamedImage = NULL;
+  if (NULL == reader || NULL == this->SeriesFileNames)
+  {
+    return NULL;
+  }
+
+  // the volume is laid out from the header of the first slice
+  int numberOfSlices =
+    static_cast<int>(this->SeriesFileNames->GetNumberOfValues());
+  vtkSmartPointer<vtkImageReader2> first =
+    vtkSmartPointer<vtkImageReader2>::Take(reader->NewInstance());
+  first->SetFileName(this->SeriesFileNames->GetValue(0).c_str());
+  first->UpdateInformation();
+  vtkInformation* info = first->GetOutputInformation(0);
+  int extent[6];
+  info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  if (extent[0] > extent[1] || extent[2] > extent[3] || extent[4] != extent[5])
+  {
+    return NULL;
+  }
+  extent[5] = extent[4] + numberOfSlices - 1;
+
+  vtkSmartPointer<vtkImageData> volume = vtkSmartPointer<vtkImageData>::New();
+  volume->SetExtent(extent);
+  volume->SetOrigin(info->Get(vtkDataObject::ORIGIN()));
+  volume->SetSpacing(info->Get(vtkDataObject::SPACING()));
+  volume->AllocateScalars(vtkImageData::GetScalarType(info),
+    vtkImageData::GetNumberOfScalarComponents(info));
+
+  vtkImageDataReaderJob job;
+  job.Self = this;
+  job.Decode = vtkImageDataReaderDecodeStack;
+  job.NumberOfSlices = numberOfSlices;
+  job.StackReader = reader;
+  job.Volume = volume;
+  for (int i = 0; i < numberOfSlices; ++i)
+  {
+    job.FileNames.push_back(this->SeriesFileNames->GetValue(i));
+  }
+  this->StreamedImage = volume;
+
+  int numberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int chunkSize =
+    std::max(1, std::min(8, numberOfSlices / (4 * numberOfThreads)));
+  if (!vtkImageDataReaderRunJob(&job, chunkSize))
+  {
+    this->StreamedImage = NULL;
+    if (job.Failed)
+    {
+      std::stringstream error;
+      error << "Unable to read '"
+            << Birch::Utilities::getFilenameName(this->FileName)
+            << "', the slices of the image stack differ in size or type.";
+      throw std::runtime_error(error.str());
+    }
+    return NULL;
+  }
+
+  return volume;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataReader::ReadFrames()
+{
+  vtkDICOMReader* reader = vtkDICOMReader::SafeDownCast(this->Reader);
+  this->StreamedImage = NULL;
+  if (NULL == reader || this->SeriesFileNames)
+  {
+    return NULL;
+  }
+  reader->UpdateInformation();
+
+  // only JPEG, JPEG-LS and JPEG 2000 frames are worth decoding in parallel
+  vtkDICOMMetaData* meta = reader->GetMetaData();
+  std::string syntax = meta->GetAttributeValue(
+    vtkDICOMTag(0x0002, 0x0010)).AsString();
+  int numberOfFrames = meta->GetAttributeValue(
+    vtkDICOMTag(0x0028, 0x0008)).AsInt();
+  gdcm::TransferSyntax transferSyntax =
+    gdcm::TransferSyntax::GetTSType(syntax.c_str());
+  if (2 > numberOfFrames ||
+      !(gdcm::JPEGCodec().CanDecode(transferSyntax) ||
+        gdcm::JPEGLSCodec().CanDecode(transferSyntax) ||
+        gdcm::JPEG2000Codec().CanDecode(transferSyntax)))
+  {
+    return NULL;
+  }
+
+  // each slice must be a single frame
+  vtkInformation* info = reader->GetOutputInformation(0);
+  int wholeExtent[6];
+  info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExtent);
+  int numberOfSlices = wholeExtent[5] - wholeExtent[4] + 1;
+  vtkIntArray* frameIndex = reader->GetFrameIndexArray();
+  if (NULL == frameIndex || 1 != frameIndex->GetNumberOfComponents() ||
+      numberOfSlices != frameIndex->GetNumberOfTuples())
+  {
+    return NULL;
+  }
+
+  // the compressed file is read whole, then its frames are decoded
+  gdcm::Reader gdcmReader;
+  gdcmReader.SetFileName(this->FileName.c_str());
+  if (!gdcmReader.Read())
+  {
+    return NULL;
+  }
+  const gdcm::File& file = gdcmReader.GetFile();
+  const gdcm::DataSet& ds = file.GetDataSet();
+  if (!ds.FindDataElement(gdcm::Tag(0x7fe0, 0x0010)))
+  {
+    return NULL;
+  }
+
+  // frames spanning several fragments are left to the reader
+  vtkImageDataReaderJob job;
+  job.Fragments =
+    ds.GetDataElement(gdcm::Tag(0x7fe0, 0x0010)).GetSequenceOfFragments();
+  if (NULL == job.Fragments ||
+      static_cast<size_t>(numberOfFrames) !=
+        job.Fragments->GetNumberOfFragments())
+  {
+    return NULL;
+  }
+
+  std::vector<unsigned int> dimensions =
+    gdcm::ImageHelper::GetDimensionsValue(file);
+  if (2 > dimensions.size() ||
+      static_cast<int>(dimensions[0]) != wholeExtent[1] - wholeExtent[0] + 1 ||
+      static_cast<int>(dimensions[1]) != wholeExtent[3] - wholeExtent[2] + 1)
+  {
+    return NULL;
+  }
+  job.Dimensions[0] = dimensions[0];
+  job.Dimensions[1] = dimensions[1];
+  job.Dimensions[2] = 1;
+  job.PixelFormat = gdcm::ImageHelper::GetPixelFormatValue(file);
+  job.Photometric =
+    gdcm::ImageHelper::GetPhotometricInterpretationValue(file);
+
+  // the decoded bytes are copied as they are or converted from 8-bit YBR
+  // to RGB, so frames the reader would rescale, sign extend or convert
+  // from other colour spaces are left to it
+  gdcm::PhotometricInterpretation::PIType photometric = job.Photometric;
+  bool colour =
+    gdcm::PhotometricInterpretation::RGB == photometric ||
+    gdcm::PhotometricInterpretation::YBR_FULL == photometric ||
+    gdcm::PhotometricInterpretation::YBR_FULL_422 == photometric ||
+    gdcm::PhotometricInterpretation::YBR_RCT == photometric ||
+    gdcm::PhotometricInterpretation::YBR_ICT == photometric;
+  if ((reader->GetAutoRescale() &&
+       (1.0 != reader->GetRescaleSlope() ||
+        0.0 != reader->GetRescaleIntercept())) ||
+      !(gdcm::PhotometricInterpretation::MONOCHROME1 == photometric ||
+        gdcm::PhotometricInterpretation::MONOCHROME2 == photometric ||
+        colour) ||
+      (colour && gdcm::PhotometricInterpretation::RGB != photometric &&
+       (3 != job.PixelFormat.GetSamplesPerPixel() ||
+        8 != job.PixelFormat.GetBitsAllocated() ||
+        job.PixelFormat.GetPixelRepresentation())) ||
+      (job.PixelFormat.GetPixelRepresentation() &&
+       job.PixelFormat.GetBitsStored() != job.PixelFormat.GetBitsAllocated()))
+  {
+    return NULL;
+  }
+  job.ConvertYBR = colour && 0 != reader->GetAutoYBRToRGB();
+  job.PlanarConfiguration = 0;
+  if (ds.FindDataElement(gdcm::Tag(0x0028, 0x0006)))
+  {
+    gdcm::Attribute<0x0028, 0x0006> planar;
+    planar.SetFromDataSet(ds);
+    job.PlanarConfiguration = planar.GetValue();
+  }
+  job.TransferSyntax = transferSyntax;
+
+  job.Self = this;
+  job.Decode = vtkImageDataReaderDecodeFrames;
+  job.NumberOfSlices = numberOfSlices;
+  job.FlipRows = vtkDICOMReader::BottomUp == reader->GetMemoryRowOrder();
+  for (int i = 0; i < numberOfSlices; ++i)
+  {
+    int frame = frameIndex->GetValue(i);
+    if (0 > frame || frame >= numberOfFrames)
+    {
+      return NULL;
+    }
+    job.Frames.push_back(frame);
+  }
+
+  // the decoded frames must fill the output slices exactly
+  vtkSmartPointer<vtkImageData> volume = vtkImageDataReaderAllocate(info);
+  if (static_cast<size_t>(dimensions[0]) * job.PixelFormat.GetPixelSize() !=
+      static_cast<size_t>(dimensions[0]) *
+        volume->GetNumberOfScalarComponents() * volume->GetScalarSize() ||
+      (0 != job.PixelFormat.GetPixelRepresentation()) !=
+        (0.0 > volume->GetScalarTypeMin()))
+  {
+    return NULL;
+  }
+  job.Volume = volume;
+  this->StreamedImage = volume;
+
+  // one frame at a time, so progress is reported per frame
+  if (!vtkImageDataReaderRunJob(&job, 1))
+  {
+    this->StreamedImage = NULL;
+    return NULL;
+  }
+
+  return volume;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -575,4 +2817,9 @@ void vtkImageDataReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "FileName: " << this->FileName << "\n";
+  os << indent << "SeriesFileNames: " << (this->SeriesFileNames ?
+    this->SeriesFileNames->GetNumberOfValues() : 0) << "\n";
+  os << indent << "StreamingSlabSize: " << this->StreamingSlabSize << "\n";
+  os << indent << "AbortExecute: " << this->AbortExecute << "\n";
+  os << indent << "MemoryMapping: " << this->MemoryMapping << "\n";
 }
@@ -21,7 +21,20 @@
  * VTK's XML image format using vtkXMLImageDataReader which it identifies
  * by the extension .vti
  *
+ * Files are identified by a registry of the supported readers which checks
+ * the file extension and the leading (magic) bytes of the file, falling
+ * back on the reader's CanReadFile only when the bytes are inconclusive.
+ * The result is cached per file so that calling IsValidFileName and then
+ * SetFileName probes the file only once.
+ *
  * GDCM's reader is used instead of VTK's native DICOM reader.
+ *
+ * Images are handed out without copying their voxels: the output, the
+ * instances made by GetOutputAsNewInstance and the cache of decoded images
+ * all share one scalar array.  Nothing detaches it on write, so a voxel
+ * changed in place changes every image sharing it, including the cached
+ * one later handed to other readers of the same file.  Filters that
+ * modify voxels must write to a new output or deep copy their input.
  */
 #ifndef __vtkImageDataReader_h
 #define __vtkImageDataReader_h
@@ -35,8 +48,11 @@
 #include <string>
 
 class vtkAlgorithm;
+class vtkAlgorithmOutput;
+class vtkDICOMMetaData;
 class vtkImageData;
 class vtkMedicalImageProperties;
+class vtkStringArray;
 
 class vtkImageDataReader : public vtkObject
 {
@@ -49,7 +65,17 @@ class vtkImageDataReader : public vtkObject
     /**
      * Set/Get the file name to be opened by the reader.
      * If a directory is selected then the reader will attempt to open all
-     * DICOM files in that directory.
+     * DICOM files in that directory.  The files are grouped by series and
+     * the largest series is read: its headers are read and sorted along the
+     * slice normal by the DICOM reader, then the slices are decoded on
+     * several threads straight into the output volume.  A directory without
+     * DICOM files is read as a stack of numbered 2D images, such as
+     * slice_0001.png to slice_2000.png: the largest run of BMP, JPEG, PNG or
+     * TIFF files sharing a name apart from their number is read, in numeric
+     * order, as the slices of a volume.  A run in which two files have the
+     * same number, such as slice_1.png and slice_01.png, is not read.  The
+     * slices are decoded in parallel and must all match the first in size
+     * and scalar type.
      */
     virtual void SetFileName(const char* name);
     std::string GetFileName() { return this->FileName; }
@@ -58,7 +84,9 @@ class vtkImageDataReader : public vtkObject
     /**
      * Returns a reference to a vtkImageData object created by opening the
      * current FileName.  If FileName is changed then the next time this
-     * method is called the old reference will no longer be valid.
+     * method is called the old reference will no longer be valid.  The
+     * image's scalars may be shared with the cache of decoded images, so
+     * they must not be modified in place.
      */
     virtual vtkImageData* GetOutput();
 
@@ -66,27 +94,148 @@ class vtkImageDataReader : public vtkObject
      * Creates a new instance of a vtkImageData object created by opening
      * the current FileName and returns it.  A reference to this object is
      * not kept and it is up to the caller of this method to delete the
-     * object.
+     * object.  The new instance shares its scalars with the reader's output
+     * (and the cache of decoded images), so creating it costs no memory,
+     * and its voxels must not be modified in place: deep copy it first.
      */
     vtkImageData* GetOutputAsNewInstance();
 
+    /**
+     * Returns the output port of the underlying reader after reading only
+     * the file's header, or NULL if the file cannot be read.  Unlike
+     * GetOutput no pixel data is read here: downstream filters connected to
+     * the port pull only the update extent they request, so a viewer showing
+     * a single slice never has to decode the rest of the volume.  Readers
+     * which cannot read sub-extents produce the whole extent when first
+     * updated.
+     */
+    virtual vtkAlgorithmOutput* GetOutputPort();
+
     /**
      * Get the reader so we can query what type it was among other things.
      */
     vtkGetObjectMacro(Reader, vtkAlgorithm);
 
+    //@{
+    /**
+     * Set/Get the number of slices read at a time when streaming.  When
+     * non-zero, GetOutput allocates the whole volume, zero filled, and reads
+     * it slab by slab along the z axis, invoking a
+     * Birch::Common::SlicesLoadedEvent after each slab with the number of
+     * slices read so far (int*) as call data.  The volume being filled is
+     * available from GetStreamedOutput as soon as the first of these events
+     * fires.  Readers that ignore the requested extent are read in one
+     * piece.  Defaults to 0 (no streaming).
+     */
+    vtkSetClampMacro(StreamingSlabSize, int, 0, VTK_INT_MAX);
+    vtkGetMacro(StreamingSlabSize, int);
+    //@}
+
+    /**
+     * Get the volume being filled by a streamed read.
+     */
+    vtkImageData* GetStreamedOutput();
+
+    //@{
+    /**
+     * Set/Get whether GetOutput wraps the voxels of uncompressed MetaImage,
+     * single file NIfTI and raw appended VTI files directly from a private
+     * memory map of the file rather than reading them into memory.  Pages
+     * are then read from disk only when first touched, so opening a large
+     * volume costs little more than reading its header, and processes
+     * viewing the same file share the page cache.  Files which cannot be
+     * mapped as is (compressed, foreign byte order, etc.) are read as
+     * usual.  A mapped file must not be truncated or rewritten in place
+     * while the image is in use: touching voxels past the new end of the
+     * file raises SIGBUS.  Turn mapping off for files which other programs
+     * may be writing.  Defaults to on.
+     */
+    vtkSetMacro(MemoryMapping, int);
+    vtkGetMacro(MemoryMapping, int);
+    vtkBooleanMacro(MemoryMapping, int);
+    //@}
+
+    //@{
+    /**
+     * Set/Get the abort flag.  A streamed read stops between slabs when
+     * it is set and the flag is passed on to the underlying reader.  The
+     * flag is cleared when the file name changes.
+     */
+    virtual void SetAbortExecute(int abort);
+    vtkGetMacro(AbortExecute, int);
+    vtkBooleanMacro(AbortExecute, int);
+    //@}
+
     /**
      * Before trying to do anything with the named file, check if it is in fact
-     * readable by this object.
+     * readable by this object.  The identified reader is cached for use by
+     * a subsequent call to SetFileName.
      */
     static bool IsValidFileName(const char* name);
 
+    //@{
+    /**
+     * Set/Get the size in kibibytes of the cache of decoded images shared
+     * by all readers.  GetOutput returns a cached image, and its medical
+     * image properties, when the same file is read again and has not
+     * changed size or modification time since, nor have any of the files
+     * of a directory's series or stack, so reloading a file or flipping
+     * between recent files does not decode it again.  The least
+     * recently used images are evicted to keep within the size.  Defaults
+     * to 512 MiB; 0 disables caching.
+     */
+    static void SetCacheSize(vtkIdType kibibytes);
+    static vtkIdType GetCacheSize();
+    //@}
+
+    /**
+     * Remove all images from the cache of decoded images.
+     */
+    static void ClearCache();
+
+    //@{
+    /**
+     * Set/Get the directory of the disk cache of decoded images shared by
+     * all readers and processes.  Once decoded, compressed DICOM files,
+     * which cannot be mapped, are written to the directory as uncompressed
+     * MetaImage sidecars named by a hash of the file's path, size and
+     * modification time.  Opening the unchanged file again, even after a
+     * restart, then maps the sidecar (see MemoryMapping) rather than
+     * decoding the file.  The sidecars keep the patient details of the
+     * medical image properties, so the directory and its files are made
+     * readable by their owner only.  Defaults to empty, which disables the
+     * disk cache.
+     */
+    static void SetDiskCacheDirectory(const std::string& path);
+    static std::string GetDiskCacheDirectory();
+    //@}
+
+    //@{
+    /**
+     * Set/Get the size in kibibytes of the disk cache of decoded images.
+     * The least recently used sidecars are deleted to keep the directory
+     * within the size, on a thread of their own, so the directory should be
+     * set first.  Defaults to 4 GiB; 0 disables the disk cache.
+     */
+    static void SetDiskCacheSize(vtkIdType kibibytes);
+    static vtkIdType GetDiskCacheSize();
+    //@}
+
     /**
      * Get the medical image properties if the image, if there are any.
      * For DICOM images, we add additional user defined tags.
      */
     vtkMedicalImageProperties* GetMedicalImageProperties();
 
+    /**
+     * Get the DICOM attributes of the file, or NULL if it is not a DICOM
+     * file.  The attributes are those parsed by the reader along with the
+     * file's header, up to the pixel data, so views listing the attributes
+     * can share them rather than parsing the file again.  Valid once
+     * GetOutput has been called.
+     */
+    vtkDICOMMetaData* GetMetaData();
+
   protected:
     vtkImageDataReader();
     ~vtkImageDataReader();
@@ -97,10 +246,90 @@ class vtkImageDataReader : public vtkObject
      */
     virtual void SetReader(vtkAlgorithm* reader);
 
+    /**
+     * Read the file slab by slab into StreamedImage.
+     */
+    virtual vtkImageData* StreamOutput();
+
+    /**
+     * Map the file's voxels into OutputImage, returning NULL if the file
+     * cannot be mapped.
+     */
+    virtual vtkImageData* MapOutput();
+
+    /**
+     * Decode the slices of a DICOM series in parallel into StreamedImage,
+     * returning NULL if the series has to be left to the reader.
+     */
+    virtual vtkImageData* ReadSeries();
+
+    /**
+     * Decode the slices of a numbered image stack in parallel into
+     * StreamedImage.  Throws an exception if the slices differ in size or
+     * type.
+     */
+    virtual vtkImageData* ReadStack();
+
+    /**
+     * Decode the frames of a JPEG, JPEG-LS or JPEG 2000 compressed
+     * multi-frame DICOM file in parallel into StreamedImage, returning NULL
+     * if the file has to be left to the reader.
+     */
+    virtual vtkImageData* ReadFrames();
+
+    /**
+     * Pass the file name, or the series' file names, on to the reader.
+     */
+    void SetReaderFileName();
+
+    /**
+     * Update the reader, forwarding its start, progress and end events.
+     */
+    void UpdateReader();
+
+    /**
+     * Look the file up in the cache of decoded images, setting OutputImage
+     * and MedicalImageProperties if it is found.
+     */
+    bool FindCachedOutput();
+
+    /**
+     * Add a newly read image, and the current medical image properties,
+     * to the cache of decoded images.
+     */
+    void AddCachedOutput(vtkImageData* image);
+
+    /**
+     * Look the file up in the disk cache of decoded images, setting
+     * OutputImage and MedicalImageProperties if its sidecar is found.
+     */
+    bool FindDiskCachedOutput();
+
+    /**
+     * Write a newly decoded image, and the current medical image
+     * properties, to a sidecar in the disk cache of decoded images.  The
+     * sidecar is written on a thread of its own and returns at once.
+     */
+    void AddDiskCachedOutput(vtkImageData* image);
+
+    /**
+     * Fill MedicalImageProperties and MetaData from the current reader.
+     */
+    virtual void UpdateMedicalImageProperties();
+
     std::string FileName;
+    std::string DiskCacheKey;
+    vtkSmartPointer<vtkStringArray> SeriesFileNames;
     vtkAlgorithm* Reader;
     vtkTimeStamp ReadMTime;
     vtkSmartPointer<vtkMedicalImageProperties> MedicalImageProperties;
+    vtkSmartPointer<vtkDICOMMetaData> MetaData;
+    vtkSmartPointer<vtkImageData> StreamedImage;
+    vtkSmartPointer<vtkImageData> OutputImage;
+    int StreamingSlabSize;
+    int AbortExecute;
+    int MemoryMapping;
+    int CachedOutput;
 
   private:
     vtkImageDataReader(const vtkImageDataReader&);  /** Not implemented. */
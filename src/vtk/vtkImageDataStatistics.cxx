@@ -0,0 +1,681 @@
+/*=========================================================================
+
+  Module:    vtkImageDataStatistics.cxx
+  Program:   Birch
+  Language:  C++
+  Author:    Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+#include <vtkImageDataStatistics.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
+#include <vtkMath.h>
+#include <vtkMultiThreader.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkTypeTraits.h>
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+vtkStandardNewMacro(vtkImageDataStatistics);
+vtkInformationKeyMacro(vtkImageDataStatistics, STATISTICS, ObjectBase);
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// The statistics are gathered by each thread over a contiguous run of
+// tuples into sums of its own, one per component, which are merged once
+// every thread is done.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  struct vtkImageDataStatisticsSums
+  {
+    vtkImageDataStatisticsSums()
+      : Minimum(VTK_DOUBLE_MAX), Maximum(VTK_DOUBLE_MIN), Sum(0.0),
+        SumOfSquares(0.0), Count(0) {}
+
+    double Minimum;
+    double Maximum;
+    double Sum;                          // of the values less the shift
+    double SumOfSquares;
+    vtkIdType Count;
+    std::vector<vtkIdType> Histogram;
+  };
+
+  struct vtkImageDataStatisticsJob
+  {
+    enum PassType { COUNT, MOMENTS, BIN };
+
+    void* Input;
+    int InputType;
+    vtkIdType NumberOfTuples;
+    int NumberOfComponents;
+    PassType Pass;
+    std::vector<double> Shift;           // one per component
+    double BinOrigin;
+    double BinScale;
+    vtkIdType NumberOfBins;
+    std::vector<vtkImageDataStatisticsSums> Sums;  // per thread, component
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Count every value of an 8 or 16-bit type into a bin of its own
+  template <class T>
+  void vtkImageDataStatisticsCount(const T* in, vtkIdType count,
+    int numberOfComponents, vtkImageDataStatisticsSums* sums)
+  {
+    const int offset = -static_cast<int>(vtkTypeTraits<T>::Min());
+    const T* end = in + count*numberOfComponents;
+    for (int c = 0; c < numberOfComponents; ++c)
+    {
+      vtkIdType* histogram = &sums[c].Histogram[0];
+      for (const T* p = in + c; p < end; p += numberOfComponents)
+      {
+        histogram[static_cast<int>(*p) + offset]++;
+      }
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  void vtkImageDataStatisticsMoments(const T* in, vtkIdType count,
+    int numberOfComponents, const double* shift,
+    vtkImageDataStatisticsSums* sums)
+  {
+    const T* end = in + count*numberOfComponents;
+    for (int c = 0; c < numberOfComponents; ++c)
+    {
+      double low = VTK_DOUBLE_MAX;
+      double high = VTK_DOUBLE_MIN;
+      double sum = 0.0;
+      double sumOfSquares = 0.0;
+      vtkIdType n = 0;
+      for (const T* p = in + c; p < end; p += numberOfComponents)
+      {
+        double value = static_cast<double>(*p);
+        if (value != value) continue;  // NaN
+        if (value < low) low = value;
+        if (value > high) high = value;
+        // shifted by a value of the image to keep the sums small
+        value -= shift[c];
+        sum += value;
+        sumOfSquares += value*value;
+        n++;
+      }
+      sums[c].Minimum = low;
+      sums[c].Maximum = high;
+      sums[c].Sum = sum;
+      sums[c].SumOfSquares = sumOfSquares;
+      sums[c].Count = n;
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  void vtkImageDataStatisticsBin(const T* in, vtkIdType count,
+    int numberOfComponents, double origin, double scale,
+    vtkIdType numberOfBins, vtkImageDataStatisticsSums* sums)
+  {
+    const double last = static_cast<double>(numberOfBins - 1);
+    const T* end = in + count*numberOfComponents;
+    for (int c = 0; c < numberOfComponents; ++c)
+    {
+      vtkIdType* histogram = &sums[c].Histogram[0];
+      for (const T* p = in + c; p < end; p += numberOfComponents)
+      {
+        double value = static_cast<double>(*p);
+        if (value != value) continue;  // NaN
+        double bin = (value - origin)*scale;
+        bin = bin > 0.0 ? (bin < last ? bin : last) : 0.0;
+        histogram[static_cast<vtkIdType>(bin)]++;
+      }
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataStatisticsThread(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkImageDataStatisticsJob* job =
+      static_cast<vtkImageDataStatisticsJob*>(info->UserData);
+
+    // each thread takes one contiguous run of tuples
+    vtkIdType first =
+      job->NumberOfTuples * info->ThreadID / info->NumberOfThreads;
+    vtkIdType last =
+      job->NumberOfTuples * (info->ThreadID + 1) / info->NumberOfThreads;
+    int nc = job->NumberOfComponents;
+    vtkIdType offset = first*nc;
+    vtkIdType count = last - first;
+    vtkImageDataStatisticsSums* sums = &job->Sums[info->ThreadID*nc];
+
+    switch (job->Pass)
+    {
+      case vtkImageDataStatisticsJob::COUNT:
+        switch (job->InputType)
+        {
+          case VTK_CHAR:
+            vtkImageDataStatisticsCount(
+              static_cast<char*>(job->Input) + offset, count, nc, sums);
+            break;
+          case VTK_SIGNED_CHAR:
+            vtkImageDataStatisticsCount(
+              static_cast<signed char*>(job->Input) + offset, count, nc,
+              sums);
+            break;
+          case VTK_UNSIGNED_CHAR:
+            vtkImageDataStatisticsCount(
+              static_cast<unsigned char*>(job->Input) + offset, count, nc,
+              sums);
+            break;
+          case VTK_SHORT:
+            vtkImageDataStatisticsCount(
+              static_cast<short*>(job->Input) + offset, count, nc, sums);
+            break;
+          case VTK_UNSIGNED_SHORT:
+            vtkImageDataStatisticsCount(
+              static_cast<unsigned short*>(job->Input) + offset, count, nc,
+              sums);
+            break;
+        }
+        break;
+      case vtkImageDataStatisticsJob::MOMENTS:
+        switch (job->InputType)
+        {
+          vtkTemplateMacro(vtkImageDataStatisticsMoments(
+            static_cast<VTK_TT*>(job->Input) + offset, count, nc,
+            &job->Shift[0], sums));
+        }
+        break;
+      case vtkImageDataStatisticsJob::BIN:
+        switch (job->InputType)
+        {
+          vtkTemplateMacro(vtkImageDataStatisticsBin(
+            static_cast<VTK_TT*>(job->Input) + offset, count, nc,
+            job->BinOrigin, job->BinScale, job->NumberOfBins, sums));
+        }
+        break;
+    }
+
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Returns the number of threads the sums were gathered by
+  int vtkImageDataStatisticsRunJob(vtkImageDataStatisticsJob* job)
+  {
+    // small images are not worth the cost of starting threads
+    const vtkIdType tuplesPerThread = 65536;
+    int numberOfThreads = static_cast<int>(std::max<vtkIdType>(1,
+      std::min<vtkIdType>(vtkMultiThreader::GetGlobalDefaultNumberOfThreads(),
+        job->NumberOfTuples / tuplesPerThread)));
+
+    vtkImageDataStatisticsSums sums;
+    if (vtkImageDataStatisticsJob::MOMENTS != job->Pass)
+    {
+      sums.Histogram.assign(job->NumberOfBins, 0);
+    }
+    job->Sums.assign(numberOfThreads*job->NumberOfComponents, sums);
+
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(vtkImageDataStatisticsThread, job);
+    threader->SingleMethodExecute();
+
+    return numberOfThreads;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Sum one component's histograms over the threads
+  void vtkImageDataStatisticsMergeHistograms(vtkImageDataStatisticsJob* job,
+    int numberOfThreads, int component, std::vector<vtkIdType>& histogram)
+  {
+    int nc = job->NumberOfComponents;
+    histogram.swap(job->Sums[component].Histogram);
+    for (int t = 1; t < numberOfThreads; ++t)
+    {
+      const std::vector<vtkIdType>& other =
+        job->Sums[t*nc + component].Histogram;
+      for (size_t i = 0; i < histogram.size(); ++i)
+      {
+        histogram[i] += other[i];
+      }
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataStatisticsIsCounted(int type)
+  {
+    return VTK_CHAR == type || VTK_SIGNED_CHAR == type ||
+      VTK_UNSIGNED_CHAR == type || VTK_SHORT == type ||
+      VTK_UNSIGNED_SHORT == type;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageDataStatistics::vtkImageDataStatistics()
+{
+  this->NumberOfComponents = 0;
+  this->BinOrigin = 0.0;
+  this->BinSpacing = 1.0;
+  this->IntegerBins = true;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageDataStatistics::~vtkImageDataStatistics()
+{
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageDataStatistics* vtkImageDataStatistics::GetStatistics(
+  vtkImageData* image)
+{
+  if (!image) return NULL;
+
+  vtkInformation* info = image->GetInformation();
+  vtkImageDataStatistics* statistics =
+    vtkImageDataStatistics::SafeDownCast(
+      info->Get(vtkImageDataStatistics::STATISTICS()));
+  if (!statistics || image != statistics->GetImage())
+  {
+    // the image's information holds the only reference, the statistics
+    // hold only a weak one to the image, and those of a shallow copy of
+    // another image are not taken as its own
+    statistics = vtkImageDataStatistics::New();
+    statistics->SetImage(image);
+    info->Set(vtkImageDataStatistics::STATISTICS(), statistics);
+    statistics->Delete();
+  }
+  statistics->Update();
+  return statistics;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::SetImage(vtkImageData* image)
+{
+  if (image == this->Image.GetPointer()) return;
+  this->Image = image;
+  this->Scalars = NULL;
+  this->NumberOfComponents = 0;
+  this->Components.clear();
+  this->Modified();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkImageDataStatistics::GetImage()
+{
+  return this->Image;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::Update()
+{
+  vtkImageData* image = this->Image;
+  vtkDataArray* scalars = image && image->GetPointData() ?
+    image->GetPointData()->GetScalars() : NULL;
+
+  // the loader marks the scalars of a partly loaded image modified as it
+  // copies slices into them, as does replacing them
+  if (scalars == this->Scalars.GetPointer() &&
+      (!scalars || scalars->GetMTime() < this->ComputeTime.GetMTime()))
+  {
+    return;
+  }
+
+  this->Scalars = scalars;
+  this->Compute(scalars);
+  this->Modified();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::Compute(vtkDataArray* scalars)
+{
+  int nc = scalars ? scalars->GetNumberOfComponents() : 0;
+  vtkIdType numberOfTuples = scalars ? scalars->GetNumberOfTuples() : 0;
+  Component empty = { 0.0, 0.0, 0.0, 0.0, 0, std::vector<vtkIdType>() };
+  this->NumberOfComponents = nc;
+  this->Components.assign(nc, empty);
+  this->BinOrigin = 0.0;
+  this->BinSpacing = 1.0;
+  this->IntegerBins = true;
+  this->ComputeTime.Modified();
+
+  if (0 == numberOfTuples || VTK_BIT == scalars->GetDataType())
+  {
+    this->HistogramTime.Modified();
+    return;
+  }
+
+  vtkImageDataStatisticsJob job;
+  job.Input = scalars->GetVoidPointer(0);
+  job.InputType = scalars->GetDataType();
+  job.NumberOfTuples = numberOfTuples;
+  job.NumberOfComponents = nc;
+
+  if (!vtkImageDataStatisticsIsCounted(job.InputType))
+  {
+    // wider types take their moments, the histogram is binned on demand
+    job.Pass = vtkImageDataStatisticsJob::MOMENTS;
+    job.NumberOfBins = 0;
+    job.Shift.resize(nc);
+    for (int c = 0; c < nc; ++c)
+    {
+      double value = scalars->GetComponent(0, c);
+      job.Shift[c] = vtkMath::IsFinite(value) ? value : 0.0;
+    }
+    int numberOfThreads = vtkImageDataStatisticsRunJob(&job);
+
+    for (int c = 0; c < nc; ++c)
+    {
+      vtkImageDataStatisticsSums total;
+      for (int t = 0; t < numberOfThreads; ++t)
+      {
+        const vtkImageDataStatisticsSums& sums = job.Sums[t*nc + c];
+        total.Minimum = std::min(total.Minimum, sums.Minimum);
+        total.Maximum = std::max(total.Maximum, sums.Maximum);
+        total.Sum += sums.Sum;
+        total.SumOfSquares += sums.SumOfSquares;
+        total.Count += sums.Count;
+      }
+      if (0 == total.Count) continue;  // all NaN
+
+      Component& component = this->Components[c];
+      double mean = total.Sum / total.Count;
+      component.Minimum = total.Minimum;
+      component.Maximum = total.Maximum;
+      component.Mean = job.Shift[c] + mean;
+      component.StandardDeviation =
+        sqrt(std::max(0.0, total.SumOfSquares / total.Count - mean*mean));
+      component.NumberOfValues = total.Count;
+    }
+    return;
+  }
+
+  // 8 and 16-bit types are counted into a bin for every value they can
+  // take, the other statistics follow from the counts
+  job.Pass = vtkImageDataStatisticsJob::COUNT;
+  job.NumberOfBins =
+    static_cast<vtkIdType>(1) << (8*scalars->GetDataTypeSize());
+  int numberOfThreads = vtkImageDataStatisticsRunJob(&job);
+
+  const double typeMin = scalars->GetDataTypeMin();
+  vtkIdType low = job.NumberOfBins;
+  vtkIdType high = -1;
+  for (int c = 0; c < nc; ++c)
+  {
+    Component& component = this->Components[c];
+    std::vector<vtkIdType>& histogram = component.Histogram;
+    vtkImageDataStatisticsMergeHistograms(&job, numberOfThreads, c, histogram);
+
+    vtkIdType first = -1;
+    vtkIdType last = -1;
+    vtkIdType count = 0;
+    double sum = 0.0;
+    for (vtkIdType i = 0; i < job.NumberOfBins; ++i)
+    {
+      if (0 == histogram[i]) continue;
+      if (-1 == first) first = i;
+      last = i;
+      count += histogram[i];
+      sum += static_cast<double>(histogram[i]) * i;
+    }
+    if (0 == count) continue;
+
+    double mean = sum / count;
+    double sumOfSquares = 0.0;
+    for (vtkIdType i = first; i <= last; ++i)
+    {
+      double deviation = i - mean;
+      sumOfSquares += histogram[i] * deviation * deviation;
+    }
+    component.Minimum = typeMin + first;
+    component.Maximum = typeMin + last;
+    component.Mean = typeMin + mean;
+    component.StandardDeviation = sqrt(sumOfSquares / count);
+    component.NumberOfValues = count;
+    low = std::min(low, first);
+    high = std::max(high, last);
+  }
+
+  // keep only the bins spanning the range of all of the components
+  if (-1 == high)
+  {
+    low = high = 0;
+  }
+  for (int c = 0; c < nc; ++c)
+  {
+    std::vector<vtkIdType>& histogram = this->Components[c].Histogram;
+    std::vector<vtkIdType>(
+      histogram.begin() + low, histogram.begin() + high + 1).swap(histogram);
+  }
+  this->BinOrigin = typeMin + low;
+  this->BinSpacing = 1.0;
+  this->HistogramTime.Modified();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::ComputeHistogram(vtkDataArray* scalars)
+{
+  this->HistogramTime.Modified();
+  if (!scalars || 0 == this->NumberOfComponents) return;
+
+  double range[2];
+  this->GetRange(range);
+
+  // integers in bins of unit width, widened so that there are no more
+  // than 65536, floating point values in 65536 bins across their range
+  const double maximumNumberOfBins = 65536.0;
+  int type = scalars->GetDataType();
+  bool integerBins = VTK_FLOAT != type && VTK_DOUBLE != type;
+  double origin = integerBins ? floor(range[0]) : range[0];
+  double width = integerBins ?
+    floor(range[1]) - origin + 1.0 : range[1] - origin;
+  double spacing = integerBins ?
+    std::max(1.0, ceil(width / maximumNumberOfBins)) :
+    width / maximumNumberOfBins;
+  if (!vtkMath::IsFinite(width) || 0.0 >= spacing)
+  {
+    origin = range[0];
+    width = spacing = 1.0;
+  }
+
+  vtkImageDataStatisticsJob job;
+  job.Input = scalars->GetVoidPointer(0);
+  job.InputType = scalars->GetDataType();
+  job.NumberOfTuples = scalars->GetNumberOfTuples();
+  job.NumberOfComponents = this->NumberOfComponents;
+  job.Pass = vtkImageDataStatisticsJob::BIN;
+  job.BinOrigin = origin;
+  job.BinScale = 1.0 / spacing;
+  job.NumberOfBins = static_cast<vtkIdType>(ceil(width / spacing));
+  int numberOfThreads = vtkImageDataStatisticsRunJob(&job);
+
+  for (int c = 0; c < this->NumberOfComponents; ++c)
+  {
+    vtkImageDataStatisticsMergeHistograms(&job, numberOfThreads, c,
+      this->Components[c].Histogram);
+  }
+  this->BinOrigin = origin;
+  this->BinSpacing = spacing;
+  this->IntegerBins = integerBins;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+bool vtkImageDataStatistics::IsValid(int component)
+{
+  return 0 <= component && component < this->NumberOfComponents;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetMinimum(int component)
+{
+  return this->IsValid(component) ?
+    this->Components[component].Minimum : 0.0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetMaximum(int component)
+{
+  return this->IsValid(component) ?
+    this->Components[component].Maximum : 0.0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetMean(int component)
+{
+  return this->IsValid(component) ?
+    this->Components[component].Mean : 0.0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetStandardDeviation(int component)
+{
+  return this->IsValid(component) ?
+    this->Components[component].StandardDeviation : 0.0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkIdType vtkImageDataStatistics::GetNumberOfValues(int component)
+{
+  return this->IsValid(component) ?
+    this->Components[component].NumberOfValues : 0;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::GetRange(double range[2])
+{
+  range[0] = VTK_DOUBLE_MAX;
+  range[1] = VTK_DOUBLE_MIN;
+  for (int c = 0; c < this->NumberOfComponents; ++c)
+  {
+    if (0 == this->Components[c].NumberOfValues) continue;
+    range[0] = std::min(range[0], this->Components[c].Minimum);
+    range[1] = std::max(range[1], this->Components[c].Maximum);
+  }
+  if (range[0] > range[1])  // empty or all NaN
+  {
+    range[0] = range[1] = 0.0;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+const std::vector<vtkIdType>& vtkImageDataStatistics::GetHistogram(
+  int component)
+{
+  if (this->HistogramTime.GetMTime() < this->ComputeTime.GetMTime())
+  {
+    this->ComputeHistogram(this->Scalars);
+  }
+
+  static const std::vector<vtkIdType> empty;
+  return this->IsValid(component) ?
+    this->Components[component].Histogram : empty;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::GetPercentileRange(
+  double lower, double upper, double range[2])
+{
+  this->GetRange(range);
+  if (0 == this->NumberOfComponents) return;
+
+  // the components are counted together, their bins are the same
+  std::vector<vtkIdType> histogram(this->GetHistogram(0));
+  for (int c = 1; c < this->NumberOfComponents; ++c)
+  {
+    const std::vector<vtkIdType>& other = this->GetHistogram(c);
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+      histogram[i] += other[i];
+    }
+  }
+
+  vtkIdType total = 0;
+  for (size_t i = 0; i < histogram.size(); ++i)
+  {
+    total += histogram[i];
+  }
+  if (0 == total) return;
+
+  lower = std::max(0.0, std::min(100.0, lower));
+  upper = std::max(lower, std::min(100.0, upper));
+  double low = this->FindPercentile(histogram, 0.01*lower*total);
+  double high = this->FindPercentile(histogram, 0.01*upper*total);
+  range[0] = std::max(range[0], low);
+  range[1] = std::min(range[1], high);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::FindPercentile(
+  const std::vector<vtkIdType>& histogram, double target)
+{
+  // the first bin at which the count reaches the target, interpolated
+  // across the values the bin holds
+  vtkIdType count = 0;
+  size_t last = 0;
+  for (size_t i = 0; i < histogram.size(); ++i)
+  {
+    if (0 == histogram[i]) continue;
+    last = i;
+    if (count + histogram[i] >= target)
+    {
+      double offset = this->BinSpacing *
+        (target - count) / static_cast<double>(histogram[i]);
+      if (this->IntegerBins)
+      {
+        offset = std::min(floor(offset), this->BinSpacing - 1.0);
+      }
+      return this->BinOrigin + i*this->BinSpacing + std::max(0.0, offset);
+    }
+    count += histogram[i];
+  }
+  return this->BinOrigin + last*this->BinSpacing;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetBinOrigin()
+{
+  if (this->HistogramTime.GetMTime() < this->ComputeTime.GetMTime())
+  {
+    this->ComputeHistogram(this->Scalars);
+  }
+  return this->BinOrigin;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+double vtkImageDataStatistics::GetBinSpacing()
+{
+  if (this->HistogramTime.GetMTime() < this->ComputeTime.GetMTime())
+  {
+    this->ComputeHistogram(this->Scalars);
+  }
+  return this->BinSpacing;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataStatistics::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Image: " << this->Image.GetPointer() << endl;
+  os << indent << "NumberOfComponents: " << this->NumberOfComponents << endl;
+  for (int c = 0; c < this->NumberOfComponents; ++c)
+  {
+    const Component& component = this->Components[c];
+    os << indent << "Component " << c << ": "
+       << "[" << component.Minimum << ", " << component.Maximum << "]"
+       << " mean " << component.Mean
+       << " sd " << component.StandardDeviation << endl;
+  }
+  os << indent << "BinOrigin: " << this->BinOrigin << endl;
+  os << indent << "BinSpacing: " << this->BinSpacing << endl;
+}
@@ -0,0 +1,157 @@
+/*=========================================================================
+
+  Module:    vtkImageDataStatistics.h
+  Program:   Birch
+  Language:  C++
+  Author:    Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+
+/**
+ * @class vtkImageDataStatistics
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief The minimum, maximum, mean, standard deviation and histogram of
+ * each component of an image's scalars
+ *
+ * The statistics of an image are kept in its information under the
+ * STATISTICS key, so every consumer of the image shares them.  Call
+ * GetStatistics rather than New to find or create them: they are computed
+ * in a single pass over the scalars, split across threads, and recomputed
+ * only once the scalars are replaced or modified.
+ *
+ * Input of 8 or 16-bit integer type is counted into a histogram of every
+ * value the type can take, from which the other statistics follow, so the
+ * one pass yields them all.  The histogram of other types needs their
+ * range first and is binned by a second pass, made the first time it is
+ * asked for.  The histogram of every component spans the range of all of
+ * them, in bins of at least unit width for integer types and in 65536
+ * bins for floating point types.  The standard deviation is that of the
+ * population and NaN values are ignored.
+ *
+ * @see vtkImageData
+ */
+
+#ifndef __vtkImageDataStatistics_h
+#define __vtkImageDataStatistics_h
+
+// VTK includes
+#include <vtkObject.h>
+#include <vtkWeakPointer.h>
+
+// C++ includes
+#include <vector>
+
+class vtkDataArray;
+class vtkImageData;
+class vtkInformationObjectBaseKey;
+
+class vtkImageDataStatistics : public vtkObject
+{
+  public:
+    static vtkImageDataStatistics* New();
+    vtkTypeMacro(vtkImageDataStatistics, vtkObject);
+    void PrintSelf(ostream& os, vtkIndent indent);
+
+    /**
+     * The up to date statistics of an image, which are created and kept in
+     * the image's information the first time they are asked for.  Returns
+     * NULL if there is no image.
+     */
+    static vtkImageDataStatistics* GetStatistics(vtkImageData* image);
+
+    /**
+     * The key the statistics are kept under in an image's information.
+     */
+    static vtkInformationObjectBaseKey* STATISTICS();
+
+    //@{
+    /**
+     * Set / Get the image the statistics are computed from.
+     */
+    void SetImage(vtkImageData* image);
+    vtkImageData* GetImage();
+    //@}
+
+    /**
+     * Compute the statistics, unless those of the image's current scalars
+     * are already known.
+     */
+    void Update();
+
+    /**
+     * The number of components of the image's scalars, 0 if it has none.
+     */
+    int GetNumberOfComponents() { return this->NumberOfComponents; }
+
+    //@{
+    /**
+     * The statistics of one component, 0 if there is no such component.
+     */
+    double GetMinimum(int component);
+    double GetMaximum(int component);
+    double GetMean(int component);
+    double GetStandardDeviation(int component);
+    vtkIdType GetNumberOfValues(int component);
+    //@}
+
+    /**
+     * The range of all of the components together.
+     */
+    void GetRange(double range[2]);
+
+    //@{
+    /**
+     * The histogram of one component, an empty one if there is no such
+     * component, and the value at the start of the first bin and the width
+     * of the bins, which are common to every component.
+     */
+    const std::vector<vtkIdType>& GetHistogram(int component);
+    double GetBinOrigin();
+    double GetBinSpacing();
+    //@}
+
+    /**
+     * The values below which the lower and upper percentages of the values
+     * of all of the components together lie, found from the histograms.
+     * A window from the 1st to the 99th percentile is not washed out by a
+     * few outlying values, as one spanning the whole range is.
+     */
+    void GetPercentileRange(double lower, double upper, double range[2]);
+
+  protected:
+    vtkImageDataStatistics();
+    ~vtkImageDataStatistics();
+
+    void Compute(vtkDataArray* scalars);
+    void ComputeHistogram(vtkDataArray* scalars);
+    double FindPercentile(
+      const std::vector<vtkIdType>& histogram, double target);
+    bool IsValid(int component);
+
+    struct Component
+    {
+      double Minimum;
+      double Maximum;
+      double Mean;
+      double StandardDeviation;
+      vtkIdType NumberOfValues;
+      std::vector<vtkIdType> Histogram;
+    };
+
+    vtkWeakPointer<vtkImageData> Image;
+    vtkWeakPointer<vtkDataArray> Scalars;
+    int NumberOfComponents;
+    std::vector<Component> Components;
+    double BinOrigin;
+    double BinSpacing;
+    bool IntegerBins;
+    vtkTimeStamp ComputeTime;
+    vtkTimeStamp HistogramTime;
+
+  private:
+    vtkImageDataStatistics(const vtkImageDataStatistics&);  /** Not implemented */
+    void operator=(const vtkImageDataStatistics&);  /** Not implemented */
+};
+
+#endif
@@ -19,35 +19,53 @@
 // VTK includes
 #include <vtkBMPReader.h>
 #include <vtkBMPWriter.h>
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
 #include <vtkGDCMImageReader.h>
 #include <vtkGDCMImageWriter.h>
 #include <vtkGESignaReader.h>
-#include <vtkImageCast.h>
 #include <vtkImageData.h>
-#include <vtkImageShiftScale.h>
 #include <vtkJPEGReader.h>
 #include <vtkJPEGWriter.h>
 #include <vtkMetaImageReader.h>
 #include <vtkMetaImageWriter.h>
 #include <vtkMINCImageReader.h>
 #include <vtkMINCImageWriter.h>
+#include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNGReader.h>
 #include <vtkPNGWriter.h>
 #include <vtkPNMReader.h>
 #include <vtkPNMWriter.h>
+#include <vtkPointData.h>
 #include <vtkPostScriptWriter.h>
+#include <vtkSimpleCriticalSection.h>
 #include <vtkSmartPointer.h>
 #include <vtkTIFFReader.h>
 #include <vtkTIFFWriter.h>
+#include <vtkTypeTraits.h>
+#include <vtkVersion.h>
 #include <vtkXMLImageDataReader.h>
 #include <vtkXMLImageDataWriter.h>
+#include <vtk_zlib.h>
+
+// LZ4 has been a part of VTK since 8.1
+#if VTK_MAJOR_VERSION > 8 || (VTK_MAJOR_VERSION == 8 && VTK_MINOR_VERSION > 0)
+#define BIRCH_USE_LZ4
+#include <vtk_lz4.h>
+#endif
 
 // C++ includes
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageDataWriter);
 vtkCxxSetObjectMacro(vtkImageDataWriter, Writer, vtkAlgorithm);
@@ -58,6 +76,12 @@ vtkImageDataWriter::vtkImageDataWriter()
   this->Writer = NULL;
   this->ImageData = NULL;
   this->AutoDownCast = 0;
+  this->AbortExecute = 0;
+  this->Compressor = vtkImageDataWriter::DEFAULT;
+  this->CompressionLevel = 5;
+  this->NumberOfThreads = 0;
+  this->ScalarRange[0] = 1.0;
+  this->ScalarRange[1] = 0.0;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -289,217 +313,1115 @@ void vtkImageDataWriter::SetInputData(vtkImageData* input)
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
-void vtkImageDataWriter::Write()
+//
+// Type narrowing.  The scalar range is reduced over all components by a
+// pool of threads in one pass, the output type is chosen from it and the
+// scalars are then converted, again in parallel, in one pass into the
+// image handed to the writer.  An image whose type the writer accepts is
+// handed over as is.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
 {
-  // if the file name or writer are null simply return
-  if (this->FileName.empty() ||
-      NULL == this->Writer || NULL == this->ImageData)
+  struct vtkImageDataWriterJob
   {
-    return;
+    void* Input;
+    void* Output;                        // NULL when reducing the range
+    int InputType;
+    int OutputType;
+    vtkIdType NumberOfValues;
+    int NumberOfThreads;                 // 0 for the global default
+    double Shift;
+    double Scale;
+    std::vector<double> Minima;          // one per thread
+    std::vector<double> Maxima;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class IT>
+  void vtkImageDataWriterRange(const IT* in, vtkIdType count,
+    double* minimum, double* maximum)
+  {
+    double low = VTK_DOUBLE_MAX;
+    double high = VTK_DOUBLE_MIN;
+    for (const IT* end = in + count; in < end; ++in)
+    {
+      double value = static_cast<double>(*in);
+      // comparisons with NaN are false, so NaN is skipped
+      if (value < low) low = value;
+      if (value > high) high = value;
+    }
+    *minimum = low;
+    *maximum = high;
   }
 
-  vtkImageData* image = this->ImageData;
-  vtkNew<vtkImageCast> castFilter;
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class IT, class OT>
+  void vtkImageDataWriterConvert(const IT* in, OT* out, vtkIdType count,
+    double shift, double scale)
+  {
+    const IT* end = in + count;
+    if (0.0 == shift && 1.0 == scale)
+    {
+      // a plain cast, the range is known to fit the output type
+      for (; in < end; ++in, ++out)
+      {
+        *out = static_cast<OT>(*in);
+      }
+      return;
+    }
+
+    const double low = static_cast<double>(vtkTypeTraits<OT>::Min());
+    const double high = static_cast<double>(vtkTypeTraits<OT>::Max());
+    for (; in < end; ++in, ++out)
+    {
+      double value = (static_cast<double>(*in) + shift) * scale;
+      *out = static_cast<OT>(value < low ? low : (value > high ? high : value));
+    }
+  }
 
-  if (this->AutoDownCast)
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class IT>
+  void vtkImageDataWriterExecute(vtkImageDataWriterJob* job, const IT* in,
+    vtkIdType count, int thread)
   {
-    double range[2];
-    this->ImageData->GetScalarRange(range);
-    castFilter->SetInputData(this->ImageData);
+    if (NULL == job->Output)
+    {
+      vtkImageDataWriterRange(in, count,
+        &job->Minima[thread], &job->Maxima[thread]);
+      return;
+    }
+
+    void* output = job->Output;
+    switch (job->OutputType)
+    {
+      vtkTemplateMacro(vtkImageDataWriterConvert(in,
+        static_cast<VTK_TT*>(output) + (in - static_cast<IT*>(job->Input)),
+        count, job->Shift, job->Scale));
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataWriterJobThread(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkImageDataWriterJob* job =
+      static_cast<vtkImageDataWriterJob*>(info->UserData);
+
+    // each thread takes one contiguous run of values
+    vtkIdType first =
+      job->NumberOfValues * info->ThreadID / info->NumberOfThreads;
+    vtkIdType last =
+      job->NumberOfValues * (info->ThreadID + 1) / info->NumberOfThreads;
+
+    switch (job->InputType)
+    {
+      vtkTemplateMacro(vtkImageDataWriterExecute(job,
+        static_cast<VTK_TT*>(job->Input) + first, last - first,
+        info->ThreadID));
+    }
+
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataWriterRunJob(vtkImageDataWriterJob* job)
+  {
+    // small images are not worth the cost of starting threads
+    const vtkIdType valuesPerThread = 65536;
+    int maximumThreads = 0 < job->NumberOfThreads ? job->NumberOfThreads :
+      vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    int numberOfThreads = static_cast<int>(std::max<vtkIdType>(1,
+      std::min<vtkIdType>(maximumThreads,
+        job->NumberOfValues / valuesPerThread)));
+    job->Minima.assign(numberOfThreads, VTK_DOUBLE_MAX);
+    job->Maxima.assign(numberOfThreads, VTK_DOUBLE_MIN);
 
-    int type = this->ImageData->GetScalarType();
-    castFilter->SetOutputScalarType(type);
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(vtkImageDataWriterJobThread, job);
+    threader->SingleMethodExecute();
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // The range of all of the image's scalar values in one parallel pass
+  void vtkImageDataWriterGetRange(vtkImageDataWriterJob* job, double range[2])
+  {
+    job->Output = NULL;
+    vtkImageDataWriterRunJob(job);
+
+    range[0] = *std::min_element(job->Minima.begin(), job->Minima.end());
+    range[1] = *std::max_element(job->Maxima.begin(), job->Maxima.end());
+    if (range[0] > range[1])  // empty or all NaN
+    {
+      range[0] = range[1] = 0.0;
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // The narrowest type able to hold the range, or type if there is none
+  int vtkImageDataWriterNarrowestType(int type, const double range[2])
+  {
+    static const int integerTypes[] = {
+      VTK_UNSIGNED_CHAR, VTK_CHAR, VTK_UNSIGNED_SHORT, VTK_SHORT,
+      VTK_UNSIGNED_INT, VTK_INT, VTK_UNSIGNED_LONG, VTK_LONG };
 
     if (VTK_DOUBLE == type || VTK_FLOAT == type)
     {
-      if (VTK_FLOAT_MIN <= range[0] &&
-          VTK_FLOAT_MAX >= range[1])
+      return VTK_FLOAT_MIN <= range[0] && VTK_FLOAT_MAX >= range[1] ?
+        VTK_FLOAT : type;
+    }
+
+    for (size_t i = 0; i < sizeof(integerTypes) / sizeof(int); ++i)
+    {
+      if (vtkDataArray::GetDataTypeMin(integerTypes[i]) <= range[0] &&
+          vtkDataArray::GetDataTypeMax(integerTypes[i]) >= range[1])
       {
-        castFilter->SetOutputScalarTypeToFloat();
+        return integerTypes[i];
       }
     }
+    return -1;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Convert to type, shifting and scaling the range to fit if it does not
+  void vtkImageDataWriterFitRange(int type, const double range[2],
+    vtkImageDataWriterJob* job)
+  {
+    double minimum = vtkDataArray::GetDataTypeMin(type);
+    double maximum = vtkDataArray::GetDataTypeMax(type);
+    job->OutputType = type;
+    if (minimum <= range[0] && maximum >= range[1])
+    {
+      return;
+    }
+
+    job->Shift = -range[0];
+    if (maximum > (range[1] - range[0]))
+    {
+      job->Scale = 1.0;
+    }
     else
     {
-      if (VTK_UNSIGNED_CHAR_MIN <= range[0] &&
-          VTK_UNSIGNED_CHAR_MAX >= range[1])
+      job->Scale = maximum / (range[1] - range[0]);
+    }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // The type the writer is given scalars of the type as, the following
+  // image writers only support the listed scalar types:
+  // BMP, JPEG, PNM, PostScript => unsigned char
+  // IMG => unsigned short
+  // PNG => unsigned char, unsigned short
+  // TIFF => unsigned char, unsigned short, float
+  int vtkImageDataWriterSupportedType(vtkAlgorithm* writer, int type)
+  {
+    // The following writers only support unsigned char, force conversion
+    if (writer->IsA("vtkBMPWriter") ||
+        writer->IsA("vtkJPEGWriter") ||
+        writer->IsA("vtkPNMWriter") ||
+        writer->IsA("vtkPostScriptWriter"))
+    {
+      return VTK_UNSIGNED_CHAR;
+    }
+    // TIFF supports float, so if we have doubles convert to float
+    if (writer->IsA("vtkTIFFWriter") && VTK_DOUBLE == type)
+    {
+      return VTK_FLOAT;
+    }
+    // IMG, PNG and TIFF support unsigned shorts, so convert to that but only
+    // if the scalar type isn't supported
+    if ((writer->IsA("vtkIMGWriter") &&
+         VTK_UNSIGNED_SHORT != type) ||
+        (writer->IsA("vtkPNGWriter") &&
+         VTK_UNSIGNED_CHAR  != type &&
+         VTK_UNSIGNED_SHORT != type) ||
+        (writer->IsA("vtkTIFFWriter") &&
+         VTK_UNSIGNED_CHAR  != type &&
+         VTK_UNSIGNED_SHORT != type &&
+         VTK_FLOAT          != type))
+    {
+      return VTK_UNSIGNED_SHORT;
+    }
+    return type;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Whether the output type depends on the range: it is narrowed to the
+  // range, or the type has to be shifted and scaled to fit the writer
+  bool vtkImageDataWriterNeedsRange(
+    vtkAlgorithm* writer, int type, int autoDownCast)
+  {
+    int supportedType = vtkImageDataWriterSupportedType(writer, type);
+    return autoDownCast || (supportedType != type &&
+      (VTK_UNSIGNED_CHAR == supportedType ||
+       VTK_UNSIGNED_SHORT == supportedType));
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Slice export.  Each thread takes the next slice in turn, copies it out of
+// the volume as an x-y image and writes it with a writer of its own.  Only
+// the calling thread, which vtkMultiThreader runs as thread 0, reports
+// progress so that observers are never called from another thread.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  struct vtkImageDataWriterSliceJob
+  {
+    vtkImageDataWriter* Self;
+    vtkImageData* Input;
+    int Orientation;
+    double Range[2];                     // of the whole volume
+    int NumberOfSlices;
+    int NextSlice;
+    int WrittenSlices;
+    bool Failed;
+    std::string ErrorMessage;
+    vtkSimpleCriticalSection Lock;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // One slice of the input as an image lying in the x-y plane, the slice is
+  // given as an index into the input's extent.  An xy slice shares the
+  // input's memory, so the input must outlive the slice.
+  vtkSmartPointer<vtkImageData> vtkImageDataWriterExtractSlice(
+    vtkImageData* input, int orientation, int slice)
+  {
+    int u, v, w = orientation;
+    switch (w)
+    {
+      case 0: u = 1; v = 2; break;
+      case 1: u = 0; v = 2; break;
+      default: u = 0; v = 1; break;
+    }
+
+    int* extent = input->GetExtent();
+    double* spacing = input->GetSpacing();
+    double* origin = input->GetOrigin();
+    int columns = extent[2*u+1] - extent[2*u] + 1;
+    int rows = extent[2*v+1] - extent[2*v] + 1;
+    int components = input->GetNumberOfScalarComponents();
+
+    vtkSmartPointer<vtkImageData> output =
+      vtkSmartPointer<vtkImageData>::New();
+    output->SetExtent(0, columns - 1, 0, rows - 1, 0, 0);
+    output->SetSpacing(spacing[u], spacing[v], spacing[w]);
+    output->SetOrigin(
+      origin[u] + extent[2*u] * spacing[u],
+      origin[v] + extent[2*v] * spacing[v],
+      origin[w] + slice * spacing[w]);
+
+    int first[3];
+    first[u] = extent[2*u];
+    first[v] = extent[2*v];
+    first[w] = slice;
+    void* in = input->GetScalarPointer(first);
+
+    // an xy slice is already contiguous, so it is used in place
+    if (2 == w)
+    {
+      vtkDataArray* inputScalars = input->GetPointData()->GetScalars();
+      vtkSmartPointer<vtkDataArray> scalars;
+      scalars.TakeReference(
+        vtkDataArray::CreateDataArray(inputScalars->GetDataType()));
+      scalars->SetNumberOfComponents(components);
+      scalars->SetName(inputScalars->GetName());
+      scalars->SetVoidArray(
+        in, static_cast<vtkIdType>(columns) * rows * components, 1);
+      output->GetPointData()->SetScalars(scalars);
+      return output;
+    }
+
+    // otherwise gather the strided slice into a contiguous buffer
+    output->AllocateScalars(input->GetScalarType(), components);
+    const char* pixels = static_cast<const char*>(in);
+    char* out = static_cast<char*>(output->GetScalarPointer());
+
+    // increments are in scalar values, step through the input in bytes
+    vtkIdType* increments = input->GetIncrements();
+    size_t pixelSize = input->GetScalarSize() * components;
+    vtkIdType columnStep = increments[u] * input->GetScalarSize();
+    vtkIdType rowStep = increments[v] * input->GetScalarSize();
+    for (int j = 0; j < rows; ++j, pixels += rowStep)
+    {
+      if (0 == u)  // the rows are contiguous
       {
-        castFilter->SetOutputScalarTypeToUnsignedChar();
+        std::memcpy(out, pixels, columns * pixelSize);
+        out += columns * pixelSize;
+        continue;
       }
-      else if (VTK_CHAR_MIN <= range[0] &&
-               VTK_CHAR_MAX >= range[1])
+      const char* pixel = pixels;
+      for (int i = 0; i < columns; ++i, pixel += columnStep)
       {
-        castFilter->SetOutputScalarTypeToChar();
+        std::memcpy(out, pixel, pixelSize);
+        out += pixelSize;
       }
-      else if (VTK_UNSIGNED_SHORT_MIN <= range[0] &&
-               VTK_UNSIGNED_SHORT_MAX >= range[1])
+    }
+    return output;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataWriterSliceThread(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkImageDataWriterSliceJob* job =
+      static_cast<vtkImageDataWriterSliceJob*>(info->UserData);
+    int firstSlice = job->Input->GetExtent()[2*job->Orientation];
+
+    while (true)
+    {
+      job->Lock.Lock();
+      int slice = job->NextSlice++;
+      bool stop = job->Failed || job->Self->GetAbortExecute();
+      job->Lock.Unlock();
+      if (stop || slice >= job->NumberOfSlices)
       {
-        castFilter->SetOutputScalarTypeToUnsignedShort();
+        break;
       }
-      else if (VTK_SHORT_MIN <= range[0] &&
-               VTK_SHORT_MAX >= range[1])
+
+      std::string errorMessage;
+      try
       {
-        castFilter->SetOutputScalarTypeToShort();
+        vtkNew<vtkImageDataWriter> writer;
+        writer->SetFileName(
+          job->Self->GetSliceFileName(slice, job->NumberOfSlices).c_str());
+        writer->SetAutoDownCast(job->Self->GetAutoDownCast());
+        writer->SetScalarRange(job->Range);
+        writer->SetNumberOfThreads(1);
+        writer->SetCompressor(job->Self->GetCompressor());
+        writer->SetCompressionLevel(job->Self->GetCompressionLevel());
+        writer->SetInputData(job->Input);
+        writer->WriteSlice(job->Orientation, firstSlice + slice);
       }
-      else if (VTK_UNSIGNED_INT_MIN <= range[0] &&
-               VTK_UNSIGNED_INT_MAX >= range[1])
+      catch (std::exception& e)
       {
-        castFilter->SetOutputScalarTypeToUnsignedInt();
+        errorMessage = e.what();
       }
-      else if (VTK_INT_MIN <= range[0] &&
-               VTK_INT_MAX >= range[1])
+
+      job->Lock.Lock();
+      if (!errorMessage.empty())
       {
-        castFilter->SetOutputScalarTypeToInt();
+        job->Failed = true;
+        job->ErrorMessage = errorMessage;
       }
-      else if (VTK_UNSIGNED_INT_MIN <= range[0] &&
-               VTK_UNSIGNED_INT_MAX >= range[1])
+      else
       {
-        castFilter->SetOutputScalarTypeToUnsignedInt();
+        job->WrittenSlices++;
       }
-      else if (VTK_INT_MIN <= range[0] &&
-               VTK_INT_MAX >= range[1])
+      double progress =
+        static_cast<double>(job->WrittenSlices) / job->NumberOfSlices;
+      job->Lock.Unlock();
+
+      if (0 == info->ThreadID)
       {
-        castFilter->SetOutputScalarTypeToInt();
+        job->Self->InvokeEvent(vtkCommand::ProgressEvent, &progress);
       }
-      else if (VTK_UNSIGNED_LONG_MIN <= range[0] &&
-               VTK_UNSIGNED_LONG_MAX >= range[1])
+    }
+
+    return VTK_THREAD_RETURN_VALUE;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Parallel compression.  The image's scalars are divided into blocks
+// which a pool of threads compresses independently.  A .vti file is then
+// written as vtkXMLImageDataWriter writes appended raw data, a header of
+// block sizes followed by the blocks, which vtkXMLImageDataReader
+// decompresses block by block.  A .mha file holds one zlib stream, so its
+// blocks are raw deflate streams ended by a sync flush, the last by a
+// finish, which join up into one stream as pigz does it.  Only the calling
+// thread, which vtkMultiThreader runs as thread 0, reports progress.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  enum vtkImageDataWriterBlockFormat
+  {
+    vtkImageDataWriterZLibBlocks,
+    vtkImageDataWriterLZ4Blocks,
+    vtkImageDataWriterDeflateStream
+  };
+
+  struct vtkImageDataWriterCompressJob
+  {
+    vtkImageDataWriter* Self;
+    const unsigned char* Data;
+    vtkTypeUInt64 Size;
+    vtkTypeUInt64 BlockSize;
+    int NumberOfBlocks;
+    int Format;
+    int Level;
+    int NextBlock;
+    int CompressedBlocks;
+    bool Failed;
+    std::vector<std::vector<unsigned char> > Blocks;
+    vtkSimpleCriticalSection Lock;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  bool vtkImageDataWriterCompressBlock(
+    vtkImageDataWriterCompressJob* job, int block)
+  {
+    vtkTypeUInt64 first = block * job->BlockSize;
+    vtkTypeUInt64 size = std::min(job->BlockSize, job->Size - first);
+    const unsigned char* in = job->Data + first;
+    std::vector<unsigned char>& out = job->Blocks[block];
+
+    if (vtkImageDataWriterZLibBlocks == job->Format)
+    {
+      uLongf length = compressBound(static_cast<uLong>(size));
+      out.resize(length);
+      if (Z_OK != compress2(&out[0], &length, in,
+            static_cast<uLong>(size), job->Level))
       {
-        castFilter->SetOutputScalarTypeToUnsignedLong();
+        return false;
       }
-      else if (VTK_LONG_MIN <= range[0] &&
-               VTK_LONG_MAX >= range[1])
+      out.resize(length);
+      return true;
+    }
+
+#ifdef BIRCH_USE_LZ4
+    if (vtkImageDataWriterLZ4Blocks == job->Format)
+    {
+      // the same acceleration vtkLZ4DataCompressor derives from its level
+      int bound = LZ4_compressBound(static_cast<int>(size));
+      out.resize(bound);
+      int length = LZ4_compress_fast(reinterpret_cast<const char*>(in),
+        reinterpret_cast<char*>(&out[0]), static_cast<int>(size), bound,
+        10 - job->Level);
+      if (0 >= length)
       {
-        castFilter->SetOutputScalarTypeToLong();
+        return false;
       }
-      else
+      out.resize(length);
+      return true;
+    }
+#endif
+
+    // a raw deflate stream, ended by a sync flush so that the next block's
+    // stream follows on from it on a byte boundary
+    bool last = block == job->NumberOfBlocks - 1;
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (Z_OK != deflateInit2(&stream, job->Level, Z_DEFLATED, -15, 8,
+          Z_DEFAULT_STRATEGY))
+    {
+      return false;
+    }
+    // the bound allows for a finish, a sync flush adds a few bytes more
+    out.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+    stream.next_in = const_cast<Bytef*>(in);
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = &out[0];
+    stream.avail_out = static_cast<uInt>(out.size());
+    int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return (last ? Z_STREAM_END : Z_OK) == result && 0 == stream.avail_in;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  VTK_THREAD_RETURN_TYPE vtkImageDataWriterCompressThread(void* arg)
+  {
+    vtkMultiThreader::ThreadInfo* info =
+      static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkImageDataWriterCompressJob* job =
+      static_cast<vtkImageDataWriterCompressJob*>(info->UserData);
+
+    while (true)
+    {
+      job->Lock.Lock();
+      int block = job->NextBlock++;
+      bool stop = job->Failed || job->Self->GetAbortExecute();
+      job->Lock.Unlock();
+      if (stop || block >= job->NumberOfBlocks)
       {
-        vtkWarningMacro(
-          "Error: range cannot be casted down from "
-          << range[0] <<", " << range[1]);
+        break;
+      }
+
+      bool success = vtkImageDataWriterCompressBlock(job, block);
+
+      job->Lock.Lock();
+      if (!success)
+      {
+        job->Failed = true;
+      }
+      job->CompressedBlocks++;
+      double progress =
+        static_cast<double>(job->CompressedBlocks) / job->NumberOfBlocks;
+      job->Lock.Unlock();
+
+      if (0 == info->ThreadID)
+      {
+        job->Self->InvokeEvent(vtkCommand::ProgressEvent, &progress);
       }
     }
 
-    castFilter->Update();
-    image = castFilter->GetOutput();
+    return VTK_THREAD_RETURN_VALUE;
   }
 
-  // Ok, we have a valid file and writer, process based on writer type
-  if (this->Writer->IsA("vtkXMLImageDataWriter"))
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Compress the job's data, returns false on abort
+  bool vtkImageDataWriterCompress(vtkImageDataWriterCompressJob* job)
   {
-    // we know that Writer must be a vtkXMLImageDataWriter object
-    vtkXMLImageDataWriter* XMLWriter =
-      vtkXMLImageDataWriter::SafeDownCast(this->Writer);
-    XMLWriter->SetFileName(this->FileName.c_str());
-    XMLWriter->SetInputData(image);
-    XMLWriter->Write();
+    // large blocks compress better and keep the threads busy for longer
+    job->BlockSize = 1 << 20;
+    job->NumberOfBlocks = static_cast<int>(
+      (job->Size + job->BlockSize - 1) / job->BlockSize);
+    job->NextBlock = 0;
+    job->CompressedBlocks = 0;
+    job->Failed = false;
+    job->Blocks.assign(job->NumberOfBlocks, std::vector<unsigned char>());
+
+    int maximumThreads = job->Self->GetNumberOfThreads();
+    if (0 >= maximumThreads)
+    {
+      maximumThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+    vtkNew<vtkMultiThreader> threader;
+    threader->SetNumberOfThreads(
+      std::max(1, std::min(maximumThreads, job->NumberOfBlocks)));
+    threader->SetSingleMethod(vtkImageDataWriterCompressThread, job);
+    threader->SingleMethodExecute();
+
+    if (job->Failed)
+    {
+      std::stringstream stream;
+      stream << __FILE__;
+      stream << " ";
+      stream << __LINE__;
+      stream << " ";
+      stream << "Unable to compress the image data.";
+      throw std::runtime_error(stream.str());
+    }
+    return !job->Self->GetAbortExecute();
   }
-  else  // if we get here then the reader is some form of vtkImageWriter
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataWriterOpen(std::ofstream& file, const std::string& name)
   {
-    // we know that Writer must be a vtkImageWriter object
-    vtkImageWriter* imageWriter = vtkImageWriter::SafeDownCast(this->Writer);
-    imageWriter->SetFileName(this->FileName.c_str());
+    file.open(name.c_str(), std::ios::out | std::ios::binary);
+    if (!file)
+    {
+      std::stringstream stream;
+      stream << __FILE__;
+      stream << " ";
+      stream << __LINE__;
+      stream << " ";
+      stream << "Unable to open '" << name << "' for writing.";
+      throw std::runtime_error(stream.str());
+    }
+    file << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void vtkImageDataWriterClose(std::ofstream& file, const std::string& name)
+  {
+    file.close();
+    if (file.fail())
+    {
+      std::stringstream stream;
+      stream << __FILE__;
+      stream << " ";
+      stream << __LINE__;
+      stream << " ";
+      stream << "Unable to write '" << name << "'.";
+      throw std::runtime_error(stream.str());
+    }
+  }
 
-    double range[2];
-    image->GetScalarRange(range);
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Write a .vti file with compressed appended raw data
+  void vtkImageDataWriterWriteXML(vtkImageDataWriterCompressJob* job,
+    vtkImageData* image, const std::string& fileName)
+  {
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    int type = scalars->GetDataType();
+    bool signedType = 0.0 > vtkDataArray::GetDataTypeMin(type);
+    int bits = 8 * scalars->GetDataTypeSize();
+    bool floatType = VTK_FLOAT == type || VTK_DOUBLE == type;
+    std::string name = scalars->GetName() ? scalars->GetName() : "scalars";
+    int* extent = image->GetExtent();
+    double* origin = image->GetOrigin();
+    double* spacing = image->GetSpacing();
 
-    int scalarType = image->GetScalarType();
+    std::ofstream file;
+    vtkImageDataWriterOpen(file, fileName);
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"";
+#ifdef VTK_WORDS_BIGENDIAN
+    file << "BigEndian";
+#else
+    file << "LittleEndian";
+#endif
+    file << "\" header_type=\"UInt64\" compressor=\"";
+    file << (vtkImageDataWriterLZ4Blocks == job->Format ?
+      "vtkLZ4DataCompressor" : "vtkZLibDataCompressor") << "\">\n";
+    file << "  <ImageData WholeExtent=\""
+         << extent[0] << " " << extent[1] << " " << extent[2] << " "
+         << extent[3] << " " << extent[4] << " " << extent[5]
+         << "\" Origin=\""
+         << origin[0] << " " << origin[1] << " " << origin[2]
+         << "\" Spacing=\""
+         << spacing[0] << " " << spacing[1] << " " << spacing[2] << "\">\n";
+    file << "  <Piece Extent=\""
+         << extent[0] << " " << extent[1] << " " << extent[2] << " "
+         << extent[3] << " " << extent[4] << " " << extent[5] << "\">\n";
+    file << "    <PointData Scalars=\"" << name << "\">\n";
+    file << "      <DataArray type=\""
+         << (floatType ? "Float" : (signedType ? "Int" : "UInt")) << bits
+         << "\" Name=\"" << name << "\" NumberOfComponents=\""
+         << scalars->GetNumberOfComponents()
+         << "\" format=\"appended\" offset=\"0\"/>\n";
+    file << "    </PointData>\n";
+    file << "    <CellData>\n";
+    file << "    </CellData>\n";
+    file << "  </Piece>\n";
+    file << "  </ImageData>\n";
+    file << "  <AppendedData encoding=\"raw\">\n";
+    file << "   _";
 
-    // the following image writers only support the listed scalar types:
-    // BMP, JPEG, PNM, PostScript => unsigned char
-    // IMG => unsigned short
-    // PNG => unsigned char, unsigned short
-    // TIFF => unsigned char, unsigned short, float
+    // block count, block size, size of a partial last block, block sizes
+    std::vector<vtkTypeUInt64> header;
+    header.push_back(job->NumberOfBlocks);
+    header.push_back(job->BlockSize);
+    header.push_back(job->Size % job->BlockSize);
+    for (int i = 0; i < job->NumberOfBlocks; ++i)
+    {
+      header.push_back(job->Blocks[i].size());
+    }
+    file.write(reinterpret_cast<const char*>(&header[0]),
+      header.size() * sizeof(vtkTypeUInt64));
+    for (int i = 0; i < job->NumberOfBlocks; ++i)
+    {
+      file.write(reinterpret_cast<const char*>(&job->Blocks[i][0]),
+        job->Blocks[i].size());
+    }
 
-    // The following writers only support unsigned char, force conversion
-    if ((this->Writer->IsA("vtkBMPWriter") ||
-         this->Writer->IsA("vtkJPEGWriter") ||
-         this->Writer->IsA("vtkPNMWriter") ||
-         this->Writer->IsA("vtkPostScriptWriter")) &&
-         VTK_UNSIGNED_CHAR != scalarType)
-    {
-      if (VTK_UNSIGNED_CHAR_MIN <= range[0] &&
-          VTK_UNSIGNED_CHAR_MAX >= range[1])
-      {
-        vtkNew<vtkImageCast> convertFilter;
-        convertFilter->SetOutputScalarTypeToUnsignedChar();
-        convertFilter->SetInputData(image);
-        imageWriter->SetInputConnection(convertFilter->GetOutputPort());
-      }
-      else
-      {
-        vtkNew<vtkImageShiftScale> convertFilter;
-        convertFilter->SetOutputScalarTypeToUnsignedChar();
-        convertFilter->SetShift(-range[0]);
-        if (VTK_UNSIGNED_CHAR_MAX > (range[1]-range[0]))
-        {
-          convertFilter->SetScale(1);
-        }
-        else
-        {
-          convertFilter->SetScale(VTK_UNSIGNED_CHAR_MAX/(range[1] - range[0]));
-       }
-        convertFilter->SetInputData(image);
-        imageWriter->SetInputConnection(convertFilter->GetOutputPort());
-      }
+    file << "\n  </AppendedData>\n";
+    file << "</VTKFile>\n";
+    vtkImageDataWriterClose(file, fileName);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Write a .mha file holding the joined deflate blocks as a zlib stream
+  void vtkImageDataWriterWriteMetaImage(vtkImageDataWriterCompressJob* job,
+    vtkImageData* image, const std::string& fileName)
+  {
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    int type = scalars->GetDataType();
+    bool signedType = 0.0 > vtkDataArray::GetDataTypeMin(type);
+    std::string elementType;
+    switch (scalars->GetDataTypeSize())
+    {
+      case 1: elementType = signedType ? "MET_CHAR" : "MET_UCHAR"; break;
+      case 2: elementType = signedType ? "MET_SHORT" : "MET_USHORT"; break;
+      case 4: elementType = signedType ? "MET_INT" : "MET_UINT"; break;
+      default:
+        elementType = signedType ? "MET_LONG_LONG" : "MET_ULONG_LONG"; break;
     }
-    // TIFF supports float, so if we have doubles convert to float
-    else if (this->Writer->IsA("vtkTIFFWriter") &&
-      VTK_DOUBLE == scalarType)
+    if (VTK_FLOAT == type) elementType = "MET_FLOAT";
+    if (VTK_DOUBLE == type) elementType = "MET_DOUBLE";
+
+    // a zlib header, the blocks and the adler-32 checksum of the data
+    unsigned char head[2] = { 0x78, 0x9c };
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (vtkTypeUInt64 first = 0; first < job->Size; first += job->BlockSize)
     {
-      vtkNew<vtkImageCast> convertFilter;
-      convertFilter->SetOutputScalarTypeToFloat();
-      convertFilter->SetInputData(image);
-      imageWriter->SetInputConnection(convertFilter->GetOutputPort());
+      adler = adler32(adler, job->Data + first,
+        static_cast<uInt>(std::min(job->BlockSize, job->Size - first)));
     }
-    // IMG, PNG and TIFF support unsigned shorts, so convert to that but only
-    // if the scalar type isn't supported
-    else if ((this->Writer->IsA("vtkIMGWriter") &&
-              VTK_UNSIGNED_SHORT != scalarType) ||
-             (this->Writer->IsA("vtkPNGWriter") &&
-              VTK_UNSIGNED_CHAR  != scalarType &&
-              VTK_UNSIGNED_SHORT != scalarType) ||
-             (this->Writer->IsA("vtkTIFFWriter") &&
-              VTK_UNSIGNED_CHAR  != scalarType &&
-              VTK_UNSIGNED_SHORT != scalarType &&
-              VTK_FLOAT          != scalarType))
-    {
-      if (VTK_UNSIGNED_SHORT_MIN <= range[0] &&
-          VTK_UNSIGNED_SHORT_MAX >= range[1])
+    unsigned char tail[4] = {
+      static_cast<unsigned char>((adler >> 24) & 0xff),
+      static_cast<unsigned char>((adler >> 16) & 0xff),
+      static_cast<unsigned char>((adler >> 8) & 0xff),
+      static_cast<unsigned char>(adler & 0xff) };
+    vtkTypeUInt64 compressedSize = sizeof(head) + sizeof(tail);
+    for (int i = 0; i < job->NumberOfBlocks; ++i)
+    {
+      compressedSize += job->Blocks[i].size();
+    }
+
+    // the offset is that of the first voxel, as vtkMetaImageWriter has it
+    int* extent = image->GetExtent();
+    double* origin = image->GetOrigin();
+    double* spacing = image->GetSpacing();
+
+    std::ofstream file;
+    vtkImageDataWriterOpen(file, fileName);
+    file << "ObjectType = Image\n";
+    file << "NDims = 3\n";
+    file << "BinaryData = True\n";
+#ifdef VTK_WORDS_BIGENDIAN
+    file << "BinaryDataByteOrderMSB = True\n";
+#else
+    file << "BinaryDataByteOrderMSB = False\n";
+#endif
+    file << "CompressedData = True\n";
+    file << "CompressedDataSize = " << compressedSize << "\n";
+    file << "TransformMatrix = 1 0 0 0 1 0 0 0 1\n";
+    file << "Offset = "
+         << origin[0] + extent[0] * spacing[0] << " "
+         << origin[1] + extent[2] * spacing[1] << " "
+         << origin[2] + extent[4] * spacing[2] << "\n";
+    file << "CenterOfRotation = 0 0 0\n";
+    file << "ElementSpacing = "
+         << spacing[0] << " " << spacing[1] << " " << spacing[2] << "\n";
+    file << "DimSize = "
+         << extent[1] - extent[0] + 1 << " "
+         << extent[3] - extent[2] + 1 << " "
+         << extent[5] - extent[4] + 1 << "\n";
+    if (1 < scalars->GetNumberOfComponents())
+    {
+      file << "ElementNumberOfChannels = "
+           << scalars->GetNumberOfComponents() << "\n";
+    }
+    file << "ElementType = " << elementType << "\n";
+    file << "ElementDataFile = LOCAL\n";
+
+    file.write(reinterpret_cast<const char*>(head), sizeof(head));
+    for (int i = 0; i < job->NumberOfBlocks; ++i)
+    {
+      file.write(reinterpret_cast<const char*>(&job->Blocks[i][0]),
+        job->Blocks[i].size());
+    }
+    file.write(reinterpret_cast<const char*>(tail), sizeof(tail));
+    vtkImageDataWriterClose(file, fileName);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // Write a compressed .vti or .mha file, returns false if the file is of
+  // another type, which is left to its file writer
+  bool vtkImageDataWriterWriteCompressed(vtkImageDataWriter* self,
+    vtkImageData* image, const std::string& fileName)
+  {
+    std::string extension = Birch::Utilities::getFileExtension(
+      Birch::Utilities::toLower(fileName));
+    vtkDataArray* scalars = image->GetPointData()->GetScalars();
+    int compressor = self->GetCompressor();
+    if ((".vti" != extension && ".mha" != extension) || NULL == scalars ||
+        0 == scalars->GetNumberOfTuples() ||
+        (vtkImageDataWriter::ZLIB != compressor &&
+         vtkImageDataWriter::LZ4 != compressor))
+    {
+      return false;
+    }
+
+    vtkImageDataWriterCompressJob job;
+    job.Self = self;
+    job.Data = static_cast<const unsigned char*>(scalars->GetVoidPointer(0));
+    job.Size = static_cast<vtkTypeUInt64>(scalars->GetNumberOfTuples()) *
+      scalars->GetNumberOfComponents() * scalars->GetDataTypeSize();
+    job.Level = self->GetCompressionLevel();
+    job.Format = vtkImageDataWriterZLibBlocks;
+    if (".mha" == extension)
+    {
+      job.Format = vtkImageDataWriterDeflateStream;
+    }
+#ifdef BIRCH_USE_LZ4
+    else if (vtkImageDataWriter::LZ4 == compressor)
+    {
+      job.Format = vtkImageDataWriterLZ4Blocks;
+    }
+#endif
+    if (vtkImageDataWriter::LZ4 == compressor &&
+        vtkImageDataWriterLZ4Blocks != job.Format)
+    {
+      job.Level = 1;
+    }
+
+    self->InvokeEvent(vtkCommand::StartEvent);
+    if (vtkImageDataWriterCompress(&job))
+    {
+      if (".mha" == extension)
       {
-        vtkNew<vtkImageCast> convertFilter;
-        convertFilter->SetOutputScalarTypeToUnsignedShort();
-        convertFilter->SetInputData(image);
-        imageWriter->SetInputConnection(convertFilter->GetOutputPort());
+        vtkImageDataWriterWriteMetaImage(&job, image, fileName);
       }
       else
       {
-        vtkNew<vtkImageShiftScale> convertFilter;
-        convertFilter->SetOutputScalarTypeToUnsignedShort();
-        convertFilter->SetShift(-range[0]);
-        if ((range[1]-range[0]) < VTK_UNSIGNED_SHORT_MAX)
-        {
-          convertFilter->SetScale(1);
-        }
-        else
-        {
-          convertFilter->SetScale(VTK_UNSIGNED_SHORT_MAX/(range[1] - range[0]));
-        }
-        convertFilter->SetInputData(image);
-        imageWriter->SetInputConnection(convertFilter->GetOutputPort());
+        vtkImageDataWriterWriteXML(&job, image, fileName);
       }
     }
-    // otherwise leave the type alone
+    self->InvokeEvent(vtkCommand::EndEvent);
+    return true;
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataWriter::Write()
+{
+  // if the file name or writer are null simply return
+  if (this->FileName.empty() ||
+      NULL == this->Writer || NULL == this->ImageData)
+  {
+    return;
+  }
+
+  vtkImageData* image = this->ImageData;
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+
+  vtkImageDataWriterJob job;
+  job.Input = NULL;
+  job.InputType = image->GetScalarType();
+  job.OutputType = job.InputType;
+  job.NumberOfValues = 0;
+  job.NumberOfThreads = this->NumberOfThreads;
+  job.Shift = 0.0;
+  job.Scale = 1.0;
+  if (scalars)
+  {
+    job.Input = scalars->GetVoidPointer(0);
+    job.InputType = scalars->GetDataType();
+    job.OutputType = job.InputType;
+    job.NumberOfValues =
+      scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents();
+  }
+
+  // the one pass over the input needed to choose the output type, made
+  // only if the type is narrowed or has to fit the writer and the range is
+  // not given
+  double range[2] = {0.0, 0.0};
+  if (0 < job.NumberOfValues && vtkImageDataWriterNeedsRange(
+        this->Writer, job.InputType, this->AutoDownCast))
+  {
+    if (this->ScalarRange[0] <= this->ScalarRange[1])
+    {
+      range[0] = this->ScalarRange[0];
+      range[1] = this->ScalarRange[1];
+    }
+    else
+    {
+      vtkImageDataWriterGetRange(&job, range);
+    }
+  }
+
+  if (this->AutoDownCast && 0 < job.NumberOfValues)
+  {
+    int type = vtkImageDataWriterNarrowestType(job.InputType, range);
+    if (-1 == type)
+    {
+      vtkWarningMacro(
+        "Error: range cannot be casted down from "
+        << range[0] <<", " << range[1]);
+    }
     else
     {
-      imageWriter->SetInputData(image);
+      job.OutputType = type;
+    }
+  }
+
+  int scalarType =
+    vtkImageDataWriterSupportedType(this->Writer, job.OutputType);
+  if (VTK_UNSIGNED_CHAR == scalarType || VTK_UNSIGNED_SHORT == scalarType)
+  {
+    if (scalarType != job.OutputType)
+    {
+      vtkImageDataWriterFitRange(scalarType, range, &job);
+    }
+  }
+  else
+  {
+    job.OutputType = scalarType;
+  }
+
+  // convert in one pass into the image given to the writer
+  vtkSmartPointer<vtkImageData> converted;
+  if (0 < job.NumberOfValues && (job.OutputType != job.InputType ||
+      0.0 != job.Shift || 1.0 != job.Scale))
+  {
+    converted = vtkSmartPointer<vtkImageData>::New();
+    converted->CopyStructure(image);
+    converted->AllocateScalars(
+      job.OutputType, scalars->GetNumberOfComponents());
+    converted->GetPointData()->GetScalars()->SetName(scalars->GetName());
+    job.Output = converted->GetScalarPointer();
+    vtkImageDataWriterRunJob(&job);
+    image = converted;
+  }
+
+  // compressed .vti and .mha files are compressed in parallel here
+  if (vtkImageDataWriterWriteCompressed(this, image, this->FileName))
+  {
+    return;
+  }
+
+  // Ok, we have a valid file and writer, process based on writer type
+  if (this->Writer->IsA("vtkXMLImageDataWriter"))
+  {
+    // we know that Writer must be a vtkXMLImageDataWriter object
+    vtkXMLImageDataWriter* XMLWriter =
+      vtkXMLImageDataWriter::SafeDownCast(this->Writer);
+    XMLWriter->SetFileName(this->FileName.c_str());
+    if (vtkImageDataWriter::NONE == this->Compressor)
+    {
+      XMLWriter->SetCompressor(NULL);
+      XMLWriter->SetDataModeToAppended();
+      XMLWriter->EncodeAppendedDataOff();
     }
+    XMLWriter->SetInputData(image);
+    XMLWriter->Write();
+  }
+  else  // if we get here then the reader is some form of vtkImageWriter
+  {
+    // we know that Writer must be a vtkImageWriter object
+    vtkImageWriter* imageWriter = vtkImageWriter::SafeDownCast(this->Writer);
+    imageWriter->SetFileName(this->FileName.c_str());
 
+    // other MetaImage files are compressed by the file writer itself
+    vtkMetaImageWriter* metaImageWriter =
+      vtkMetaImageWriter::SafeDownCast(this->Writer);
+    if (metaImageWriter && vtkImageDataWriter::DEFAULT != this->Compressor)
+    {
+      metaImageWriter->SetCompression(
+        vtkImageDataWriter::NONE != this->Compressor);
+    }
+    imageWriter->SetInputData(image);
     imageWriter->Write();
   }
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataWriter::WriteSlice(int orientation, int slice)
+{
+  // if the input is null or the slice is outside of it simply return
+  vtkImageData* input = this->ImageData;
+  if (NULL == input || 0 > orientation || 2 < orientation ||
+      NULL == input->GetScalarPointer())
+  {
+    return;
+  }
+  int* extent = input->GetExtent();
+  if (slice < extent[2*orientation] || slice > extent[2*orientation+1])
+  {
+    return;
+  }
+
+  // write the slice in place of the input, keeping the input referenced
+  vtkSmartPointer<vtkImageData> volume = input;
+  this->SetInputData(
+    vtkImageDataWriterExtractSlice(volume, orientation, slice));
+  try
+  {
+    this->Write();
+  }
+  catch (...)
+  {
+    this->SetInputData(volume);
+    throw;
+  }
+  this->SetInputData(volume);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+std::string vtkImageDataWriter::GetSliceFileName(
+  int slice, int numberOfSlices)
+{
+  int digits = 1;
+  for (int n = numberOfSlices - 1; 10 <= n; n /= 10)
+  {
+    digits++;
+  }
+
+  std::string extension = Birch::Utilities::getFileExtension(this->FileName);
+  std::stringstream stream;
+  stream << this->FileName.substr(0, this->FileName.size() - extension.size());
+  stream << "_" << std::setfill('0') << std::setw(std::max(3, digits));
+  stream << slice << extension;
+  return stream.str();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageDataWriter::WriteSlices(int orientation)
+{
+  // if the file name, writer or input are null simply return
+  if (this->FileName.empty() || NULL == this->Writer ||
+      NULL == this->ImageData || 0 > orientation || 2 < orientation)
+  {
+    return 0;
+  }
+
+  int* extent = this->ImageData->GetExtent();
+  vtkImageDataWriterSliceJob job;
+  job.Self = this;
+  job.Input = this->ImageData;
+  job.Orientation = orientation;
+  job.NumberOfSlices = extent[2*orientation+1] - extent[2*orientation] + 1;
+  job.NextSlice = 0;
+  job.WrittenSlices = 0;
+  job.Failed = false;
+  if (0 >= job.NumberOfSlices || NULL == this->ImageData->GetScalarPointer())
+  {
+    return 0;
+  }
+
+  // the range of the whole volume, from which every slice's writer chooses
+  // the same type, shift and scale, found once by all of the threads if
+  // the type depends on it and it is not given
+  vtkDataArray* scalars = this->ImageData->GetPointData()->GetScalars();
+  job.Range[0] = this->ScalarRange[0];
+  job.Range[1] = this->ScalarRange[1];
+  if (job.Range[0] > job.Range[1] && vtkImageDataWriterNeedsRange(
+        this->Writer, scalars->GetDataType(), this->AutoDownCast))
+  {
+    vtkImageDataWriterJob rangeJob;
+    rangeJob.Input = scalars->GetVoidPointer(0);
+    rangeJob.InputType = scalars->GetDataType();
+    rangeJob.NumberOfValues =
+      scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents();
+    rangeJob.NumberOfThreads = this->NumberOfThreads;
+    vtkImageDataWriterGetRange(&rangeJob, job.Range);
+  }
+
+  this->InvokeEvent(vtkCommand::StartEvent);
+  vtkNew<vtkMultiThreader> threader;
+  threader->SetNumberOfThreads(std::min(
+    vtkMultiThreader::GetGlobalDefaultNumberOfThreads(), job.NumberOfSlices));
+  threader->SetSingleMethod(vtkImageDataWriterSliceThread, &job);
+  threader->SingleMethodExecute();
+  this->InvokeEvent(vtkCommand::EndEvent);
+
+  if (job.Failed)
+  {
+    std::stringstream stream;
+    stream << __FILE__;
+    stream << " ";
+    stream << __LINE__;
+    stream << " ";
+    stream << "Unable to write slices: " << job.ErrorMessage;
+    throw std::runtime_error(stream.str());
+  }
+  return job.WrittenSlices;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataWriter::SetCompressionProfileToFastWrite()
+{
+  this->SetCompressor(vtkImageDataWriter::LZ4);
+  this->SetCompressionLevel(1);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageDataWriter::SetCompressionProfileToSmallFile()
+{
+  this->SetCompressor(vtkImageDataWriter::ZLIB);
+  this->SetCompressionLevel(9);
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkImageDataWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "FileName: " << this->FileName << "\n";
+  os << indent << "AutoDownCast: " << this->AutoDownCast << "\n";
+  os << indent << "Compressor: " << this->Compressor << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "ScalarRange: " << this->ScalarRange[0] << ", "
+     << this->ScalarRange[1] << "\n";
 }
@@ -59,6 +59,34 @@ class vtkImageDataWriter : public vtkObject
     //  Write data to disk.
     void Write();
 
+    // Description:
+    // Write one slice of the input along an axis (0 = YZ, 1 = XZ, 2 = XY),
+    // given as an index into the input's extent, as a 2D image.  The slice
+    // is read straight out of the input into the x-y plane of the image
+    // that is written, an XY slice is written without copying it at all.
+    void WriteSlice(int orientation, int slice);
+
+    // Description:
+    // Write every slice of the input along an axis (0 = YZ, 1 = XZ, 2 = XY)
+    // to a file of its own, named by GetSliceFileName.  Slices are extracted,
+    // encoded and written by a pool of threads.  Start, progress and end
+    // events are invoked from the calling thread, and no further slices
+    // are written once AbortExecute is set.  Returns the number of slices
+    // written.
+    int WriteSlices(int orientation);
+
+    // Description:
+    // The name of the file WriteSlices writes a slice to, the file name with
+    // the zero-padded slice number before the extension (eg. image_007.png).
+    std::string GetSliceFileName(int slice, int numberOfSlices);
+
+    // Description:
+    // Set/get the flag which stops WriteSlices.  It is not cleared when an
+    // export starts, so that an abort which comes first is not lost.
+    vtkSetMacro(AbortExecute, int);
+    vtkGetMacro(AbortExecute, int);
+    vtkBooleanMacro(AbortExecute, int);
+
     // Description:
     // Before trying to do anything with the named file, check if it is in fact
     // writable by this object.
@@ -72,6 +100,53 @@ class vtkImageDataWriter : public vtkObject
     vtkGetMacro(AutoDownCast, int);
     vtkBooleanMacro(AutoDownCast, int);
 
+    // Description:
+    // Set/get the compression of .vti and MetaImage files.  DEFAULT leaves
+    // the file writers' own settings, NONE writes uncompressed raw data.
+    // ZLIB and LZ4 compressed .vti and .mha files are written in blocks
+    // which are compressed in parallel, .vti files as VTK's XML writer would
+    // write them and .mha files as one zlib stream.  LZ4 is not supported
+    // by MetaImage, nor by VTK before 8.1, zlib at level 1 is used instead.
+    enum CompressorType
+    {
+      DEFAULT = 0,
+      NONE,
+      ZLIB,
+      LZ4
+    };
+    vtkSetClampMacro(Compressor, int, DEFAULT, LZ4);
+    vtkGetMacro(Compressor, int);
+
+    // Description:
+    // Set/get the compression level, from 1 (fastest) to 9 (smallest).
+    // Default is 5.
+    vtkSetClampMacro(CompressionLevel, int, 1, 9);
+    vtkGetMacro(CompressionLevel, int);
+
+    // Description:
+    // Set/get the number of threads which convert and compress the scalars,
+    // 0 for the global default number of threads.  Default is 0.
+    vtkSetClampMacro(NumberOfThreads, int, 0, VTK_INT_MAX);
+    vtkGetMacro(NumberOfThreads, int);
+
+    // Description:
+    // Set/get the scalar range the output type, shift and scale are chosen
+    // from in place of the range of the input, which is then not scanned.
+    // WriteSlices gives every slice the range of the whole volume, so that
+    // all of the slices are written alike.  A minimum above the maximum,
+    // the default, uses the range of the input.  The range is only used,
+    // and the input only scanned, with AutoDownCast on or when the writer
+    // needs the scalars shifted and scaled to unsigned char (BMP, JPEG, PNM,
+    // PostScript) or unsigned short (IMG, PNG, TIFF).
+    vtkSetVector2Macro(ScalarRange, double);
+    vtkGetVector2Macro(ScalarRange, double);
+
+    // Description:
+    // Choose the compression for fast writes (LZ4, level 1) or for small
+    // files (zlib, level 9).
+    void SetCompressionProfileToFastWrite();
+    void SetCompressionProfileToSmallFile();
+
   protected:
     // Constructor and destructor
     vtkImageDataWriter();
@@ -86,6 +161,11 @@ class vtkImageDataWriter : public vtkObject
     vtkAlgorithm* Writer;
     vtkImageData* ImageData;
     int AutoDownCast;
+    int AbortExecute;
+    int Compressor;
+    int CompressionLevel;
+    int NumberOfThreads;
+    double ScalarRange[2];
 
   private:
     vtkImageDataWriter(const vtkImageDataWriter&);  // Not implemented.
@@ -75,7 +75,8 @@ int vtkImageSharpen::RequestData(
     return 0;
   }
 
-  // Set the extent of the output and allocate memory.
+  // Set the extent of the output, its scalars are those of the final
+  // intermediate image rather than a separate allocation
   output->SetExtent(
     outInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()));
   int type = input->GetScalarType();
@@ -84,9 +85,15 @@ int vtkImageSharpen::RequestData(
     vtkErrorMacro("Float or double scalar type not supported");
     return 0;
   }
-  output->AllocateScalars(type, 1);
   this->SimpleExecute(input, output);
 
+  // an abort can come before the output takes over the final scalars or
+  // part way through matching them, so leave no partial result behind
+  if (this->AbortExecute)
+  {
+    output->Initialize();
+  }
+
   return 1;
 }
 
@@ -107,7 +114,7 @@ void vtkImageSharpenExecute(vtkImageSharpen* self,
   weight = 0. > weight ? fabs(weight) : weight;
   if (0. == weight)
   {
-    output->DeepCopy(input);
+    output->ShallowCopy(input);
     return;
   }
 
@@ -160,8 +167,9 @@ void vtkImageSharpenExecute(vtkImageSharpen* self,
   self->UpdateProgress(currentProgress);  //  3 / 10
   if (self->AbortExecute) { return; }
 
+  // intermediates are shared, not copied, none is modified in place
   vtkNew<vtkImageData> smooth1;
-  smooth1->DeepCopy(smoother->GetOutput());
+  smooth1->ShallowCopy(smoother->GetOutput());
 
   // compute the difference of gaussians
   //
@@ -188,7 +196,7 @@ void vtkImageSharpenExecute(vtkImageSharpen* self,
   if (self->AbortExecute) { return; }
 
   vtkNew<vtkImageData> orig;
-  orig->DeepCopy(caster->GetOutput());
+  orig->ShallowCopy(caster->GetOutput());
 
   vtkNew<vtkImageMathematics> m3;
   m3->SetOperationToAdd();
@@ -205,7 +213,7 @@ void vtkImageSharpenExecute(vtkImageSharpen* self,
 
   if (0. == range)
   {
-    output->DeepCopy(input);
+    output->ShallowCopy(input);
     return;
   }
 
@@ -222,7 +230,9 @@ void vtkImageSharpenExecute(vtkImageSharpen* self,
   shift->SetScale(m);
   shift->Update();
 
-  output->DeepCopy(shift->GetOutput());
+  // the output takes over the shifted scalars, which nothing else uses,
+  // so the histogram matching below can modify them in place
+  output->ShallowCopy(shift->GetOutput());
 
   currentProgress = progressCount++/progressGoal;
   self->UpdateProgress(currentProgress);  //  7 / 10
@@ -340,9 +350,9 @@ void vtkImageSharpen::SimpleExecute(vtkImageData* input,
                                     vtkImageData* output)
 {
   void* inPtr = input->GetScalarPointer();
-  void* outPtr = output->GetScalarPointer();
+  void* outPtr = NULL;
 
-  switch (output->GetScalarType())
+  switch (input->GetScalarType())
     {
     // This is simply a #define for a big case list. It handles all
     // data types VTK supports.
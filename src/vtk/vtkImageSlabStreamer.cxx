@@ -0,0 +1,94 @@
+/*=========================================================================
+
+  Program:
+  Module:    vtkImageSlabStreamer.cxx
+  Language:  C++
+
+  Copyright (c) Dean Inglis
+  All rights reserved.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.
+
+=========================================================================*/
+#include "vtkImageSlabStreamer.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+
+// C++ includes
+#include <algorithm>
+
+vtkStandardNewMacro(vtkImageSlabStreamer);
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageSlabStreamer::vtkImageSlabStreamer()
+{
+  this->Axis = 2;
+  this->Margin = 8;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageSlabStreamer::RequestUpdateExtent(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+
+  int wholeExt[6];
+  int updateExt[6];
+  inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wholeExt);
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExt);
+
+  // grow the request along the slab axis, staying within the whole extent
+  int lo = 2 * this->Axis;
+  int hi = lo + 1;
+  if (updateExt[lo] <= updateExt[hi])
+  {
+    updateExt[lo] = std::max(wholeExt[lo], updateExt[lo] - this->Margin);
+    updateExt[hi] = std::min(wholeExt[hi], updateExt[hi] + this->Margin);
+  }
+
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExt, 6);
+  return 1;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageSlabStreamer::RequestData(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *output = vtkImageData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkImageData *input = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  if (!input || !output)
+  {
+    return 0;
+  }
+
+  // the whole slab is passed on so that the pipeline sees requests for
+  // any of its slices as already satisfied
+  output->ShallowCopy(input);
+  return 1;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageSlabStreamer::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Axis: " << this->Axis << endl;
+  os << indent << "Margin: " << this->Margin << endl;
+}
@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program:
+  Module:    vtkImageSlabStreamer.h
+  Language:  C++
+
+  Copyright (c) Dean Inglis
+  All rights reserved.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.
+
+=========================================================================*/
+
+/**
+ * @class vtkImageSlabStreamer
+ *
+ * @author Dean Inglis <inglisd AT mcmaster DOT ca>
+ *
+ * @brief Pass through filter which widens a streamed request to a slab.
+ *
+ * vtkImageSlabStreamer passes its input through unchanged.  When the
+ * pipeline asks it for an update extent, it asks its input for that extent
+ * grown by Margin slices on either side along Axis, clamped to the whole
+ * extent.  Placed between a streaming reader and a slice viewer, moving to
+ * a neighbouring slice is then satisfied by the slab already held by this
+ * filter and the reader is only re-executed once the requested slice
+ * leaves the slab.
+ *
+ * @see vtkImageDataReader vtkMedicalImageViewer
+ */
+
+#ifndef __vtkImageSlabStreamer_h
+#define __vtkImageSlabStreamer_h
+
+#include <vtkImageAlgorithm.h>
+
+class vtkImageSlabStreamer : public vtkImageAlgorithm
+{
+  public:
+    static vtkImageSlabStreamer *New();
+    vtkTypeMacro(vtkImageSlabStreamer, vtkImageAlgorithm);
+    void PrintSelf(ostream& os, vtkIndent indent);
+
+    //@{
+    /**
+    * Set/Get the axis along which the requested extent is grown:
+    * 0 (x), 1 (y) or 2 (z).  Default 2.
+    * @param Axis
+    */
+    vtkSetClampMacro(Axis, int, 0, 2);
+    vtkGetMacro(Axis, int);
+    //@}
+
+    //@{
+    /**
+    * Set/Get the number of slices added to either side of the requested
+    * extent.  Default 8.
+    * @param Margin
+    */
+    vtkSetClampMacro(Margin, int, 0, VTK_INT_MAX);
+    vtkGetMacro(Margin, int);
+    //@}
+
+  protected:
+    vtkImageSlabStreamer();
+    ~vtkImageSlabStreamer() {}
+
+    int Axis;
+    int Margin;
+
+    virtual int RequestUpdateExtent(vtkInformation *,
+                                    vtkInformationVector **,
+                                    vtkInformationVector *);
+
+    virtual int RequestData(vtkInformation *,
+                            vtkInformationVector **,
+                            vtkInformationVector *);
+
+  private:
+    vtkImageSlabStreamer(const vtkImageSlabStreamer&);  /** Not implemented. */
+    void operator=(const vtkImageSlabStreamer&);  /** Not implemented. */
+};
+
+#endif
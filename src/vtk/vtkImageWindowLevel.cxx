@@ -16,6 +16,25 @@
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkScalarsToColors.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTypeTraits.h>
+
+// SSE2 is part of every x86-64 processor, AVX2 is chosen at run time
+#if defined(__SSE2__) || defined(_M_X64)
+#define BIRCH_USE_SSE2
+#include <emmintrin.h>
+#if defined(__clang__) || (defined(__GNUC__) && \
+  (__GNUC__ > 4 || (4 == __GNUC__ && 9 <= __GNUC_MINOR__)))
+#define BIRCH_USE_AVX2
+#define BIRCH_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkImageWindowLevel);
 
@@ -24,6 +43,10 @@ vtkImageWindowLevel::vtkImageWindowLevel()
 {
   this->Window = 255;
   this->Level = 127.5;
+  this->ShrinkFactor = 1;
+  this->SliceOrientation = 2;
+  this->TableScalarType = -1;
+  this->TableInUse = false;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -49,7 +72,7 @@ int vtkImageWindowLevel::RequestData(
 
   // If LookupTable is null and window / level produces no change,
   // then just pass the data
-  if (NULL == this->LookupTable &&
+  if (NULL == this->LookupTable && 1 == this->ShrinkFactor &&
       (VTK_UNSIGNED_CHAR == inData->GetScalarType() &&
        255 == this->Window && 127.5 == this->Level))
     {
@@ -73,6 +96,13 @@ int vtkImageWindowLevel::RequestData(
       this->DataWasPassed = 0;
       }
 
+    // only the requested extent is mapped, for a slice view that is the
+    // displayed slice
+    int updateExtent[6];
+    outInfo->Get(
+      vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), updateExtent);
+    this->UpdateTable(inData, updateExtent);
+
     return this->vtkThreadedImageAlgorithm::RequestData(
       request, inputVector, outputVector);
     }
@@ -100,7 +130,7 @@ int vtkImageWindowLevel::RequestInformation(
 
   // If LookupTable is null and window / level produces no change,
   // then the data will be passed
-  if (NULL == this->LookupTable &&
+  if (NULL == this->LookupTable && 1 == this->ShrinkFactor &&
       (VTK_UNSIGNED_CHAR ==
        inScalarInfo->Get(vtkDataObject::FIELD_ARRAY_TYPE()) &&
       255 == this->Window && 127.5 == this->Level))
@@ -144,9 +174,85 @@ int vtkImageWindowLevel::RequestInformation(
       outInfo, VTK_UNSIGNED_CHAR, numComponents);
     }
 
+  // a shrunken output holds every ShrinkFactor'th voxel across the slices,
+  // output voxel i lies on input voxel i*ShrinkFactor
+  if (1 < this->ShrinkFactor)
+    {
+    int extent[6];
+    double spacing[3];
+    inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+    inInfo->Get(vtkDataObject::SPACING(), spacing);
+    for (int i = 0; i < 3; ++i)
+      {
+      if (i != this->SliceOrientation)
+        {
+        extent[2*i] = static_cast<int>(
+          ceil(static_cast<double>(extent[2*i]) / this->ShrinkFactor));
+        extent[2*i+1] = static_cast<int>(
+          floor(static_cast<double>(extent[2*i+1]) / this->ShrinkFactor));
+        spacing[i] *= this->ShrinkFactor;
+        }
+      }
+    outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+    outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+    }
+
   return 1;
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageWindowLevel::RequestUpdateExtent(
+  vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector,
+  vtkInformationVector* outputVector)
+{
+  vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+  int extent[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent);
+  if (1 < this->ShrinkFactor)
+    {
+    for (int i = 0; i < 3; ++i)
+      {
+      if (i != this->SliceOrientation)
+        {
+        extent[2*i] *= this->ShrinkFactor;
+        extent[2*i+1] *= this->ShrinkFactor;
+        }
+      }
+    }
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), extent, 6);
+
+  return 1;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageWindowLevel::ComputeShrinkFactor(vtkIdType numberOfVoxels)
+{
+  if (0 == this->GetNumberOfInputConnections(0) || 0 >= numberOfVoxels)
+    {
+    return 1;
+    }
+
+  this->UpdateInformation();
+  int extent[6];
+  this->GetInputInformation()->Get(
+    vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent);
+  int u = (this->SliceOrientation + 1) % 3;
+  int v = (this->SliceOrientation + 2) % 3;
+  vtkIdType sizeU = extent[2*u+1] - extent[2*u] + 1;
+  vtkIdType sizeV = extent[2*v+1] - extent[2*v] + 1;
+
+  int factor = 1;
+  while (factor < 64 &&
+         (sizeU / factor) * (sizeV / factor) > numberOfVoxels)
+    {
+    factor++;
+    }
+  return factor;
+}
+
 /**
  * This templated routine calculates effective lower and upper limits
  * for a window of values of type T, lower and upper.
@@ -245,12 +351,440 @@ void vtkImageMapToWindowLevelClamps(
     }
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+//
+// Window / level of a single component image to luminance without a
+// lookup table.  The vector kernels do the same double precision arithmetic
+// as the scalar loop, in the same order, and select the clamped values
+// before truncating, so their output is identical to it.  Each one maps
+// the row in blocks of eight and returns how many values it mapped, the
+// scalar loop does the rest.
+//
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+namespace
+{
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  int vtkImageWindowLevelOutputComponents(int outputFormat)
+  {
+    switch (outputFormat)
+      {
+      case VTK_RGB: return 3;
+      case VTK_LUMINANCE_ALPHA: return 2;
+      case VTK_LUMINANCE: return 1;
+      default: return 4;
+      }
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  struct vtkImageWindowLevelParameters
+  {
+    T Lower;
+    T Upper;
+    unsigned char LowerValue;
+    unsigned char UpperValue;
+    double Shift;
+    double Scale;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // 0 for the scalar loop, 1 for SSE2 and 2 for AVX2
+  int vtkImageWindowLevelSelectKernel()
+  {
+#ifdef BIRCH_USE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      {
+      return 2;
+      }
+#endif
+#ifdef BIRCH_USE_SSE2
+    return 1;
+#else
+    return 0;
+#endif
+  }
+
+  const int vtkImageWindowLevelBestKernel = vtkImageWindowLevelSelectKernel();
+  int vtkImageWindowLevelKernel = vtkImageWindowLevelBestKernel;
+
+#ifdef BIRCH_USE_SSE2
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  class vtkImageWindowLevelSSE2
+  {
+    public:
+      template <class T>
+      explicit vtkImageWindowLevelSSE2(
+        const vtkImageWindowLevelParameters<T>& parameters)
+      {
+        this->Lower = _mm_set1_pd(static_cast<double>(parameters.Lower));
+        this->Upper = _mm_set1_pd(static_cast<double>(parameters.Upper));
+        this->LowerValue = _mm_set1_pd(parameters.LowerValue);
+        this->UpperValue = _mm_set1_pd(parameters.UpperValue);
+        this->Shift = _mm_set1_pd(parameters.Shift);
+        this->Scale = _mm_set1_pd(parameters.Scale);
+      }
+
+      // eight values as 16-bit integers
+      __m128i Map(const unsigned char* in) const
+      {
+        __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)), zero);
+        return _mm_packs_epi32(
+          this->Map(_mm_unpacklo_epi16(v, zero)),
+          this->Map(_mm_unpackhi_epi16(v, zero)));
+      }
+
+      __m128i Map(const short* in) const
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        return _mm_packs_epi32(
+          this->Map(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)),
+          this->Map(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));
+      }
+
+      __m128i Map(const unsigned short* in) const
+      {
+        __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        return _mm_packs_epi32(
+          this->Map(_mm_unpacklo_epi16(v, zero)),
+          this->Map(_mm_unpackhi_epi16(v, zero)));
+      }
+
+      __m128i Map(const float* in) const
+      {
+        return _mm_packs_epi32(
+          this->Map(_mm_loadu_ps(in)), this->Map(_mm_loadu_ps(in + 4)));
+      }
+
+    private:
+      // four floats as 32-bit integers
+      __m128i Map(__m128 v) const
+      {
+        return _mm_unpacklo_epi64(
+          this->Map(_mm_cvtps_pd(v)),
+          this->Map(_mm_cvtps_pd(_mm_movehl_ps(v, v))));
+      }
+
+      // four 32-bit integers
+      __m128i Map(__m128i v) const
+      {
+        return _mm_unpacklo_epi64(
+          this->Map(_mm_cvtepi32_pd(v)),
+          this->Map(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, 0x4e))));
+      }
+
+      // two doubles, truncated to the low two 32-bit integers
+      __m128i Map(__m128d x) const
+      {
+        __m128d value =
+          _mm_mul_pd(_mm_add_pd(x, this->Shift), this->Scale);
+        __m128d mask = _mm_cmpge_pd(x, this->Upper);
+        value = _mm_or_pd(
+          _mm_and_pd(mask, this->UpperValue), _mm_andnot_pd(mask, value));
+        mask = _mm_cmple_pd(x, this->Lower);
+        value = _mm_or_pd(
+          _mm_and_pd(mask, this->LowerValue), _mm_andnot_pd(mask, value));
+        return _mm_cvttpd_epi32(value);
+      }
+
+      __m128d Lower;
+      __m128d Upper;
+      __m128d LowerValue;
+      __m128d UpperValue;
+      __m128d Shift;
+      __m128d Scale;
+  };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  int vtkImageWindowLevelLuminanceSSE2(
+    const vtkImageWindowLevelParameters<T>& parameters,
+    const T* in, unsigned char* out, int count)
+  {
+    vtkImageWindowLevelSSE2 kernel(parameters);
+    __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+      {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+        _mm_packus_epi16(kernel.Map(in + i), zero));
+      }
+    return i;
+  }
+#endif
+
+#ifdef BIRCH_USE_AVX2
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // four doubles, truncated to four 32-bit integers
+  BIRCH_TARGET_AVX2 inline __m128i vtkImageWindowLevelAVX2(
+    __m256d x, const __m256d* constants)
+  {
+    __m256d value =
+      _mm256_mul_pd(_mm256_add_pd(x, constants[4]), constants[5]);
+    value = _mm256_blendv_pd(
+      value, constants[3], _mm256_cmp_pd(x, constants[1], _CMP_GE_OQ));
+    value = _mm256_blendv_pd(
+      value, constants[2], _mm256_cmp_pd(x, constants[0], _CMP_LE_OQ));
+    return _mm256_cvttpd_epi32(value);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // eight values as 16-bit integers
+  BIRCH_TARGET_AVX2 inline __m128i vtkImageWindowLevelAVX2(
+    const unsigned char* in, const __m256d* constants)
+  {
+    __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+    return _mm_packs_epi32(
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(v)), constants),
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_srli_si128(v, 4))),
+        constants));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  BIRCH_TARGET_AVX2 inline __m128i vtkImageWindowLevelAVX2(
+    const short* in, const __m256d* constants)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    return _mm_packs_epi32(
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(v)), constants),
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8))),
+        constants));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  BIRCH_TARGET_AVX2 inline __m128i vtkImageWindowLevelAVX2(
+    const unsigned short* in, const __m256d* constants)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    return _mm_packs_epi32(
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(v)), constants),
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_srli_si128(v, 8))),
+        constants));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  BIRCH_TARGET_AVX2 inline __m128i vtkImageWindowLevelAVX2(
+    const float* in, const __m256d* constants)
+  {
+    return _mm_packs_epi32(
+      vtkImageWindowLevelAVX2(_mm256_cvtps_pd(_mm_loadu_ps(in)), constants),
+      vtkImageWindowLevelAVX2(
+        _mm256_cvtps_pd(_mm_loadu_ps(in + 4)), constants));
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  BIRCH_TARGET_AVX2 int vtkImageWindowLevelLuminanceAVX2(
+    const vtkImageWindowLevelParameters<T>& parameters,
+    const T* in, unsigned char* out, int count)
+  {
+    // lower, upper, lower value, upper value, shift and scale
+    __m256d constants[6];
+    constants[0] = _mm256_set1_pd(static_cast<double>(parameters.Lower));
+    constants[1] = _mm256_set1_pd(static_cast<double>(parameters.Upper));
+    constants[2] = _mm256_set1_pd(parameters.LowerValue);
+    constants[3] = _mm256_set1_pd(parameters.UpperValue);
+    constants[4] = _mm256_set1_pd(parameters.Shift);
+    constants[5] = _mm256_set1_pd(parameters.Scale);
+
+    __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+      {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+        _mm_packus_epi16(vtkImageWindowLevelAVX2(in + i, constants), zero));
+      }
+    return i;
+  }
+#endif
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // types without a vector kernel
+  template <class T>
+  int vtkImageWindowLevelLuminanceSIMD(
+    const vtkImageWindowLevelParameters<T>&, const T*, unsigned char*, int)
+  {
+    return 0;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  int vtkImageWindowLevelLuminanceVector(
+    const vtkImageWindowLevelParameters<T>& parameters,
+    const T* in, unsigned char* out, int count)
+  {
+#ifdef BIRCH_USE_AVX2
+    if (2 == vtkImageWindowLevelKernel)
+      {
+      return vtkImageWindowLevelLuminanceAVX2(parameters, in, out, count);
+      }
+#endif
+#ifdef BIRCH_USE_SSE2
+    if (1 <= vtkImageWindowLevelKernel)
+      {
+      return vtkImageWindowLevelLuminanceSSE2(parameters, in, out, count);
+      }
+#endif
+    return 0;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  int vtkImageWindowLevelLuminanceSIMD(
+    const vtkImageWindowLevelParameters<unsigned char>& parameters,
+    const unsigned char* in, unsigned char* out, int count)
+  {
+    return vtkImageWindowLevelLuminanceVector(parameters, in, out, count);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  int vtkImageWindowLevelLuminanceSIMD(
+    const vtkImageWindowLevelParameters<short>& parameters,
+    const short* in, unsigned char* out, int count)
+  {
+    return vtkImageWindowLevelLuminanceVector(parameters, in, out, count);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  int vtkImageWindowLevelLuminanceSIMD(
+    const vtkImageWindowLevelParameters<unsigned short>& parameters,
+    const unsigned short* in, unsigned char* out, int count)
+  {
+    return vtkImageWindowLevelLuminanceVector(parameters, in, out, count);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  int vtkImageWindowLevelLuminanceSIMD(
+    const vtkImageWindowLevelParameters<float>& parameters,
+    const float* in, unsigned char* out, int count)
+  {
+    return vtkImageWindowLevelLuminanceVector(parameters, in, out, count);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  template <class T>
+  void vtkImageWindowLevelLuminance(
+    const vtkImageWindowLevelParameters<T>& parameters,
+    const T* in, unsigned char* out, int count)
+  {
+    for (int i = vtkImageWindowLevelLuminanceSIMD(parameters, in, out, count);
+         i < count; ++i)
+      {
+      if (in[i] <= parameters.Lower)
+        {
+        out[i] = parameters.LowerValue;
+        }
+      else if (in[i] >= parameters.Upper)
+        {
+        out[i] = parameters.UpperValue;
+        }
+      else
+        {
+        out[i] = static_cast<unsigned char>(
+          (in[i] + parameters.Shift)*parameters.Scale);
+        }
+      }
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageWindowLevel::SetKernel(int kernel)
+{
+  vtkImageWindowLevelKernel =
+    std::max(0, std::min(kernel, vtkImageWindowLevelBestKernel));
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkImageWindowLevel::GetKernel()
+{
+  return vtkImageWindowLevelKernel;
+}
+
+/**
+ * This templated routine maps every value of an 8 or 16-bit type, from the
+ * type's minimum up, the same way vtkImageWindowLevelExecute maps a voxel.
+ * Without a lookup table an entry is one window / levelled value, with one
+ * it is the modulated color of the output format.
+ */
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+template <class T>
+void vtkImageWindowLevelBuildTable(
+  vtkImageWindowLevel* self, vtkImageData* inData, T*,
+  std::vector<unsigned char>& table)
+{
+  vtkImageWindowLevelParameters<T> parameters;
+  vtkImageMapToWindowLevelClamps(
+    inData, self->GetWindow(), self->GetLevel(),
+    parameters.Lower, parameters.Upper,
+    parameters.LowerValue, parameters.UpperValue);
+  parameters.Shift = self->GetWindow() / 2.0 - self->GetLevel();
+  parameters.Scale = 255.0 / self->GetWindow();
+
+  const int numberOfValues = 1 << (8*sizeof(T));
+  std::vector<T> values(numberOfValues);
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    values[i] = static_cast<T>(vtkTypeTraits<T>::Min() + i);
+    }
+
+  std::vector<unsigned char> luminance(numberOfValues);
+  vtkImageWindowLevelLuminance(
+    parameters, &values[0], &luminance[0], numberOfValues);
+
+  vtkScalarsToColors* lookupTable = self->GetLookupTable();
+  if (!lookupTable)
+    {
+    table.swap(luminance);
+    return;
+    }
+
+  int outputFormat = self->GetOutputFormat();
+  int numberOfOutputComponents = vtkImageWindowLevelOutputComponents(
+    outputFormat);
+  table.resize(numberOfValues*numberOfOutputComponents);
+  lookupTable->MapScalarsThroughTable2(
+    &values[0], &table[0], inData->GetScalarType(), numberOfValues, 1,
+    outputFormat);
+
+  unsigned char* optr = &table[0];
+  for (int i = 0; i < numberOfValues; ++i)
+    {
+    unsigned short ushort_val = luminance[i];
+    *optr = static_cast<unsigned char>((*optr * ushort_val) >> 8);
+    switch (outputFormat)
+      {
+      case VTK_RGBA:
+        *(optr+1) = static_cast<unsigned char>((*(optr+1) * ushort_val) >> 8);
+        *(optr+2) = static_cast<unsigned char>((*(optr+2) * ushort_val) >> 8);
+        *(optr+3) = 255;
+        break;
+      case VTK_RGB:
+        *(optr+1) = static_cast<unsigned char>((*(optr+1) * ushort_val) >> 8);
+        *(optr+2) = static_cast<unsigned char>((*(optr+2) * ushort_val) >> 8);
+        break;
+      case VTK_LUMINANCE_ALPHA:
+        *(optr+1) = 255;
+        break;
+      }
+    optr += numberOfOutputComponents;
+    }
+}
+
 /** This non-templated function executes the filter for any type of data. */
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 template <class T>
 void vtkImageWindowLevelExecute(
   vtkImageWindowLevel* self, vtkImageData* inData, T* inPtr,
-  vtkImageData* outData, unsigned char* outPtr, int outExt[6], int id)
+  vtkImageData* outData, unsigned char* outPtr, int outExt[6], int id,
+  const unsigned char* table)
 {
   int idxX, idxY, idxZ;
   int extX, extY, extZ;
@@ -276,6 +810,14 @@ void vtkImageWindowLevelExecute(
     inData, self->GetWindow(), self->GetLevel(),
     lower, upper, lower_val, upper_val);
 
+  vtkImageWindowLevelParameters<T> parameters;
+  parameters.Lower = lower;
+  parameters.Upper = upper;
+  parameters.LowerValue = lower_val;
+  parameters.UpperValue = upper_val;
+  parameters.Shift = shift;
+  parameters.Scale = scale;
+
   // Find the region to loop over
   extX = outExt[1] - outExt[0] + 1;
   extY = outExt[3] - outExt[2] + 1;
@@ -294,6 +836,18 @@ void vtkImageWindowLevelExecute(
 
   rowLength = extX*numberOfComponents;
 
+  // a shrunken output maps every factor'th voxel across the slices, each
+  // row is gathered from the input before it is mapped
+  int factor = self->GetShrinkFactor();
+  int step[3] = { factor, factor, factor };
+  step[self->GetSliceOrientation()] = 1;
+  std::vector<T> samples(1 < factor ? rowLength : 0);
+  vtkIdType sampleIncrement = 0;
+  if (1 < factor)
+    {
+    sampleIncrement = step[0]*inData->GetIncrements()[0];
+    }
+
   // Loop through output pixels
   outPtr1 = outPtr;
   inPtr1 = inPtr;
@@ -310,10 +864,67 @@ void vtkImageWindowLevelExecute(
         count++;
         }
 
+      if (1 < factor)
+        {
+        const T* sample = static_cast<const T*>(inData->GetScalarPointer(
+          outExt[0]*step[0], (outExt[2] + idxY)*step[1],
+          (outExt[4] + idxZ)*step[2]));
+        for (idxX = 0; idxX < extX; idxX++)
+          {
+          for (int j = 0; j < numberOfComponents; ++j)
+            {
+            samples[idxX*numberOfComponents + j] = sample[j];
+            }
+          sample += sampleIncrement;
+          }
+        inPtr1 = &samples[0];
+        }
+
       iptr = inPtr1;
       optr = outPtr1;
 
-      if (lookupTable)
+      if (table)
+        {
+        // the table holds every value's output, colored or not
+        const int offset = static_cast<int>(vtkTypeTraits<T>::Min());
+        if (lookupTable)
+          {
+          for (idxX = 0; idxX < extX; idxX++)
+            {
+            const unsigned char* entry = table +
+              (static_cast<int>(*iptr) - offset)*numberOfOutputComponents;
+            for (int j = 0; j < numberOfOutputComponents; ++j)
+              {
+              optr[j] = entry[j];
+              }
+            iptr++;
+            optr += numberOfOutputComponents;
+            }
+          }
+        else
+          {
+          const unsigned char* entry = table - offset;
+          for (idxX = 0; idxX < extX; idxX++)
+            {
+            for (int j = 0; j < numberOfComponents; ++j)
+              {
+              if (j == (numberOfComponents - 1) &&
+                  (outputFormat == VTK_LUMINANCE_ALPHA ||
+                   outputFormat == VTK_RGBA))
+                {
+                *optr = 255;
+                }
+              else
+                {
+                *optr = entry[static_cast<int>(*iptr)];
+                }
+              iptr++;
+              optr++;
+              }
+            }
+          }
+        }
+      else if (lookupTable)
         {
         lookupTable->MapScalarsThroughTable2(
           inPtr1,
@@ -359,6 +970,10 @@ void vtkImageWindowLevelExecute(
           optr += numberOfOutputComponents;
           }
         }
+      else if (1 == numberOfComponents && VTK_LUMINANCE == outputFormat)
+        {
+        vtkImageWindowLevelLuminance(parameters, inPtr1, outPtr1, extX);
+        }
       else
         {
         for (idxX = 0; idxX < extX; idxX++)
@@ -393,10 +1008,16 @@ void vtkImageWindowLevelExecute(
           }
         }
       outPtr1 += outIncY + extX*numberOfOutputComponents;
-      inPtr1 += inIncY + rowLength;
+      if (1 == factor)
+        {
+        inPtr1 += inIncY + rowLength;
+        }
       }
     outPtr1 += outIncZ;
-    inPtr1 += inIncZ;
+    if (1 == factor)
+      {
+      inPtr1 += inIncZ;
+      }
     }
 }
 
@@ -413,7 +1034,10 @@ void vtkImageWindowLevel::ThreadedRequestData(
   vtkImageData** outData,
   int outExt[6], int id)
 {
-  void* inPtr = inData[0][0]->GetScalarPointerForExtent(outExt);
+  // a shrunken output samples its input in vtkImageWindowLevelExecute
+  void* inPtr = 1 < this->ShrinkFactor ?
+    inData[0][0]->GetScalarPointer() :
+    inData[0][0]->GetScalarPointerForExtent(outExt);
   void* outPtr = outData[0]->GetScalarPointerForExtent(outExt);
 
   switch (inData[0][0]->GetScalarType())
@@ -422,17 +1046,86 @@ void vtkImageWindowLevel::ThreadedRequestData(
       vtkImageWindowLevelExecute(
         this, inData[0][0], static_cast<VTK_TT *>(inPtr),
         outData[0], static_cast<unsigned char *>(outPtr),
-        outExt, id));
+        outExt, id, this->TableInUse ? &this->Table[0] : NULL));
     default:
       vtkErrorMacro(<< "Execute: Unknown ScalarType");
       return;
     }
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkImageWindowLevel::UpdateTable(vtkImageData* input, int extent[6])
+{
+  int scalarType = input->GetScalarType();
+  int numberOfComponents = input->GetNumberOfScalarComponents();
+  vtkIdType numberOfVoxels = 1;
+  for (int i = 0; i < 3; ++i)
+    {
+    numberOfVoxels *= std::max(0, extent[2*i+1] - extent[2*i] + 1);
+    }
+  vtkIdType numberOfValues = 0;
+  switch (scalarType)
+    {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+    case VTK_UNSIGNED_CHAR:
+      numberOfValues = 256;
+      break;
+    case VTK_SHORT:
+    case VTK_UNSIGNED_SHORT:
+      numberOfValues = 65536;
+      break;
+    }
+
+  // the lookup table colors the first component only, and a table larger
+  // than the extent would cost more to build than it saves, unless it is
+  // already built
+  this->TableInUse = 0 < numberOfValues &&
+    (!this->LookupTable || 1 == numberOfComponents) &&
+    (numberOfValues <= numberOfVoxels*numberOfComponents ||
+     (scalarType == this->TableScalarType &&
+      this->TableTime.GetMTime() > this->GetMTime()));
+  if (!this->TableInUse)
+    return;
+
+  // the modified time includes that of the lookup table
+  if (scalarType == this->TableScalarType &&
+      this->TableTime.GetMTime() > this->GetMTime())
+    return;
+
+  switch (scalarType)
+    {
+    case VTK_CHAR:
+      vtkImageWindowLevelBuildTable(
+        this, input, static_cast<char*>(NULL), this->Table);
+      break;
+    case VTK_SIGNED_CHAR:
+      vtkImageWindowLevelBuildTable(
+        this, input, static_cast<signed char*>(NULL), this->Table);
+      break;
+    case VTK_UNSIGNED_CHAR:
+      vtkImageWindowLevelBuildTable(
+        this, input, static_cast<unsigned char*>(NULL), this->Table);
+      break;
+    case VTK_SHORT:
+      vtkImageWindowLevelBuildTable(
+        this, input, static_cast<short*>(NULL), this->Table);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      vtkImageWindowLevelBuildTable(
+        this, input, static_cast<unsigned short*>(NULL), this->Table);
+      break;
+    }
+  this->TableScalarType = scalarType;
+  this->TableTime.Modified();
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkImageWindowLevel::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "Window: " << this->Window << endl;
   os << indent << "Level: " << this->Level << endl;
+  os << indent << "ShrinkFactor: " << this->ShrinkFactor << endl;
+  os << indent << "SliceOrientation: " << this->SliceOrientation << endl;
 }
@@ -21,6 +21,11 @@
  * and will revert to only modulating the first component of a multi-component
  * image if the lookup table is set.
  *
+ * Input of 8 or 16-bit integer type is mapped through a table holding the
+ * output of every value the type can take, rebuilt when the window, level,
+ * output format or lookup table change, so that each voxel costs a single
+ * lookup.
+ *
  * @see vtkLookupTable, vtkScalarsToColors
  */
 
@@ -30,6 +35,9 @@
 // VTK includes
 #include <vtkImageMapToColors.h>
 
+// C++ includes
+#include <vector>
+
 class vtkImageWindowLevel : public vtkImageMapToColors
 {
   public:
@@ -57,6 +65,50 @@ class vtkImageWindowLevel : public vtkImageMapToColors
     vtkGetMacro(Level, double);
     //@}
 
+    //@{
+    /**
+     * Set / Get the factor by which the output is shrunk across the slices
+     * along SliceOrientation, for a quick preview while the window / level
+     * is being dragged.  Only every ShrinkFactor'th voxel along the other
+     * two axes is mapped and the output spacing grows to match, so a slice
+     * costs about 1/ShrinkFactor^2 to map and to render.  Default 1, the
+     * output is not shrunk.
+     */
+    vtkSetClampMacro(ShrinkFactor, int, 1, 64);
+    vtkGetMacro(ShrinkFactor, int);
+    //@}
+
+    //@{
+    /**
+     * Set / Get the axis the slices are taken along: 0 (x), 1 (y) or 2 (z),
+     * which is never shrunk.  Default 2.
+     */
+    vtkSetClampMacro(SliceOrientation, int, 0, 2);
+    vtkGetMacro(SliceOrientation, int);
+    //@}
+
+    /**
+     * The smallest shrink factor which reduces a slice of the input across
+     * SliceOrientation to at most the given number of voxels.
+     */
+    int ComputeShrinkFactor(vtkIdType numberOfVoxels);
+
+    enum { ScalarKernel = 0, SSE2Kernel, AVX2Kernel };
+
+    //@{
+    /**
+     * Set / Get the instructions a single component image is mapped to
+     * luminance with, when there is no lookup table: ScalarKernel,
+     * SSE2Kernel or AVX2Kernel, limited to the best the processor has,
+     * which is the default.  The setting is shared by every filter and is
+     * there to test the vector kernels against the scalar loop: change it
+     * only while no filter executes, and only filters created afterwards
+     * rebuild their tables with it.
+     */
+    static void SetKernel(int kernel);
+    static int GetKernel();
+    //@}
+
   protected:
     vtkImageWindowLevel();
     ~vtkImageWindowLevel();
@@ -65,6 +117,10 @@ class vtkImageWindowLevel : public vtkImageMapToColors
       vtkInformation* request,
       vtkInformationVector** inputVector,
       vtkInformationVector* outputVector);
+    virtual int RequestUpdateExtent(
+      vtkInformation* request,
+      vtkInformationVector** inputVector,
+      vtkInformationVector* outputVector);
     void ThreadedRequestData(
       vtkInformation* request,
       vtkInformationVector** inputVector,
@@ -76,8 +132,22 @@ class vtkImageWindowLevel : public vtkImageMapToColors
       vtkInformationVector** inputVector,
       vtkInformationVector* outputVector);
 
+    /**
+     * Build the table of the output of every input value, if the input
+     * type is small enough, the extent to map is large enough and the
+     * table is out of date.
+     */
+    void UpdateTable(vtkImageData* input, int extent[6]);
+
     double Window;
     double Level;
+    int ShrinkFactor;
+    int SliceOrientation;
+
+    std::vector<unsigned char> Table;
+    int TableScalarType;
+    bool TableInUse;
+    vtkTimeStamp TableTime;
 
   private:
     vtkImageWindowLevel(const vtkImageWindowLevel&);  /** Not implemented.*/
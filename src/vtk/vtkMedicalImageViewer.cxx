@@ -13,28 +13,30 @@
 #include <Common.h>
 
 // VTK includes
+#include <vtkAlgorithmOutput.h>
 #include <vtkAnimationCue.h>
 #include <vtkAnimationScene.h>
 #include <vtkAxes.h>
 #include <vtkAxesActor.h>
 #include <vtkCamera.h>
+#include <vtkCineWriter.h>
 #include <vtkCommand.h>
 #include <vtkCustomCornerAnnotation.h>
 #include <vtkCustomInteractorStyleImage.h>
 #include <vtkDataArray.h>
 #include <vtkFrameAnimationPlayer.h>
-#include <vtkImageChangeInformation.h>
-#include <vtkImageClip.h>
 #include <vtkImageCoordinateWidget.h>
 #include <vtkImageData.h>
 #include <vtkImageDataReader.h>
+#include <vtkImageDataStatistics.h>
 #include <vtkImageDataWriter.h>
-#include <vtkImagePermute.h>
 #include <vtkImageProperty.h>
 #include <vtkImageSinusoidSource.h>
 #include <vtkImageSlice.h>
 #include <vtkImageSliceMapper.h>
+#include <vtkImageSlabStreamer.h>
 #include <vtkImageWindowLevel.h>
+#include <vtkInformation.h>
 #include <vtkLookupTable.h>
 #include <vtkMath.h>
 #include <vtkMedicalImageProperties.h>
@@ -50,8 +52,11 @@
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkSmartPointer.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
 
 // C++ includes
+#include <algorithm>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -65,7 +70,7 @@ class vtkWindowLevelCallback : public vtkCommand
     static vtkWindowLevelCallback* New() { return new vtkWindowLevelCallback; }
 
     void Execute(vtkObject* vtkNotUsed(caller), unsigned long event,
-                  void* vtkNotUsed(callData))
+                  void* callData)
     {
       if (!this->Viewer) return;
       switch (event)
@@ -79,7 +84,13 @@ class vtkWindowLevelCallback : public vtkCommand
         case vtkCommand::WindowLevelEvent:
           this->Viewer->DoWindowLevel();
           break;
-        case vtkCommand::EndWindowLevelEvent: break;
+        case vtkCommand::EndWindowLevelEvent:
+          this->Viewer->DoEndWindowLevel();
+          break;
+        case vtkCommand::TimerEvent:
+          if (callData)
+            this->Viewer->DoTimer(*(static_cast<int*>(callData)));
+          break;
       }
     }
 
@@ -184,6 +195,7 @@ vtkMedicalImageViewer::vtkMedicalImageViewer()
   this->ImageSlice       = vtkSmartPointer<vtkImageSlice>::New();
   this->ImageSliceMapper = vtkSmartPointer<vtkImageSliceMapper>::New();
   this->WindowLevel      = vtkSmartPointer<vtkImageWindowLevel>::New();
+  this->SlabStreamer     = vtkSmartPointer<vtkImageSlabStreamer>::New();
   this->Interactor       = 0;
   this->InteractorStyle  = 0;
   this->CursorWidget     = vtkSmartPointer<vtkImageCoordinateWidget>::New();
@@ -285,9 +297,26 @@ vtkMedicalImageViewer::vtkMedicalImageViewer()
   this->OriginalLevel = 127.5;
   this->Window = 255.0;
   this->Level = 127.5;
+  this->AutoWindowLevel = 1;
+  this->AutoWindowLevelPercentiles[0] = 1.0;
+  this->AutoWindowLevelPercentiles[1] = 99.0;
+  this->InteractiveSliceSize = 1024*1024;
+  this->InteractiveShrinkFactor = 1;
+  this->RefineDelay = 200;
+  this->RefineTimerId = 0;
+  this->TimerCallbackTag = 0;
 
   this->Slice = 0;
   this->ViewOrientation = vtkMedicalImageViewer::VIEW_ORIENTATION_XY;
+  this->SlabStreamer->SetAxis(this->ViewOrientation);
+  this->Streaming = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    this->InputOrigin[i] = 0.0;
+    this->InputSpacing[i] = 1.0;
+    this->InputWholeExtent[2*i] = 0;
+    this->InputWholeExtent[2*i+1] = -1;
+  }
 
   this->SetMappingToLuminance();
 
@@ -322,6 +351,9 @@ vtkMedicalImageViewer::vtkMedicalImageViewer()
   this->ImageSliceMapper->SliceAtFocalPointOff();
   this->ImageSliceMapper->BorderOff();
   this->ImageSliceMapper->CroppingOff();
+  // ask the window level filter, and so the reader, for the displayed
+  // slice alone rather than the whole volume
+  this->ImageSliceMapper->StreamingOn();
 
   this->SetInteractorStyle(
     vtkSmartPointer<vtkCustomInteractorStyleImage>::New());
@@ -363,35 +395,53 @@ void vtkMedicalImageViewer::SetInputData(vtkImageData* input)
   this->UnInstallPipeline();
   if (!input) return;
 
-  vtkImageData* lastInput = this->GetInput();
-  int initCamera = 1;
-  if (lastInput)
-  {
-    double* lastSpacing = lastInput->GetSpacing();
-    double* spacing = input->GetSpacing();
-    double* lastOrigin = lastInput->GetOrigin();
-    double* origin = input->GetOrigin();
-    int* lastExtent = lastInput->GetExtent();
-    int* extent = input->GetExtent();
-    initCamera = 0;
-    for (int i = 0; i < 3; ++i)
+  this->SlabStreamer->SetInputConnection(0);
+  this->WindowLevel->SetInputData(input);
+  this->InitializeInput();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::SetInputConnection(vtkAlgorithmOutput* input)
+{
+  this->UnInstallPipeline();
+  if (!input) return;
+
+  this->SlabStreamer->SetInputConnection(input);
+  this->WindowLevel->SetInputConnection(this->SlabStreamer->GetOutputPort());
+  this->WindowLevel->UpdateInformation();
+  this->InitializeInput();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::InitializeInput()
+{
+  // keep the current camera views if the geometry has not changed
+  double lastOrigin[3];
+  double lastSpacing[3];
+  int lastExtent[6];
+  std::copy(this->InputOrigin, this->InputOrigin + 3, lastOrigin);
+  std::copy(this->InputSpacing, this->InputSpacing + 3, lastSpacing);
+  std::copy(this->InputWholeExtent, this->InputWholeExtent + 6, lastExtent);
+  if (!this->UpdateInputInformation()) return;
+
+  int initCamera = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (lastSpacing[i]    != this->InputSpacing[i]          ||
+        lastOrigin[i]     != this->InputOrigin[i]           ||
+        lastExtent[2*i]   != this->InputWholeExtent[2*i]    ||
+        lastExtent[2*i+1] != this->InputWholeExtent[2*i+1])
     {
-      if (lastSpacing[i]    != spacing[i]  ||
-          lastOrigin[i]     != origin[i]   ||
-          lastExtent[2*i]   != extent[2*i] ||
-          lastExtent[2*i+1] != extent[2*i+1])
-      {
-        initCamera = 1;
-        break;
-      }
+      initCamera = 1;
+      break;
     }
   }
 
-  this->WindowLevel->SetInputData(input);
   this->ImageSliceMapper->SetInputConnection(
     this->WindowLevel->GetOutputPort());
 
-  int components = input->GetNumberOfScalarComponents();
+  int components = vtkImageData::GetNumberOfScalarComponents(
+    this->WindowLevel->GetInputInformation());
   switch (components)
   {
     case 1: this->SetMappingToLuminance(); break;
@@ -401,12 +451,77 @@ void vtkMedicalImageViewer::SetInputData(vtkImageData* input)
   }
 
   this->InstallPipeline();
+
+  // a streamed input holds no data until the first slab is requested
+  if (this->WindowLevel->GetInputAlgorithm() == this->SlabStreamer)
+  {
+    this->ImageSliceMapper->SetSliceNumber(this->GetSliceMin());
+    this->ImageSliceMapper->Update();
+  }
+
   this->InitializeWindowLevel();
   if (initCamera)
     this->InitializeCameraViews();
   this->SetSlice(this->GetSliceMin());
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkMedicalImageViewer::UpdateInputInformation()
+{
+  if (0 == this->WindowLevel->GetNumberOfInputConnections(0)) return 0;
+
+  this->WindowLevel->UpdateInformation();
+  vtkInformation* info = this->WindowLevel->GetInputInformation();
+  if (!info) return 0;
+
+  info->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(),
+    this->InputWholeExtent);
+  if (info->Has(vtkDataObject::ORIGIN()))
+    info->Get(vtkDataObject::ORIGIN(), this->InputOrigin);
+  if (info->Has(vtkDataObject::SPACING()))
+    info->Get(vtkDataObject::SPACING(), this->InputSpacing);
+  return 1;
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::SetSlabMargin(int margin)
+{
+  this->SlabStreamer->SetMargin(margin);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkMedicalImageViewer::GetSlabMargin()
+{
+  return this->SlabStreamer->GetMargin();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::SetAutoWindowLevel(int autoWindowLevel)
+{
+  if (autoWindowLevel == this->AutoWindowLevel) return;
+  this->AutoWindowLevel = autoWindowLevel;
+  this->Modified();
+  if (!this->GetInput()) return;
+
+  this->InitializeWindowLevel();
+  this->Render();
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::SetAutoWindowLevelPercentiles(
+  double lower, double upper)
+{
+  if (lower == this->AutoWindowLevelPercentiles[0] &&
+      upper == this->AutoWindowLevelPercentiles[1]) return;
+  this->AutoWindowLevelPercentiles[0] = lower;
+  this->AutoWindowLevelPercentiles[1] = upper;
+  this->Modified();
+  if (!this->GetInput() || !this->AutoWindowLevel) return;
+
+  this->InitializeWindowLevel();
+  this->Render();
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 bool vtkMedicalImageViewer::Load(const std::string& fileName)
 {
@@ -415,11 +530,27 @@ bool vtkMedicalImageViewer::Load(const std::string& fileName)
   {
     vtkNew<vtkImageDataReader> reader;
     reader->SetFileName(fileName.c_str());
-    vtkImageData* image = reader->GetOutput();
-    if (image)
+    if (this->Streaming)
+    {
+      // the pipeline keeps the underlying reader alive
+      vtkAlgorithmOutput* port = reader->GetOutputPort();
+      if (port)
+      {
+        this->SetInputConnection(port);
+        success = true;
+      }
+    }
+    else
+    {
+      vtkImageData* image = reader->GetOutput();
+      if (image)
+      {
+        this->SetInputData(image);
+        success = true;
+      }
+    }
+    if (success)
     {
-      this->SetInputData(image);
-      success = true;
       vtkMedicalImageProperties* properties =
         reader->GetMedicalImageProperties();
 
@@ -453,69 +584,87 @@ vtkImageData* vtkMedicalImageViewer::GetDisplayInput()
   return vtkImageData::SafeDownCast(this->ImageSliceMapper->GetInput());
 }
 
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+vtkImageData* vtkMedicalImageViewer::GetWholeInput()
+{
+  // a streamed input holds only the slab about the current slice, so the
+  // whole extent is read from the source of the stream
+  if (this->WindowLevel->GetInputAlgorithm() == this->SlabStreamer &&
+      0 < this->SlabStreamer->GetNumberOfInputConnections(0))
+  {
+    vtkAlgorithmOutput* port = this->SlabStreamer->GetInputConnection(0, 0);
+    vtkAlgorithm* source = port->GetProducer();
+    source->UpdateWholeExtent();
+    return vtkImageData::SafeDownCast(
+      source->GetOutputDataObject(port->GetIndex()));
+  }
+  return this->GetInput();
+}
+
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkMedicalImageViewer::WriteSlice(const std::string& fileName)
 {
-  vtkImageData* input = this->GetInput();
+  vtkImageData* input = this->GetWholeInput();
   if (input && vtkImageDataWriter::IsValidFileName(fileName.c_str()))
   {
     vtkNew<vtkImageDataWriter> writer;
     writer->SetFileName(fileName.c_str());
-    vtkNew<vtkImageClip> clip;
+    writer->SetInputData(input);
+    writer->WriteSlice(this->ViewOrientation, this->Slice);
+  }
+}
 
-    int extent[6];
-    int u, v, w = this->ViewOrientation;
-    switch (w)
-    {
-      case 0: u = 1; v = 2; break;
-      case 1: u = 0; v = 2; break;
-      case 2: u = 0; v = 1; break;
-    }
-    int* w_ext = input->GetExtent();
-    extent[2*u] = w_ext[2*u];
-    extent[2*u+1] = w_ext[2*u+1];
-    extent[2*v] = w_ext[2*v];
-    extent[2*v+1] = w_ext[2*v+1];
-    extent[2*w] = this->Slice;
-    extent[2*w+1] = this->Slice;
-
-    clip->SetOutputWholeExtent(extent);
-    clip->ClipDataOn();
-    clip->SetInputData(input);
-    clip->Update();
-
-    int ec[6];
-    clip->GetOutput()->GetExtent(ec);
-
-    int et[] = {0, 0, 0};  // extent translation
-    int op[] = {0, 1, 2};  // output axes permutation
-
-    // translate to an x-y plane:
-    // 1) change extents via vtkImageChangeInformation
-    // 2) permute the axes
-    switch (w)
-    {
-      case 0: et[0] = -ec[0];
-              op[0] = 2; op[1] = 0; op[2] = 1;
-              break;  // YZ
-      case 1: et[1] = -ec[2];
-              op[0] = 0; op[1] = 2; op[2] = 1;
-              break;  // XZ
-      case 2: et[2] = -ec[4];
-              break;  // XY
-    }
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkMedicalImageViewer::WriteSlices(const std::string& fileName)
+{
+  vtkImageData* input = this->GetWholeInput();
+  if (input && vtkImageDataWriter::IsValidFileName(fileName.c_str()))
+  {
+    vtkNew<vtkImageDataWriter> writer;
+    writer->SetFileName(fileName.c_str());
+    writer->SetInputData(input);
+    return writer->WriteSlices(this->ViewOrientation);
+  }
+  return 0;
+}
 
-    vtkNew<vtkImageChangeInformation> change;
-    change->SetExtentTranslation(et);
-    change->SetInputConnection(clip->GetOutputPort());
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+int vtkMedicalImageViewer::WriteCine(vtkCineWriter* writer, bool annotate)
+{
+  if (!writer || !this->GetInput()) return 0;
 
-    vtkNew<vtkImagePermute> permute;
-    permute->SetFilteredAxes(op);
-    permute->SetInputConnection(change->GetOutputPort());
+  // frames are rendered to the back buffer and never shown
+  int slice = this->Slice;
+  int annotation = this->Annotate;
+  int swapBuffers = this->RenderWindow->GetSwapBuffers();
+  this->RenderWindow->SwapBuffersOff();
+  if (!annotate && annotation) this->SetAnnotate(0);
 
-    writer->SetInputData(permute->GetOutput());
-    writer->Write();
+  int frames = 0;
+  std::string errorMessage;
+  try
+  {
+    writer->SetRenderWindow(this->RenderWindow);
+    writer->Start(this->GetNumberOfSlices());
+    for (int i = this->GetSliceMin();
+         i <= this->GetSliceMax() && !writer->GetAbortExecute(); ++i)
+    {
+      this->SetSlice(i);
+      writer->WriteFrame();
+    }
+    frames = writer->End();
   }
+  catch (std::exception& e)
+  {
+    errorMessage = e.what();
+  }
+
+  this->RenderWindow->SetSwapBuffers(swapBuffers);
+  if (!annotate && annotation) this->SetAnnotate(annotation);
+  this->SetSlice(slice);
+  if (!errorMessage.empty())
+    throw std::runtime_error(errorMessage);
+  return frames;
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -653,6 +802,8 @@ void vtkMedicalImageViewer::InstallPipeline()
     charCbk->Viewer = this;
     this->CharCallbackTag =
       this->Interactor->AddObserver(vtkCommand::CharEvent, charCbk);
+    this->TimerCallbackTag =
+      this->Interactor->AddObserver(vtkCommand::TimerEvent, cbk);
   }
 
   if (this->Renderer)
@@ -704,6 +855,10 @@ void vtkMedicalImageViewer::UnInstallPipeline()
   if (this->Interactor)
   {
     this->Interactor->RemoveObserver(this->CharCallbackTag);
+    this->Interactor->RemoveObserver(this->TimerCallbackTag);
+    if (this->RefineTimerId)
+      this->Interactor->DestroyTimer(this->RefineTimerId);
+    this->RefineTimerId = 0;
     this->Interactor->SetInteractorStyle(0);
     this->Interactor->SetRenderWindow(0);
   }
@@ -715,30 +870,23 @@ void vtkMedicalImageViewer::InitializeWindowLevel()
   vtkImageData* input = this->GetInput();
   if (!input) return;
 
-  int components = input->GetNumberOfScalarComponents();
-  double dataMin = input->GetScalarTypeMax();
-  double dataMax = input->GetScalarTypeMin();
-
-  if (1 == components)
+  // the range of all of the components, shared with the image's other
+  // consumers
+  double range[2] = { input->GetScalarTypeMin(), input->GetScalarTypeMax() };
+  vtkImageDataStatistics* statistics =
+    vtkImageDataStatistics::GetStatistics(input);
+  if (statistics && 0 < statistics->GetNumberOfComponents())
   {
-    dataMin = input->GetScalarRange()[0];
-    dataMax = input->GetScalarRange()[1];
+    statistics->GetRange(range);
   }
-  else
+  if (this->AutoWindowLevel && statistics &&
+      1 == statistics->GetNumberOfComponents())
   {
-    vtkDataArray* data = 0;
-    if (input->GetPointData() &&
-        0 != (data = input->GetPointData()->GetScalars()))
-    {
-      for (int i = 0; i < components; ++i)
-      {
-        double min = data->GetRange(i)[0];
-        double max = data->GetRange(i)[1];
-        if (dataMin > min) dataMin = min;
-        if (dataMax < max) dataMax = max;
-      }
-    }
+    statistics->GetPercentileRange(this->AutoWindowLevelPercentiles[0],
+      this->AutoWindowLevelPercentiles[1], range);
   }
+  double dataMin = range[0];
+  double dataMax = range[1];
 
   if (this->MaintainLastWindowLevel)
   {
@@ -775,12 +923,10 @@ void vtkMedicalImageViewer::InitializeWindowLevel()
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkMedicalImageViewer::InitializeCameraViews()
 {
-  vtkImageData* input = this->GetInput();
-  if (!input) return;
-  this->WindowLevel->Update();
-  double* origin = input->GetOrigin();
-  double* spacing = input->GetSpacing();
-  int* extent = input->GetExtent();
+  if (!this->UpdateInputInformation()) return;
+  double* origin = this->InputOrigin;
+  double* spacing = this->InputSpacing;
+  int* extent = this->InputWholeExtent;
   int u, v;
   double fpt[3];
   double pos[3];
@@ -881,10 +1027,10 @@ void vtkMedicalImageViewer::UpdateCameraView()
 int vtkMedicalImageViewer::GetImageDimensionality()
 {
   int dim = 0;
-  if (this->GetInput())
+  if (this->UpdateInputInformation())
   {
-    int* dims = this->GetInput()->GetDimensions();
-    dim = 1 >= dims[2] ? 2 : 3;
+    int* extent = this->InputWholeExtent;
+    dim = 1 >= (extent[5] - extent[4] + 1) ? 2 : 3;
   }
   return dim;
 }
@@ -908,11 +1054,9 @@ void vtkMedicalImageViewer::SetImageToSinusoid()
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkMedicalImageViewer::GetSliceRange(int& min, int& max)
 {
-  vtkImageData* input = this->GetInput();
-  if (input)
+  if (this->UpdateInputInformation())
   {
-    this->WindowLevel->Update();
-    int* w_ext = input->GetExtent();
+    int* w_ext = this->InputWholeExtent;
     min = w_ext[this->ViewOrientation * 2];
     max = w_ext[this->ViewOrientation * 2 + 1];
   }
@@ -921,11 +1065,9 @@ void vtkMedicalImageViewer::GetSliceRange(int& min, int& max)
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 int* vtkMedicalImageViewer::GetSliceRange()
 {
-  vtkImageData* input = this->GetInput();
-  if (input)
+  if (this->UpdateInputInformation())
   {
-    this->WindowLevel->Update();
-    return input->GetExtent() + this->ViewOrientation * 2;
+    return this->InputWholeExtent + this->ViewOrientation * 2;
   }
   return 0;
 }
@@ -955,8 +1097,7 @@ int vtkMedicalImageViewer::GetSliceMax()
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
 void vtkMedicalImageViewer::ComputeCameraFromCurrentSlice(bool useCamera)
 {
-  vtkImageData* image = this->GetInput();
-  if (!image) return;
+  if (!this->UpdateInputInformation()) return;
 
   vtkCamera* camera = this->Renderer->GetActiveCamera();
   if (camera)
@@ -969,9 +1110,9 @@ void vtkMedicalImageViewer::ComputeCameraFromCurrentSlice(bool useCamera)
       case 2: u = 0; v = 1; break;
     }
 
-    double* origin = image->GetOrigin();
-    double* spacing = image->GetSpacing();
-    int* extent = image->GetExtent();
+    double* origin = this->InputOrigin;
+    double* spacing = this->InputSpacing;
+    int* extent = this->InputWholeExtent;
     double fpt[3];
     fpt[u] = origin[u] + 0.5 * spacing[u] * (extent[2*u] + extent[2*u+1]);
     fpt[v] = origin[v] + 0.5 * spacing[v] * (extent[2*v] + extent[2*v+1]);
@@ -1058,6 +1199,7 @@ void vtkMedicalImageViewer::SetViewOrientation(const int& orientation)
   this->ViewOrientation = orientation;
   this->Slice = this->LastSlice[this->ViewOrientation];
 
+  this->SlabStreamer->SetAxis(orientation);
   this->ImageSliceMapper->SetOrientation(orientation);
   this->ImageSliceMapper->SetSliceNumber(this->Slice);
   this->ImageSliceMapper->Update();
@@ -1113,6 +1255,33 @@ void vtkMedicalImageViewer::DoStartWindowLevel()
 {
   this->InitialWindow = this->Window;
   this->InitialLevel = this->Level;
+
+  // large slices are previewed shrunk while the mouse is dragged
+  this->WindowLevel->SetSliceOrientation(this->ViewOrientation);
+  this->InteractiveShrinkFactor =
+    this->WindowLevel->ComputeShrinkFactor(this->InteractiveSliceSize);
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::DoEndWindowLevel()
+{
+  if (this->RefineTimerId && this->Interactor)
+    this->Interactor->DestroyTimer(this->RefineTimerId);
+  this->RefineTimerId = 0;
+
+  if (1 < this->WindowLevel->GetShrinkFactor())
+  {
+    this->WindowLevel->SetShrinkFactor(1);
+    this->Render();
+  }
+}
+
+// -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+void vtkMedicalImageViewer::DoTimer(int timerId)
+{
+  // the mouse has rested, show the full resolution until it moves again
+  if (timerId == this->RefineTimerId && this->RefineTimerId)
+    this->DoEndWindowLevel();
 }
 
 // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
@@ -1187,6 +1356,15 @@ void vtkMedicalImageViewer::DoWindowLevel()
   }
 
   this->SetColorWindowLevel(newWindow, newLevel);
+
+  if (1 < this->InteractiveShrinkFactor && this->Interactor)
+  {
+    this->WindowLevel->SetShrinkFactor(this->InteractiveShrinkFactor);
+    if (this->RefineTimerId)
+      this->Interactor->DestroyTimer(this->RefineTimerId);
+    this->RefineTimerId =
+      this->Interactor->CreateOneShotTimer(this->RefineDelay);
+  }
   this->Render();
 }
 
@@ -1328,9 +1506,15 @@ void vtkMedicalImageViewer::InstallBox()
       3 == this->GetImageDimensionality() && this->BoxDisplay)
   {
     this->Renderer->AddViewProp(this->BoxActor);
-    vtkImageData* input = this->GetInput();
-    this->BoxAxes->SetOrigin(input->GetOrigin());
-    double* bounds = input->GetBounds();
+    double bounds[6];
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2*i]   = this->InputOrigin[i] +
+        this->InputSpacing[i] * this->InputWholeExtent[2*i];
+      bounds[2*i+1] = this->InputOrigin[i] +
+        this->InputSpacing[i] * this->InputWholeExtent[2*i+1];
+    }
+    this->BoxAxes->SetOrigin(this->InputOrigin);
     double scale = VTK_FLOAT_MAX;
     for (int i = 0; i < 3; ++i)
     {
@@ -1339,7 +1523,7 @@ void vtkMedicalImageViewer::InstallBox()
         scale = r;
     }
     this->BoxAxes->SetScaleFactor(scale);
-    this->BoxOutline->SetBounds(input->GetBounds());
+    this->BoxOutline->SetBounds(bounds);
   }
 }
 
@@ -1569,9 +1753,14 @@ void vtkMedicalImageViewer::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ViewOrientation: " << this->ViewOrientation << endl;
   os << indent << "MaintainLastWindowLevel: "
                << this->MaintainLastWindowLevel << endl;
+  os << indent << "AutoWindowLevel: " << this->AutoWindowLevel << endl;
+  os << indent << "AutoWindowLevelPercentiles: "
+               << this->AutoWindowLevelPercentiles[0] << ", "
+               << this->AutoWindowLevelPercentiles[1] << endl;
   os << indent << "Annotate: " << this->Annotate << endl;
   os << indent << "Cursor: " << this->Cursor << endl;
   os << indent << "Interpolate: " << this->Interpolate << endl;
+  os << indent << "Streaming: " << this->Streaming << endl;
   os << indent << "MaxFrameRate: " << this->MaxFrameRate << endl;
   os << indent << "FrameRate: " << this->FrameRate << endl;
 }
@@ -61,12 +61,15 @@
 #include <string>
 #include <vector>
 
+class vtkAlgorithmOutput;
 class vtkAxes;
 class vtkAxesActor;
+class vtkCineWriter;
 class vtkCustomCornerAnnotation;
 class vtkCustomInteractorStyleImage;
 class vtkImageCoordinateWidget;
 class vtkImageData;
+class vtkImageSlabStreamer;
 class vtkImageSlice;
 class vtkImageSliceMapper;
 class vtkImageWindowLevel;
@@ -105,6 +108,36 @@ class vtkMedicalImageViewer : public vtkObject
     virtual vtkImageData* GetInput();
     //@}
 
+    /**
+     * Set the input to the viewer as a pipeline connection, for example
+     * from vtkImageDataReader::GetOutputPort.  Only the displayed slice,
+     * widened by SlabMargin slices on either side along the view
+     * orientation, is requested from upstream, so a streaming reader
+     * decodes just that slab.  GetInput then returns the slab currently
+     * held, while the slice range and camera are set from the whole extent.
+     * @param input output port of a reader or filter producing vtkImageData
+     */
+    virtual void SetInputConnection(vtkAlgorithmOutput* input);
+
+    //@{
+    /**
+     * Set/Get the number of slices read on either side of the displayed
+     * slice when the input is set by SetInputConnection.  Default 8.
+     */
+    virtual void SetSlabMargin(int margin);
+    virtual int GetSlabMargin();
+    //@}
+
+    //@{
+    /**
+     * Set/Get whether Load connects the viewer to the reader's output port
+     * rather than reading the whole image up front.  Default off.
+     */
+    vtkSetMacro(Streaming, int);
+    vtkGetMacro(Streaming, int);
+    vtkBooleanMacro(Streaming, int);
+    //@}
+
     /**
      * Get the input image to the vtkImageSlice.
      * The input is the vtkImageWindowLevel filter output.
@@ -298,6 +331,24 @@ class vtkMedicalImageViewer : public vtkObject
     vtkBooleanMacro(MaintainLastWindowLevel, int);
     //@}
 
+    //@{
+    /**
+     * Set the original window level of a single component image, which the
+     * window level is reset to, from the lower to the upper percentile of
+     * its values rather than from its whole range, so that a few outlying
+     * values do not wash it out.  Default is on, from the 1st to the 99th
+     * percentile.  Changing either re-initializes the window level of the
+     * current input and renders.
+     */
+    virtual void SetAutoWindowLevel(int autoWindowLevel);
+    vtkGetMacro(AutoWindowLevel, int);
+    vtkBooleanMacro(AutoWindowLevel, int);
+    virtual void SetAutoWindowLevelPercentiles(double lower, double upper);
+    virtual void SetAutoWindowLevelPercentiles(const double percentiles[2])
+      { this->SetAutoWindowLevelPercentiles(percentiles[0], percentiles[1]); }
+    vtkGetVector2Macro(AutoWindowLevelPercentiles, double);
+    //@}
+
     /** Record the current camera parameters */
     void RecordCameraView(int specified = -1);
 
@@ -307,9 +358,25 @@ class vtkMedicalImageViewer : public vtkObject
     void DoStartWindowLevel();
     void DoResetWindowLevel();
     void DoWindowLevel();
+    void DoEndWindowLevel();
+    void DoTimer(int timerId);
     void InvertWindowLevel();
     //@}
 
+    //@{
+    /**
+     * Set/Get the largest number of voxels of a slice which is window /
+     * levelled at full resolution while the mouse is dragged.  Larger
+     * slices are shrunk, see vtkImageWindowLevel::SetShrinkFactor, until
+     * the mouse is released or rests for RefineDelay milliseconds.
+     * Default 1024 x 1024, 0 always uses the full resolution.
+     */
+    vtkSetMacro(InteractiveSliceSize, int);
+    vtkGetMacro(InteractiveSliceSize, int);
+    vtkSetClampMacro(RefineDelay, int, 0, 5000);
+    vtkGetMacro(RefineDelay, int);
+    //@}
+
     /**
      * Get the dimensionality of the image (e.g., 2D, 3D).
      * @return dimension of the image
@@ -417,10 +484,26 @@ class vtkMedicalImageViewer : public vtkObject
     vtkGetMacro(FrameRate, int);
 
     /**
-     * Save the current slice view to file
+     * Save the current slice view to file.  A streamed input is read whole
+     * first, as for WriteSlices.
      */
      void WriteSlice(const std::string& name);
 
+    /**
+     * Save every slice along the view orientation to numbered files,
+     * see vtkImageDataWriter::WriteSlices, returns the number written.
+     * When streaming, the input only holds the slab about the current
+     * slice, so the whole extent is read from the stream's source first.
+     */
+    int WriteSlices(const std::string& name);
+
+    /**
+     * Render every slice along the view orientation offscreen and write
+     * them as a cine loop with the given writer, optionally without the
+     * annotation, returns the number of frames written
+     */
+    int WriteCine(vtkCineWriter* writer, bool annotate = true);
+
   protected:
     vtkMedicalImageViewer();
     ~vtkMedicalImageViewer();
@@ -442,10 +525,17 @@ class vtkMedicalImageViewer : public vtkObject
     void UnInstallBox();
     //@}
 
+    /**
+     * Get the input with its whole extent, which for a streamed input is
+     * read from the source of the stream.
+     */
+    vtkImageData* GetWholeInput();
+
     //@{
     /** VTK object ivars that constitute the visualization/interaction
       * pipeline.
       */
+    vtkSmartPointer<vtkImageSlabStreamer> SlabStreamer;
     vtkSmartPointer<vtkImageWindowLevel> WindowLevel;
     vtkRenderWindow* RenderWindow;
     vtkRenderer* Renderer;
@@ -468,6 +558,7 @@ class vtkMedicalImageViewer : public vtkObject
     int Interpolate;
     int AxesDisplay;
     int BoxDisplay;
+    int Streaming;
 
     /** Current slice index */
     int Slice;
@@ -476,6 +567,8 @@ class vtkMedicalImageViewer : public vtkObject
 
     /** Maintain window level settings between image changes */
     int MaintainLastWindowLevel;
+    int AutoWindowLevel;
+    double AutoWindowLevelPercentiles[2];
     double OriginalWindow; /**< Original window computed from input */
     double OriginalLevel;  /**< Original level computed from input */
     double InitialWindow;  /**< Initial window at start of interaction */
@@ -483,6 +576,12 @@ class vtkMedicalImageViewer : public vtkObject
     double Window;         /**< Current window */
     double Level;          /**< Current level */
 
+    /** Reduced resolution window level while the mouse is dragged */
+    int InteractiveSliceSize;
+    int InteractiveShrinkFactor;
+    int RefineDelay;
+    int RefineTimerId;
+
     /**
      * Callback ids for install and uninstall of callbacks to the interactor.
      * Callback tags are set in InstallPipeline() and used for callback
@@ -491,6 +590,7 @@ class vtkMedicalImageViewer : public vtkObject
     std::vector<unsigned long> WindowLevelCallbackTags;
 
     unsigned long CharCallbackTag;
+    unsigned long TimerCallbackTag;
 
     /** Calculate the original window and level parameters
       * @sa OriginalWindow, OriginalLevel
@@ -507,6 +607,19 @@ class vtkMedicalImageViewer : public vtkObject
     double CameraDistance[3];         /**< Current camera distance */
     double CameraClippingRange[3][2]; /**< Current clipping range */
 
+    /** Geometry of the whole input, as opposed to the streamed slab */
+    double InputOrigin[3];
+    double InputSpacing[3];
+    int InputWholeExtent[6];
+
+    /** Update the input geometry from the pipeline information without
+     * updating the input data.  Returns 0 if there is no input.
+     */
+    int UpdateInputInformation();
+
+    /** Set up the display pipeline for a newly connected input */
+    void InitializeInput();
+
     /** Set up the default camera parameters based on input data dimensions */
     void InitializeCameraViews();
     /** Update the camera from recorded parameters according to the current
@@ -0,0 +1,167 @@
+/*=========================================================================
+
+  Module:    TestWindowLevelKernels.cxx
+  Program:   Birch
+  Language:  C++
+  Author:    Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+
+// Maps single component images to luminance with each vector kernel the
+// processor has and with the scalar loop, and fails if any value differs.
+
+#include <vtkImageWindowLevel.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTypeTraits.h>
+#include <vtkUnsignedCharArray.h>
+
+// C++ includes
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#define VTK_CREATE(type, name) \
+  vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
+
+namespace
+{
+  // window and level pairs: ordinary, zero, inverted, tiny and huge windows
+  const double WindowLevels[][2] = {
+    { 400.0, 100.0 },
+    { 1.0, 0.0 },
+    { 0.0, 100.0 },
+    { 0.0, 0.0 },
+    { -400.0, 100.0 },
+    { -1.0, 0.0 },
+    { 1.0e-3, 0.5 },
+    { 255.0, 127.5 },
+    { 65535.0, 32767.5 },
+    { 65535.0, 0.0 },
+    { 1.0e9, -5.0e8 },
+    { -1.0e9, 5.0e8 } };
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // an image starting with the limits of the type and the values around
+  // them and zero, followed by a sweep of its range, with rows that are not
+  // a whole number of vector blocks
+  template <class T>
+  vtkSmartPointer<vtkImageData> CreateImage(int scalarType, int x, int y)
+  {
+    vtkSmartPointer<vtkImageData> image =
+      vtkSmartPointer<vtkImageData>::New();
+    image->SetDimensions(x, y, 1);
+    image->AllocateScalars(scalarType, 1);
+    T* values = static_cast<T*>(image->GetScalarPointer());
+    vtkIdType count = static_cast<vtkIdType>(x) * y;
+
+    const double minimum = static_cast<double>(vtkTypeTraits<T>::Min());
+    const double maximum = static_cast<double>(vtkTypeTraits<T>::Max());
+    const double limits[] = {
+      minimum, maximum, 0.0, minimum + 1.0, maximum - 1.0, 1.0, -1.0 };
+    const vtkIdType numberOfLimits = sizeof(limits) / sizeof(limits[0]);
+    for (vtkIdType i = 0; i < count; ++i)
+      {
+      double value = i < numberOfLimits ? limits[i] :
+        minimum + (maximum - minimum) * (i - numberOfLimits) / count;
+      if (value < minimum || value > maximum)
+        {
+        value = 0.0;
+        }
+      values[i] = static_cast<T>(value);
+      }
+    return image;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  std::vector<unsigned char> Map(
+    vtkImageData* image, double window, double level, int kernel)
+  {
+    vtkImageWindowLevel::SetKernel(kernel);
+    VTK_CREATE(vtkImageWindowLevel, windowLevel);
+    windowLevel->SetInputData(image);
+    windowLevel->SetOutputFormatToLuminance();
+    windowLevel->SetWindow(window);
+    windowLevel->SetLevel(level);
+    windowLevel->Update();
+
+    vtkDataArray* scalars =
+      windowLevel->GetOutput()->GetPointData()->GetScalars();
+    const unsigned char* values =
+      static_cast<const unsigned char*>(scalars->GetVoidPointer(0));
+    return std::vector<unsigned char>(
+      values, values + scalars->GetNumberOfTuples());
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // the number of window / level settings for which a vector kernel
+  // differed from the scalar loop
+  int Compare(vtkImageData* image, const char* name)
+  {
+    int failures = 0;
+    const int numberOfWindowLevels =
+      sizeof(WindowLevels) / sizeof(WindowLevels[0]);
+    for (int kernel = vtkImageWindowLevel::SSE2Kernel;
+         kernel <= vtkImageWindowLevel::AVX2Kernel; ++kernel)
+      {
+      vtkImageWindowLevel::SetKernel(kernel);
+      if (kernel != vtkImageWindowLevel::GetKernel())
+        {
+        std::cout << name << ": kernel " << kernel
+                  << " not available, skipped" << std::endl;
+        continue;
+        }
+
+      for (int i = 0; i < numberOfWindowLevels; ++i)
+        {
+        double window = WindowLevels[i][0];
+        double level = WindowLevels[i][1];
+        std::vector<unsigned char> expected = Map(
+          image, window, level, vtkImageWindowLevel::ScalarKernel);
+        std::vector<unsigned char> actual = Map(image, window, level, kernel);
+        if (expected.size() != actual.size() || expected.empty() ||
+            0 != memcmp(&expected[0], &actual[0], expected.size()))
+          {
+          std::cout << name << ": kernel " << kernel << " differs from the "
+                    << "scalar loop at window " << window << " level "
+                    << level << std::endl;
+          failures++;
+          }
+        }
+      }
+    return failures;
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // a small image is mapped row by row, a large 8 or 16-bit one through the
+  // table of every value of its type
+  template <class T>
+  int CompareType(int scalarType, const char* name)
+  {
+    return
+      Compare(CreateImage<T>(scalarType, 37, 5), name) +
+      Compare(CreateImage<T>(scalarType, 263, 251), name);
+  }
+}
+
+int main(void)
+{
+  int failures =
+    CompareType<unsigned char>(VTK_UNSIGNED_CHAR, "unsigned char") +
+    CompareType<short>(VTK_SHORT, "short") +
+    CompareType<unsigned short>(VTK_UNSIGNED_SHORT, "unsigned short") +
+    CompareType<float>(VTK_FLOAT, "float");
+
+  if (0 < failures)
+    {
+    std::cout << failures << " comparisons failed" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "the vector kernels match the scalar loop" << std::endl;
+  return EXIT_SUCCESS;
+}
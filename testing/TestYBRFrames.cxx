@@ -0,0 +1,223 @@
+/*=========================================================================
+
+  Module:    TestYBRFrames.cxx
+  Program:   Birch
+  Language:  C++
+  Author:    Dean Inglis <inglisd AT mcmaster DOT ca>
+
+=========================================================================*/
+
+// Writes a baseline JPEG, YBR_FULL_422 multi-frame file, reads it with the
+// frames decoded in parallel and fails unless they match the DICOM
+// reader's own RGB output.
+
+#include <vtkImageDataReader.h>
+
+#include <Common.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
+#include <vtkMultiThreader.h>
+#include <vtkSmartPointer.h>
+
+// vtk-dicom includes
+#include <vtkDICOMReader.h>
+
+// GDCM includes
+#include <gdcmAttribute.h>
+#include <gdcmImageChangeTransferSyntax.h>
+#include <gdcmImageWriter.h>
+#include <gdcmMediaStorage.h>
+#include <gdcmUIDGenerator.h>
+
+// C++ includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define VTK_CREATE(type, name) \
+  vtkSmartPointer<type> name = vtkSmartPointer<type>::New()
+
+namespace
+{
+  const unsigned int Columns = 64;
+  const unsigned int Rows = 48;
+  const unsigned int Frames = 8;
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // a smooth colour ramp that differs from frame to frame, so the lossy
+  // compression changes it little
+  unsigned char Pixel(unsigned int x, unsigned int y, unsigned int frame,
+    int component)
+  {
+    unsigned int values[3] = {
+      32 + 2 * x + 8 * frame,
+      200 - 2 * y - 4 * frame,
+      64 + x + y + 12 * frame };
+    return static_cast<unsigned char>(values[component] & 0xff);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // baseline JPEG stores colour as subsampled YCbCr, which DICOM labels
+  // YBR_FULL_422 and which is decoded back to YCbCr, not RGB
+  bool WriteFile(const std::string& fileName)
+  {
+    std::vector<char> buffer;
+    for (unsigned int frame = 0; frame < Frames; ++frame)
+    {
+      for (unsigned int y = 0; y < Rows; ++y)
+      {
+        for (unsigned int x = 0; x < Columns; ++x)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            buffer.push_back(static_cast<char>(Pixel(x, y, frame, c)));
+          }
+        }
+      }
+    }
+
+    gdcm::SmartPointer<gdcm::Image> image = new gdcm::Image;
+    image->SetNumberOfDimensions(3);
+    image->SetDimension(0, Columns);
+    image->SetDimension(1, Rows);
+    image->SetDimension(2, Frames);
+    image->SetPixelFormat(gdcm::PixelFormat(3, 8, 8, 7, 0));
+    image->SetPhotometricInterpretation(
+      gdcm::PhotometricInterpretation::RGB);
+    image->SetPlanarConfiguration(0);
+    image->SetTransferSyntax(gdcm::TransferSyntax::ExplicitVRLittleEndian);
+    gdcm::DataElement pixelData(gdcm::Tag(0x7fe0, 0x0010));
+    pixelData.SetByteValue(&buffer[0], static_cast<uint32_t>(buffer.size()));
+    image->SetDataElement(pixelData);
+
+    gdcm::ImageChangeTransferSyntax change;
+    change.SetTransferSyntax(gdcm::TransferSyntax::JPEGBaselineProcess1);
+    change.SetInput(*image);
+    if (!change.Change())
+    {
+      return false;
+    }
+
+    gdcm::ImageWriter writer;
+    writer.SetFileName(fileName.c_str());
+    writer.SetImage(change.GetOutput());
+    writer.GetImage().SetPhotometricInterpretation(
+      gdcm::PhotometricInterpretation::YBR_FULL_422);
+
+    gdcm::DataSet& ds = writer.GetFile().GetDataSet();
+    gdcm::UIDGenerator uid;
+    gdcm::Attribute<0x0008, 0x0016> sopClass;
+    sopClass.SetValue(gdcm::MediaStorage::GetMSString(
+      gdcm::MediaStorage::MultiframeTrueColorSecondaryCaptureImageStorage));
+    ds.Replace(sopClass.GetAsDataElement());
+    gdcm::Attribute<0x0008, 0x0018> sopInstance;
+    sopInstance.SetValue(uid.Generate());
+    ds.Replace(sopInstance.GetAsDataElement());
+
+    return writer.Write();
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  void CountSlicesLoaded(vtkObject*, unsigned long, void* clientData, void*)
+  {
+    ++*static_cast<int*>(clientData);
+  }
+
+  // -+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-+#+-
+  // the largest difference between two images of the same size and type,
+  // or -1 if they differ in either
+  int MaximumDifference(vtkImageData* a, vtkImageData* b)
+  {
+    int* extentA = a->GetExtent();
+    int* extentB = b->GetExtent();
+    for (int i = 0; i < 6; ++i)
+    {
+      if (extentA[i] != extentB[i])
+      {
+        return -1;
+      }
+    }
+    if (VTK_UNSIGNED_CHAR != a->GetScalarType() ||
+        VTK_UNSIGNED_CHAR != b->GetScalarType() ||
+        3 != a->GetNumberOfScalarComponents() ||
+        3 != b->GetNumberOfScalarComponents())
+    {
+      return -1;
+    }
+
+    const unsigned char* valuesA =
+      static_cast<const unsigned char*>(a->GetScalarPointer());
+    const unsigned char* valuesB =
+      static_cast<const unsigned char*>(b->GetScalarPointer());
+    vtkIdType count = a->GetNumberOfPoints() * 3;
+    int difference = 0;
+    for (vtkIdType i = 0; i < count; ++i)
+    {
+      difference = std::max(difference,
+        std::abs(static_cast<int>(valuesA[i]) - valuesB[i]));
+    }
+    return difference;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::string fileName = 1 < argc ? argv[1] : "TestYBRFrames.dcm";
+  if (!WriteFile(fileName))
+  {
+    std::cout << "could not write " << fileName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // one decoding thread reports every frame as it completes, where the
+  // sequential reader would report the single slab once
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(1);
+  int slicesLoaded = 0;
+  VTK_CREATE(vtkCallbackCommand, callback);
+  callback->SetCallback(CountSlicesLoaded);
+  callback->SetClientData(&slicesLoaded);
+
+  VTK_CREATE(vtkImageDataReader, reader);
+  reader->SetFileName(fileName.c_str());
+  reader->SetStreamingSlabSize(Frames + 1);
+  reader->AddObserver(Birch::Common::SlicesLoadedEvent, callback);
+  vtkImageData* parallel = reader->GetOutput();
+
+  vtkDICOMReader* dicomReader =
+    vtkDICOMReader::SafeDownCast(reader->GetReader());
+  VTK_CREATE(vtkDICOMReader, sequential);
+  sequential->SetMemoryRowOrder(dicomReader->GetMemoryRowOrder());
+  sequential->SetFileName(fileName.c_str());
+  sequential->Update();
+
+  int failures = 0;
+  if (static_cast<int>(Frames) != slicesLoaded)
+  {
+    std::cout << "the frames were not decoded in parallel" << std::endl;
+    failures++;
+  }
+
+  // both convert from YBR with the same formula, up to rounding
+  int difference = MaximumDifference(parallel, sequential->GetOutput());
+  if (0 > difference || 1 < difference)
+  {
+    std::cout << "the frames decoded in parallel differ from the DICOM "
+              << "reader's by " << difference << std::endl;
+    failures++;
+  }
+
+  std::remove(fileName.c_str());
+
+  if (0 < failures)
+  {
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "the YBR_FULL_422 frames were converted to RGB" << std::endl;
+  return EXIT_SUCCESS;
+}